@@ -6,10 +6,10 @@
 #include "dove_eye/aggregator.h"
 #include "dove_eye/async_policy.h"
 #include "dove_eye/blocking_policy.h"
+#include "dove_eye/calibration_pattern_factory.h"
 #include "dove_eye/camera_calibration.h"
 #include "dove_eye/camera_video_provider.h"
 #include "dove_eye/circle_tracker.h"
-#include "dove_eye/chessboard_pattern.h"
 #include "dove_eye/frameset.h"
 #include "dove_eye/frameset_aggregator.h"
 #include "dove_eye/histogram_tracker.h"
@@ -25,9 +25,10 @@ using dove_eye::BlockingPolicy;
 using dove_eye::CalibrationData;
 using dove_eye::CameraCalibration;
 using dove_eye::CameraIndex;
+using dove_eye::CameraProfile;
 using dove_eye::CameraVideoProvider;
-using dove_eye::ChessboardPattern;
 using dove_eye::CircleTracker;
+using dove_eye::CreateCalibrationPattern;
 using dove_eye::Frameset;
 using dove_eye::HistogramTracker;
 using dove_eye::Localization;
@@ -36,7 +37,7 @@ using dove_eye::TemplateTracker;
 using dove_eye::Tracker;
 using std::unique_ptr;
 
-Application::Application()
+Application::Application(const std::string &results_shm_name)
     : QObject(),
       arity_(0),
       parameters_(),
@@ -44,6 +45,15 @@ Application::Application()
       controller_(nullptr),
       converter_(nullptr) {
   RegisterMetaTypes();
+
+#ifdef CONFIG_SHM
+  if (!results_shm_name.empty() &&
+      !result_publisher_.Create(results_shm_name)) {
+    qWarning() << "Results will not be published to shared memory";
+  }
+#else
+  (void) results_shm_name;
+#endif
 }
 
 Application::~Application() {
@@ -72,6 +82,7 @@ Application::VideoProvidersVector Application::ScanCameraProviders() {
   int errors = 0;
   while (true) {
     auto provider = new CameraVideoProvider(device);
+    provider->profile(camera_profile_.get());
     if (provider->begin() != provider->end()) {
       available_providers_.push_back(
           VideoProvidersVectorOwning::value_type(provider));
@@ -166,6 +177,20 @@ void Application::SetCalibrationData(const CalibrationData calibration_data) {
   emit CalibrationDataReady(calibration_data);
 }
 
+bool Application::LoadCameraProfile(const QString &filename) {
+  CameraProfile profile;
+  if (!CameraProfile::LoadFromFile(filename.toStdString(), &profile)) {
+    return false;
+  }
+
+  if (!camera_profile_) {
+    camera_profile_ = unique_ptr<CameraProfile>(new CameraProfile(profile));
+  } else {
+    *camera_profile_ = profile;
+  }
+  return true;
+}
+
 void Application::MoveToNewThread(QObject* object) {
 #ifndef CONFIG_SINGLE_THREADED
   QThread* thread = new QThread(this);
@@ -206,22 +231,24 @@ void Application::SetupController(const ProvidersType type,
   }
 
 
-  auto pattern = new ChessboardPattern(
-      parameters_.Get(Parameters::CALIBRATION_ROWS),
-      parameters_.Get(Parameters::CALIBRATION_COLS),
-      parameters_.Get(Parameters::CALIBRATION_SIZE));
+  auto pattern = CreateCalibrationPattern(parameters_);
   auto calibration = new CameraCalibration(parameters_, arity_, pattern);
 
   //TemplateTracker inner_tracker(parameters_);
   //HistogramTracker inner_tracker(parameters_);
   //CircleTracker inner_tracker(parameters_);
   dove_eye::TldTracker inner_tracker(parameters_);
-  auto tracker = new Tracker(arity_, inner_tracker);
-  auto localization = new Localization(arity_);
+  auto tracker = new Tracker(arity_, inner_tracker, parameters_);
+  auto localization = new Localization(arity_, parameters_);
 
   auto new_controller = new Controller(parameters_, aggregator, calibration,
                                        tracker, localization);
   new_controller->SetTrackerMarkType(inner_tracker.PreferredMarkType());
+#ifdef CONFIG_SHM
+  if (result_publisher_.IsOpen()) {
+    new_controller->result_publisher(&result_publisher_);
+  }
+#endif
 
   connect(new_controller, &Controller::CalibrationDataReady,
           this, &Application::SetCalibrationData);
@@ -2,6 +2,7 @@
 #define APPLICATION_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <QEventLoop>
@@ -9,11 +10,16 @@
 #include <QObject>
 #include <QThread>
 
+#include "config.h"
 #include "controller.h"
 #include "dove_eye/aggregator.h"
 #include "dove_eye/calibration_data.h"
+#include "dove_eye/camera_profile.h"
 #include "dove_eye/parameters.h"
 #include "dove_eye/localization.h"
+#ifdef CONFIG_SHM
+#include "dove_eye/shm_result_publisher.h"
+#endif
 #include "dove_eye/types.h"
 #include "dove_eye/video_provider.h"
 #include "frameset_converter.h"
@@ -38,7 +44,10 @@ class Application : public QObject {
     kVideoFiles
   };
 
-  Application();
+  /** @param[in]  results_shm_name  shm segment results are published to,
+   *                                empty disables publishing
+   */
+  explicit Application(const std::string &results_shm_name = "");
 
   ~Application() override;
 
@@ -96,16 +105,26 @@ class Application : public QObject {
 
   void SetCalibrationData(const dove_eye::CalibrationData calibration_data);
 
+  /** Profile is used by camera providers of the next scan */
+  bool LoadCameraProfile(const QString &filename);
+
  private:
   dove_eye::CameraIndex arity_;
   dove_eye::Parameters parameters_;
   ProvidersType providers_type_;
   VideoProvidersVectorOwning available_providers_;
   std::unique_ptr<dove_eye::CalibrationData> calibration_data_;
+  /** Created by the first load, providers keep pointer to it */
+  std::unique_ptr<dove_eye::CameraProfile> camera_profile_;
 
   io::ParametersStorage parameters_storage_;
   io::CalibrationDataStorage calibration_data_storage_;
 
+#ifdef CONFIG_SHM
+  /** Results for other local processes, shared by successive controllers */
+  dove_eye::shm::ResultPublisher result_publisher_;
+#endif
+
   Controller *controller_;
   FramesetConverter* converter_;
 
@@ -1,5 +1,6 @@
 #include "controller.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include <opencv2/opencv.hpp>
@@ -7,12 +8,16 @@
 
 #include "dove_eye/inner_tracker.h"
 #include "dove_eye/location.h"
+#include "dove_eye/model_storage.h"
 
 using dove_eye::CalibrationData;
 using dove_eye::CameraIndex;
+using dove_eye::FairScheduler;
+using dove_eye::Frame;
 using dove_eye::Frameset;
 using dove_eye::InnerTracker;
 using dove_eye::Location;
+using dove_eye::ModelStorage;
 using dove_eye::Parameters;
 using gui::GuiMark;
 using std::unique_ptr;
@@ -26,6 +31,10 @@ void Controller::Start(bool paused) {
   frameset_iterator_ = aggregator_->begin();
   frameset_end_iterator_ = aggregator_->end();
 
+  /* Initial state, so that there's always a snapshot to seek to */
+  snapshots_.clear();
+  SaveSnapshot();
+
   SetMode(kIdle);
   if (paused) {
     emit Paused();
@@ -46,6 +55,8 @@ void Controller::Pause() {
 }
 
 void Controller::Step() {
+  /* Time between steps isn't playback time */
+  aggregator_->Reschedule();
   if (!FramesetLoop()) {
     emit Finished();
   }
@@ -53,10 +64,68 @@ void Controller::Step() {
 
 void Controller::Resume() {
   // TODO is check that aggregator didn't finish necessary ?
+  aggregator_->Reschedule();
   timer_.start(0, this);
   emit Started();
 }
 
+void Controller::Seek(const double time) {
+  if (mode_ == kCalibration) {
+    return;
+  }
+
+  /*
+   * Nearest snapshot at or before the time that can be restored. Without
+   * any, frames are replayed from the start with the current tracking
+   * state.
+   */
+  bool restored = false;
+  Frame::Timestamp start_time = 0;
+  auto it = snapshots_.upper_bound(time);
+  while (!restored && it != snapshots_.begin()) {
+    --it;
+    restored = tracker_->RestoreSnapshot(*it->second);
+    if (restored) {
+      start_time = it->first;
+    } else {
+      ERROR("Cannot restore snapshot at %f", it->first);
+      it = snapshots_.erase(it);
+    }
+  }
+
+  if (!aggregator_->Seek(start_time)) {
+    ERROR("Cannot seek video providers");
+    return;
+  }
+
+  frameset_iterator_ = aggregator_->begin();
+  frameset_end_iterator_ = aggregator_->end();
+
+  /* Re-track frames between the snapshot and the requested time */
+  while (frameset_iterator_ != frameset_end_iterator_) {
+    const auto frameset = *frameset_iterator_;
+
+    Frame::Timestamp frameset_time = 0;
+    for (CameraIndex cam = 0; cam < Arity(); ++cam) {
+      if (frameset.IsValid(cam)) {
+        frameset_time = std::max(frameset_time, frameset[cam].timestamp);
+      }
+    }
+
+    if (frameset_time >= time) {
+      break;
+    }
+
+    /* Snapshot already contains frames up to its time */
+    if ((!restored || frameset_time > start_time) && mode_ == kTracking) {
+      FramesetLoopTracking(tracker_->Track(frameset));
+    }
+    ++frameset_iterator_;
+  }
+
+  emit Seeked(time);
+}
+
 void Controller::SetMark(const dove_eye::CameraIndex cam,
                          const GuiMark gui_mark) {
   if (!calibration_data_) {
@@ -75,6 +144,10 @@ void Controller::SetMark(const dove_eye::CameraIndex cam,
 
   auto positset = tracker_->SetMark(*frameset_iterator_,
                                     cam, mark, project_other);
+
+  /* Later snapshots don't know about the mark */
+  snapshots_.erase(snapshots_.lower_bound(tracker_->time()), snapshots_.end());
+
   FramesetLoopTracking(positset);
 }
 
@@ -132,11 +205,30 @@ void Controller::SetCalibrationData(const CalibrationData calibration_data) {
   assert(localization_);
   localization_->calibration_data(new_calibration_data);
 
+  /* Skip cameras with poor geometry first when short of time */
+  for (CameraIndex cam = 0; cam < Arity(); ++cam) {
+    tracker_->scheduler().camera_value(cam, localization_->CameraScore(cam));
+  }
+
   CalibrationDataToProviders(new_calibration_data);
 
   calibration_data_.reset(new_calibration_data);
 }
 
+bool Controller::LoadTrackerModel(const QString &filename) {
+  if (!ModelStorage::LoadFromFile(filename.toStdString(), tracker_.get())) {
+    return false;
+  }
+
+  /* Objects are searched for right away */
+  SetMode(kTracking);
+  return true;
+}
+
+bool Controller::SaveTrackerModel(const QString &filename) {
+  return ModelStorage::SaveToFile(filename.toStdString(), *tracker_);
+}
+
 void Controller::timerEvent(QTimerEvent *event) {
   if (event->timerId() != timer_.timerId()) {
     return;
@@ -157,40 +249,45 @@ bool Controller::FramesetLoop() {
 
   auto frameset = *frameset_iterator_;
 
-  switch (mode_) {
-    case kIdle:
-      break;
-    case kCalibration:
-      if (calibration_->MeasureFrameset(frameset)) {
-        SetMode(kIdle);
-        /*
-         * This will notify the application and it will signal back to us,
-         * to update tracker, etc.
-         */
-        emit CalibrationDataReady(calibration_->Data());
+  {
+    /* Waiting for the next frameset (below) doesn't hold the CPU slot */
+    FairScheduler::Slot slot(cpu_scheduler_, cpu_client_);
+
+    switch (mode_) {
+      case kIdle:
         break;
-      }
+      case kCalibration:
+        if (calibration_->MeasureFrameset(frameset)) {
+          SetMode(kIdle);
+          /*
+           * This will notify the application and it will signal back to us,
+           * to update tracker, etc.
+           */
+          emit CalibrationDataReady(calibration_->Data());
+          break;
+        }
+
+        for (CameraIndex cam = 0; cam < Arity(); ++cam) {
+          emit CameraCalibrationProgressed(cam,
+                                           calibration_->CameraProgress(cam));
+        }
+        for (auto pair : calibration_->pairs()) {
+          emit PairCalibrationProgressed(
+              pair.index, calibration_->PairProgress(pair.index));
+        }
 
-      for (CameraIndex cam = 0; cam < Arity(); ++cam) {
-        emit CameraCalibrationProgressed(cam,
-                                         calibration_->CameraProgress(cam));
-      }
-      for (auto pair : calibration_->pairs()) {
-        emit PairCalibrationProgressed(pair.index,
-                                       calibration_->PairProgress(pair.index));
+        break;
+      case kTracking: {
+        FramesetLoopTracking(tracker_->Track(frameset));
+        SaveSnapshot();
+        break;
       }
-
-      break;
-    case kTracking: {
-      FramesetLoopTracking(tracker_->Track(frameset));
-      break;
+      case kNonexistent:
+        assert(false);
+        break;
     }
-    case kNonexistent:
-      assert(false);
-      break;
   }
 
-
   emit FramesetReady(*frameset_iterator_);
 
   ++frameset_iterator_;
@@ -203,14 +300,67 @@ void Controller::FramesetLoopTracking(const dove_eye::Positset positset) {
   }
 
   emit PositsetReady(positset);
+#ifdef CONFIG_SHM
+  if (result_publisher_) {
+    result_publisher_->Publish(positset, tracker_->time(), result_source_);
+  }
+#endif
 
+  Location location;
+  bool located = false;
   if (localization_active_) {
-    Location location;
-    if (localization_->Locate(positset, &location)) {
+    located = localization_->Locate(positset, &location);
+    if (located) {
       DEBUG("loc: %f %f %f", location.x, location.y, location.z);
+      tracker_->SetLocation(location);
       emit LocationReady(location);
+#ifdef CONFIG_SHM
+      if (result_publisher_) {
+        result_publisher_->Publish(location, positset.sequence_no,
+                                   tracker_->time(), result_source_);
+      }
+#endif
+    }
+
+    for (CameraIndex cam = 0; cam < Arity(); ++cam) {
+      if (localization_->IsOutlier(cam)) {
+        tracker_->Reacquire(cam);
+      }
     }
   }
+
+#ifdef CONFIG_HISTORY
+  if (history_writer_) {
+    dove_eye::HistoryRecord record(Arity());
+    record.stream_time = tracker_->time();
+    record.positset = positset;
+    for (CameraIndex cam = 0; cam < Arity(); ++cam) {
+      record.states[cam] = tracker_->track_state(cam);
+    }
+    record.location_valid = located;
+    record.location = location;
+    history_writer_->Append(std::move(record));
+  }
+#endif
+}
+
+void Controller::SaveSnapshot() {
+  const auto period = parameters_.Get(Parameters::PLAYBACK_SNAPSHOT_PERIOD);
+  if (period <= 0) {
+    return;
+  }
+
+  /* Don't duplicate snapshots when replaying after seek */
+  const auto time = tracker_->time();
+  auto it = snapshots_.upper_bound(time);
+  if (it != snapshots_.begin() && time - (--it)->first < period) {
+    return;
+  }
+
+  SnapshotPtr snapshot(tracker_->SaveSnapshot());
+  if (snapshot) {
+    snapshots_[time] = std::move(snapshot);
+  }
 }
 
 void Controller::CalibrationDataToProviders(
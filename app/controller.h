@@ -1,18 +1,28 @@
 #ifndef CONTROLLER_H_
 #define CONTROLLER_H_
 
+#include <map>
 #include <memory>
 
 #include <QBasicTimer>
 #include <QObject>
 #include <QPoint>
+#include <QString>
 
+#include "config.h"
 #include "dove_eye/aggregator.h"
 #include "dove_eye/calibration_data.h"
 #include "dove_eye/camera_calibration.h"
+#include "dove_eye/fair_scheduler.h"
 #include "dove_eye/inner_tracker.h"
 #include "dove_eye/localization.h"
 #include "dove_eye/parameters.h"
+#ifdef CONFIG_HISTORY
+#include "dove_eye/history_store.h"
+#endif
+#ifdef CONFIG_SHM
+#include "dove_eye/shm_result_publisher.h"
+#endif
 #include "dove_eye/tracker.h"
 #include "dove_eye/types.h"
 #include "gui/gui_mark.h"
@@ -80,6 +90,35 @@ class Controller : public QObject {
     return undistort_mode_;
   }
 
+#ifdef CONFIG_HISTORY
+  /** Persistent record of results (not owned, may be null) */
+  inline void history_writer(dove_eye::HistoryWriter *value) {
+    history_writer_ = value;
+  }
+#endif
+
+#ifdef CONFIG_SHM
+  /** Publisher of results for local consumers (not owned, may be null)
+   *
+   * @param[in]  source  identification of this pipeline in shared publisher
+   */
+  inline void result_publisher(dove_eye::shm::ResultPublisher *value,
+                               const uint32_t source = 0) {
+    result_publisher_ = value;
+    result_source_ = source;
+  }
+#endif
+
+  /** Share CPU with other pipelines (not owned, may be null)
+   *
+   * Processing of each frameset holds a slot of the scheduler.
+   */
+  inline void cpu_scheduler(dove_eye::FairScheduler *scheduler,
+                            const dove_eye::FairScheduler::ClientId client) {
+    cpu_scheduler_ = scheduler;
+    cpu_client_ = client;
+  }
+
  signals:
   void FramesetReady(const dove_eye::Frameset);
   void PositsetReady(const dove_eye::Positset);
@@ -96,6 +135,7 @@ class Controller : public QObject {
   void Started();
   void Paused();
   void Finished();
+  void Seeked(const double time);
 
  public slots:
   void Start(bool paused);
@@ -105,6 +145,14 @@ class Controller : public QObject {
   void Step();
   void Resume();
 
+  /** Continue playback from given time
+   *
+   * Tracking state is restored from the nearest preceding snapshot and the
+   * remaining frames are re-tracked. When no snapshot can be restored, all
+   * frames from the start are re-tracked.
+   */
+  void Seek(const double time);
+
   void SetMark(const dove_eye::CameraIndex cam, const gui::GuiMark mark);
 
   void SetMode(const Mode mode);
@@ -117,6 +165,11 @@ class Controller : public QObject {
 
   void SetCalibrationData(const dove_eye::CalibrationData calibration_data);
 
+  /** Warm start tracking from stored appearance models (no marks needed) */
+  bool LoadTrackerModel(const QString &filename);
+
+  bool SaveTrackerModel(const QString &filename);
+
  protected:
   void timerEvent(QTimerEvent *event) override;
 
@@ -149,8 +202,27 @@ class Controller : public QObject {
   std::unique_ptr<dove_eye::Tracker> tracker_;
   std::unique_ptr<dove_eye::Localization> localization_;
 
+#ifdef CONFIG_HISTORY
+  dove_eye::HistoryWriter *history_writer_ = nullptr;
+#endif
+
+#ifdef CONFIG_SHM
+  dove_eye::shm::ResultPublisher *result_publisher_ = nullptr;
+  uint32_t result_source_ = 0;
+#endif
+
+  dove_eye::FairScheduler *cpu_scheduler_ = nullptr;
+  dove_eye::FairScheduler::ClientId cpu_client_ = 0;
+
+  /** Tracker states for seeking, keyed by time they were taken */
+  typedef std::unique_ptr<dove_eye::Tracker::Snapshot> SnapshotPtr;
+  typedef std::map<dove_eye::Frame::Timestamp, SnapshotPtr> SnapshotsContainer;
+  SnapshotsContainer snapshots_;
+
   bool FramesetLoop();
 
+  void SaveSnapshot();
+
   void FramesetLoopTracking(const dove_eye::Positset positset);
 
   void CalibrationDataToProviders(
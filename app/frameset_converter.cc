@@ -3,8 +3,10 @@
 #include <QTimerEvent>
 
 #include "dove_eye/logging.h"
+#include "dove_eye/mat_pool.h"
 
 using dove_eye::CameraIndex;
+using dove_eye::MatPool;
 using gui::GuiMark;
 
 
@@ -102,9 +104,8 @@ void FramesetConverter::ProcessFramesetInternal(
       continue;
     }
 
-    /* Get own copy of frame, we'll modify it. */
-    auto mat = frameset[cam].data.clone();
-    if (!mat.data) {
+    const auto &data = frameset[cam].data;
+    if (!data.data) {
       DEBUG("Empty data from cam %i", cam);
       continue;
     }
@@ -113,18 +114,22 @@ void FramesetConverter::ProcessFramesetInternal(
      * Update frame size, we do it every frame, however, it's not actually
      * assumed that frame size would change between frames.
      */
-    frame_sizes_[cam].setWidth(mat.cols);
-    frame_sizes_[cam].setHeight(mat.rows);
+    frame_sizes_[cam].setWidth(data.cols);
+    frame_sizes_[cam].setHeight(data.rows);
 
     /* Convert image for display. */
     if (viewer_sizes_[cam].width() == 0) {
       continue;
     }
 
-    auto new_size = CalculateNewSize(cam, mat.rows, mat.cols);
+    auto new_size = CalculateNewSize(cam, data.rows, data.cols);
     cv::Size cv_new_size(new_size.width(), new_size.height());
 
-    cv::resize(mat, mat, cv_new_size);
+    /* Resize to own buffer, we'll modify it (frame data are shared). */
+    MatPool::Site site("display");
+    cv::Mat mat;
+    MatPool::Use(&mat);
+    cv::resize(data, mat, cv_new_size);
 
     if (mat.channels() == 1) {
       cv::cvtColor(mat, mat, CV_GRAY2BGR);
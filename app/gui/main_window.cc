@@ -1,6 +1,8 @@
 #include "main_window.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 #include <QFileDialog>
 #include <QtDebug>
@@ -8,6 +10,9 @@
 #include "config.h"
 #include "controller.h"
 #include "dove_eye/frameset.h"
+#ifdef CONFIG_HISTORY
+#include "dove_eye/history_store.h"
+#endif
 #include "dove_eye/types.h"
 #include "frameset_viewer.h"
 #include "ui_main_window.h"
@@ -120,6 +125,8 @@ void MainWindow::SetupPipeline() {
           ui_->playback_control, &PlaybackControl::Pause);
   connect(application_->controller(), &Controller::Finished,
           ui_->playback_control, &PlaybackControl::Finish);
+  connect(application_->controller(), &Controller::Seeked,
+          ui_->playback_control, &PlaybackControl::SeekDone);
 
   /* PlaybackControl -> Controller */
   connect(ui_->playback_control, &PlaybackControl::Started,
@@ -130,6 +137,8 @@ void MainWindow::SetupPipeline() {
           application_->controller(), &Controller::Resume);
   connect(ui_->playback_control, &PlaybackControl::Stepped,
           application_->controller(), &Controller::Step);
+  connect(ui_->playback_control, &PlaybackControl::Seeked,
+          application_->controller(), &Controller::Seek);
 
 }
 
@@ -199,6 +208,40 @@ void MainWindow::SceneClearTrajectory() {
   ui_->scene_viewer->TrajectoryClear();
 }
 
+void MainWindow::SceneLoadTrajectory() {
+#ifdef CONFIG_HISTORY
+  /* Enough to draw smooth line, independent of history length */
+  const size_t kMaxPoints = 10000;
+
+  auto filename = QFileDialog::getOpenFileName(this, tr("Load trajectory"), "",
+                                               tr("History files (*)"));
+  if (filename.isNull()) {
+    return;
+  }
+
+  dove_eye::HistoryReader reader;
+  if (!reader.Open(filename.toStdString())) {
+    qWarning() << "Cannot open history" << filename;
+    return;
+  }
+
+  QVector<dove_eye::Location> trajectory;
+  if (!reader.Empty()) {
+    dove_eye::HistoryReader::SummariesVector summaries;
+    reader.Summarize(reader.start_time(),
+                     std::nextafter(reader.end_time(), reader.end_time() + 1),
+                     std::min(reader.RecordCount(), kMaxPoints), &summaries);
+    for (auto &summary : summaries) {
+      if (summary.locations > 0) {
+        trajectory.push_back(summary.mean);
+      }
+    }
+  }
+
+  ui_->scene_viewer->SetTrajectory(trajectory);
+#endif
+}
+
 void MainWindow::OpenVideoFiles() {
   application_->InitializeEmpty();
   open_videos_dialog_->SetMaxArity(Frameset::kMaxArity);
@@ -234,6 +277,15 @@ void MainWindow::SetupCameras() {
   cameras_setup_dialog_->show();
 }
 
+void MainWindow::CameraProfileLoad() {
+  auto filename = QFileDialog::getOpenFileName(this, tr("Load camera profile"),
+                                               "", tr("YAML files (*.yaml)"));
+  if (filename.isNull()) {
+    return;
+  }
+  application_->LoadCameraProfile(filename);
+}
+
 void MainWindow::ControllerModeChanged(const Controller::Mode mode) {
   /* Update menu */
   ui_->action_abort_calibration->setVisible(mode == Controller::kCalibration);
@@ -306,12 +358,20 @@ void MainWindow::SetupMenu() {
           this, &MainWindow::ParametersSave);
   connect(ui_->action_setup_cameras, &QAction::triggered,
           this, &MainWindow::SetupCameras);
+  connect(ui_->action_camera_profile_load, &QAction::triggered,
+          this, &MainWindow::CameraProfileLoad);
   connect(action_group_distortion_, &QActionGroup::triggered,
           this, &MainWindow::GroupDistortion);
   connect(ui_->action_scene_show_cameras, &QAction::triggered,
           this, &MainWindow::SceneShowCameras);
   connect(ui_->action_scene_clear_trajectory, &QAction::triggered,
           this, &MainWindow::SceneClearTrajectory);
+  connect(ui_->action_scene_load_trajectory, &QAction::triggered,
+          this, &MainWindow::SceneLoadTrajectory);
+
+#ifndef CONFIG_HISTORY
+  ui_->action_scene_load_trajectory->setEnabled(false);
+#endif
 
   /* Synchronize stateful menus */
   SceneShowCameras();
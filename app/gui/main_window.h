@@ -49,11 +49,13 @@ class MainWindow : public QMainWindow {
   void GroupDistortion(QAction *action);
   void SceneShowCameras();
   void SceneClearTrajectory();
+  void SceneLoadTrajectory();
   void OpenVideoFiles();
   void ParametersModify();
   void ParametersLoad();
   void ParametersSave();
   void SetupCameras();
+  void CameraProfileLoad();
   void ControllerModeChanged(const Controller::Mode mode);
   void SetCalibration(const bool value);
 
@@ -2,12 +2,26 @@
 
 #include <QMessageBox>
 
+#include "config.h"
 #include "dove_eye/camera_video_provider.h"
+#ifdef CONFIG_SHM
+#include "dove_eye/shm_video_provider.h"
+#endif
 #include "ui_open_videos_dialog.h"
 #include "widgets/file_selector.h"
 
 using dove_eye::CameraIndex;
 using dove_eye::FileVideoProvider;
+#ifdef CONFIG_SHM
+using dove_eye::ShmVideoProvider;
+#endif
+using dove_eye::VideoProvider;
+
+namespace {
+
+const QString kShmPrefix("shm:");
+
+} // namespace
 
 namespace gui {
 
@@ -68,8 +82,11 @@ void OpenVideosDialog::OnAccepted() const {
   assert(providers_ptr_->size() == 0);
 
   bool has_error = false;
+  /* Shm rings are live sources (start at the newest frame, drop frames) */
+  bool live = false;
   for (auto file_selector : this->findChildren<widgets::FileSelector *>()) {
     if (file_selector->Selected()) {
+      live = live || file_selector->Filename().startsWith(kShmPrefix);
       auto provider = CreateVideoProvider(file_selector->Filename());
       if (provider == nullptr) {
         has_error = true;
@@ -90,7 +107,8 @@ void OpenVideosDialog::OnAccepted() const {
   }
 
   if (!has_error && !result.empty()) {
-    emit SelectedProviders(Application::kVideoFiles, result);
+    emit SelectedProviders(live ? Application::kCameras
+                                : Application::kVideoFiles, result);
   }
   /*
    * If we don't emit, providers are still stored in application's owning
@@ -99,10 +117,22 @@ void OpenVideosDialog::OnAccepted() const {
   providers_ptr_->clear();
 }
 
-FileVideoProvider *OpenVideosDialog::CreateVideoProvider(const QString &filename)
+/**
+ * Filename "shm:<name>" opens a shared memory frame ring.
+ */
+VideoProvider *OpenVideosDialog::CreateVideoProvider(const QString &filename)
     const {
-  // TODO
-  auto provider = new FileVideoProvider(filename.toStdString());
+  VideoProvider *provider = nullptr;
+#ifdef CONFIG_SHM
+  if (filename.startsWith(kShmPrefix)) {
+    const auto name = filename.mid(kShmPrefix.size()).toStdString();
+    provider = new ShmVideoProvider(name);
+  }
+#endif
+  if (!provider) {
+    provider = new FileVideoProvider(filename.toStdString());
+  }
+
   if (provider->begin() == provider->end()) {
     delete provider;
     provider = nullptr;
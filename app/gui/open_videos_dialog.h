@@ -9,6 +9,7 @@
 #include "application.h"
 #include "dove_eye/file_video_provider.h"
 #include "dove_eye/types.h"
+#include "dove_eye/video_provider.h"
 
 namespace Ui {
 class OpenVideosDialog;
@@ -37,7 +38,7 @@ class OpenVideosDialog : public QDialog {
  private:
   std::unique_ptr<Ui::OpenVideosDialog> ui_;
 
-  dove_eye::FileVideoProvider *CreateVideoProvider(const QString &filename) const;
+  dove_eye::VideoProvider *CreateVideoProvider(const QString &filename) const;
 
   Application::VideoProvidersVectorOwning *providers_ptr_;
 };
@@ -23,16 +23,6 @@ class CalibrationDataStorage : public QObject {
   dove_eye::CalibrationData LoadFromFile(const QString &filename);
   void SaveToFile(const QString &filename,
                   const dove_eye::CalibrationData &data);
- private:
-  const char *kNameArity = "arity";
-  const char *kNameCameraMatrix = "C";
-  const char *kNameDistortionCoefficients = "D";
-  const char *kNameEssentialMatrix = "E";
-  const char *kNameFundamentalMatrix = "F";
-  const char *kNamePairRotation = "R";
-  const char *kNamePosition = "position";
-  const char *kNameRotation = "rotation";
-  const char *kNameTranslation = "T";
 };
 
 } // end namespace io
@@ -0,0 +1,252 @@
+#include "io/command_server.h"
+
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTextStream>
+
+#include "dove_eye/calibration_data.h"
+#include "dove_eye/calibration_storage.h"
+#include "dove_eye/metrics.h"
+#include "gui/gui_mark.h"
+
+using dove_eye::CalibrationData;
+using dove_eye::CalibrationStorage;
+using dove_eye::CameraIndex;
+using dove_eye::Metrics;
+using dove_eye::Parameters;
+using gui::GuiMark;
+
+namespace {
+
+const QString kOk = "ok";
+const QString kError = "error ";
+/* Keys of rigs sharing the process start with it (see RigHost) */
+const std::string kRigMetricsPrefix = "rig.";
+
+} // namespace
+
+namespace io {
+
+CommandServer::CommandServer(Parameters &parameters,
+                             Controller *controller,
+                             QObject *parent)
+    : QObject(parent),
+      parameters_storage_(parameters),
+      controller_(controller),
+      server_(new QLocalServer(this)),
+      running_(false),
+      finished_(false) {
+  connect(server_, &QLocalServer::newConnection,
+          this, &CommandServer::NewConnection);
+
+  connect(controller_, &Controller::Started,
+          this, &CommandServer::ControllerStarted);
+  connect(controller_, &Controller::Paused,
+          this, &CommandServer::ControllerPaused);
+  connect(controller_, &Controller::Finished,
+          this, &CommandServer::ControllerFinished);
+}
+
+bool CommandServer::Listen(const QString &name) {
+  /* Stale socket of a crashed instance would block us */
+  QLocalServer::removeServer(name);
+  server_->setSocketOptions(QLocalServer::UserAccessOption);
+
+  if (!server_->listen(name)) {
+    qWarning("Cannot listen on %s: %s", qPrintable(name),
+             qPrintable(server_->errorString()));
+    return false;
+  }
+  return true;
+}
+
+void CommandServer::NewConnection() {
+  while (auto socket = server_->nextPendingConnection()) {
+    connect(socket, &QLocalSocket::readyRead,
+            this, &CommandServer::ReadCommands);
+    connect(socket, &QLocalSocket::disconnected,
+            socket, &QLocalSocket::deleteLater);
+  }
+}
+
+void CommandServer::ReadCommands() {
+  auto socket = qobject_cast<QLocalSocket *>(sender());
+  if (!socket) {
+    return;
+  }
+
+  while (socket->canReadLine()) {
+    const QString line = QString::fromUtf8(socket->readLine()).trimmed();
+    if (line.isEmpty()) {
+      continue;
+    }
+
+    const auto response = Execute(line.split(' ', QString::SkipEmptyParts));
+    socket->write(response.toUtf8());
+    socket->write("\n");
+  }
+}
+
+void CommandServer::ControllerStarted() {
+  running_ = true;
+}
+
+void CommandServer::ControllerPaused() {
+  running_ = false;
+}
+
+void CommandServer::ControllerFinished() {
+  running_ = false;
+  finished_ = true;
+}
+
+QString CommandServer::Execute(const QStringList &arguments) {
+  const auto command = arguments[0];
+
+  if (command == "start") {
+    if (finished_) {
+      return kError + "video finished";
+    }
+    if (!running_) {
+      controller_->Resume();
+    }
+    return kOk;
+
+  } else if (command == "pause") {
+    if (running_) {
+      controller_->Pause();
+    }
+    return kOk;
+
+  } else if (command == "step") {
+    if (running_) {
+      return kError + "not paused";
+    }
+    controller_->Step();
+    return kOk;
+
+  } else if (command == "seek" && arguments.size() == 2) {
+    bool ok;
+    const double time = arguments[1].toDouble(&ok);
+    if (!ok || time < 0) {
+      return kError + "invalid time";
+    }
+    controller_->Seek(time);
+    finished_ = false;
+    return kOk;
+
+  } else if (command == "mode" && arguments.size() == 2) {
+    if (arguments[1] == "idle") {
+      controller_->SetMode(Controller::kIdle);
+    } else if (arguments[1] == "calibration") {
+      controller_->SetMode(Controller::kCalibration);
+    } else if (arguments[1] == "tracking") {
+      controller_->SetMode(Controller::kTracking);
+    } else {
+      return kError + "unknown mode";
+    }
+    return kOk;
+
+  } else if (command == "localization" && arguments.size() == 2) {
+    controller_->SetLocalizationActive(arguments[1] == "on");
+    return kOk;
+
+  } else if (command == "mark") {
+    return ExecuteMark(arguments);
+
+  } else if (command == "calibration" && arguments.size() == 2) {
+    CalibrationData calibration_data;
+    if (!CalibrationStorage::LoadFromFile(arguments[1].toStdString(),
+                                          &calibration_data)) {
+      return kError + "cannot load calibration";
+    }
+    if (calibration_data.Arity() != controller_->Arity()) {
+      return kError + "arity mismatch";
+    }
+    controller_->SetCalibrationData(calibration_data);
+    return kOk;
+
+  } else if (command == "parameters" && arguments.size() == 2) {
+    parameters_storage_.LoadFromFile(arguments[1]);
+    return kOk;
+
+  } else if (command == "model" && arguments.size() == 3) {
+    bool success = false;
+    if (arguments[1] == "load") {
+      success = controller_->LoadTrackerModel(arguments[2]);
+    } else if (arguments[1] == "save") {
+      success = controller_->SaveTrackerModel(arguments[2]);
+    } else {
+      return kError + "usage: model load|save <file>";
+    }
+    return success ? kOk : kError + "model " + arguments[1] + " failed";
+
+  } else if (command == "metrics") {
+    return ExecuteMetrics() + kOk;
+
+  } else if (command == "quit") {
+    emit QuitRequested();
+    return kOk;
+  }
+
+  return kError + "unknown command";
+}
+
+/** Mark is given by its center and optionally radius (in pixels) */
+QString CommandServer::ExecuteMark(const QStringList &arguments) {
+  if (arguments.size() != 4 && arguments.size() != 5) {
+    return kError + "usage: mark <cam> <x> <y> [<radius>]";
+  }
+
+  bool ok = true;
+  bool valid = true;
+  const CameraIndex cam = arguments[1].toInt(&ok);
+  valid = valid && ok;
+  const int x = arguments[2].toInt(&ok);
+  valid = valid && ok;
+  const int y = arguments[3].toInt(&ok);
+  valid = valid && ok;
+  const int radius = (arguments.size() == 5) ? arguments[4].toInt(&ok) : 0;
+  valid = valid && ok;
+
+  if (!valid || cam < 0 || cam >= controller_->Arity() || radius < 0) {
+    return kError + "invalid mark";
+  }
+
+  GuiMark mark;
+  mark.press_pos = QPoint(x - radius, y - radius);
+  mark.release_pos = QPoint(x + radius, y + radius);
+  if (!radius) {
+    /* Empty mark is sized by tracker parameters */
+    mark.press_pos = mark.release_pos;
+  }
+
+  controller_->SetMark(cam, mark);
+  return kOk;
+}
+
+QString CommandServer::ExecuteMetrics() const {
+  QString result;
+  QTextStream stream(&result);
+
+  stream << "controller.mode " << controller_->mode() << "\n";
+  stream << "controller.running " << running_ << "\n";
+  for (auto &value : Metrics::Global().Snapshot()) {
+    auto name = value.first;
+    if (!metrics_prefix_.empty() &&
+        name.compare(0, metrics_prefix_.size(), metrics_prefix_) == 0) {
+      name = name.substr(metrics_prefix_.size());
+    } else if (name.compare(0, kRigMetricsPrefix.size(),
+                            kRigMetricsPrefix) == 0) {
+      /* Other rig's */
+      continue;
+    }
+
+    stream << QString::fromStdString(name) << " " << value.second << "\n";
+  }
+
+  stream.flush();
+  return result;
+}
+
+} // end namespace io
@@ -0,0 +1,84 @@
+#ifndef IO_COMMAND_SERVER_H_
+#define IO_COMMAND_SERVER_H_
+
+#include <string>
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include "controller.h"
+#include "dove_eye/parameters.h"
+#include "io/parameters_storage.h"
+
+/* Forward */
+class QLocalServer;
+class QLocalSocket;
+
+namespace io {
+
+/** Line oriented control interface of a headless controller
+ *
+ * Listens on a local (Unix domain) socket. Each request is a single line,
+ * response is zero or more data lines followed by "ok" or "error <reason>".
+ *
+ * Commands:
+ *   start | pause | step
+ *   seek <time>
+ *   mode idle|calibration|tracking
+ *   localization on|off
+ *   mark <cam> <x> <y> [<radius>]
+ *   calibration <file>
+ *   parameters <file>
+ *   model load|save <file>
+ *   metrics (of this rig when several share the process)
+ *   quit
+ */
+class CommandServer : public QObject {
+  Q_OBJECT
+ public:
+  CommandServer(dove_eye::Parameters &parameters,
+                Controller *controller,
+                QObject *parent = nullptr);
+
+  bool Listen(const QString &name);
+
+  /** Only rig's own keys (prefix stripped) and shared ones are reported */
+  inline void metrics_prefix(const std::string &value) {
+    metrics_prefix_ = value;
+  }
+
+ signals:
+  void QuitRequested();
+
+ private slots:
+  void NewConnection();
+  void ReadCommands();
+
+  void ControllerStarted();
+  void ControllerPaused();
+  void ControllerFinished();
+
+ private:
+  ParametersStorage parameters_storage_;
+  Controller *controller_;
+
+  QLocalServer *server_;
+
+  bool running_;
+  bool finished_;
+
+  std::string metrics_prefix_;
+
+  QString Execute(const QStringList &arguments);
+
+  QString ExecuteMark(const QStringList &arguments);
+
+  QString ExecuteMetrics() const;
+};
+
+} // end namespace io
+
+#endif // IO_COMMAND_SERVER_H_
@@ -11,8 +11,13 @@ void ParametersStorage::LoadFromFile(const QString &filename) {
   FileStorage fs(filename.toStdString(), FileStorage::READ);
 
   for (auto &param : parameters_) {
-    double value;
     auto name = NormalizeName(QString::fromStdString(param.name)).toStdString();
+    /* Files saved by older versions lack newer keys, keep their defaults */
+    if (fs[name].empty()) {
+      continue;
+    }
+
+    double value;
     fs[name] >> value;
     parameters_.Set(param.key, value);
   }
@@ -0,0 +1,98 @@
+#include "rig_host.h"
+
+#include <QtDebug>
+
+using dove_eye::FairScheduler;
+
+RigHost::RigHost(const size_t cpu_slots, QObject *parent)
+    : QObject(parent),
+      scheduler_(cpu_slots) {
+}
+
+RigHost::~RigHost() {
+  Stop();
+}
+
+bool RigHost::CreateResultPublisher(const std::string &name) {
+#ifdef CONFIG_SHM
+  if (!result_publisher_.Create(name)) {
+    return false;
+  }
+  /* Rigs publish from their threads */
+  result_publisher_.shared(true);
+  return true;
+#else
+  (void) name;
+  return false;
+#endif
+}
+
+void RigHost::AddRig(const std::string &name, const double weight,
+                     const RigFactory &factory) {
+  RigContext context;
+  context.index = rigs_.size();
+  context.name = name;
+  context.scheduler = &scheduler_;
+  context.client = scheduler_.AddClient(name, weight);
+  context.metrics_prefix = "rig." + name + ".";
+#ifdef CONFIG_SHM
+  context.result_publisher =
+      result_publisher_.IsOpen() ? &result_publisher_ : nullptr;
+#endif
+
+  auto rig = new RigThread(context, factory);
+  connect(rig, &RigThread::SetupFailed, this, &RigHost::Failed);
+  rigs_.push_back(RigThreadPtr(rig));
+}
+
+void RigHost::Start() {
+  qDebug() << "Starting" << rigs_.size() << "rig(s) sharing" <<
+      scheduler_.slots() << "CPU slot(s)";
+
+  for (auto &rig : rigs_) {
+#ifdef CONFIG_SINGLE_THREADED
+    if (!rig->Setup()) {
+      emit Failed();
+    }
+#else
+    rig->start();
+#endif
+  }
+}
+
+void RigHost::Stop() {
+  for (auto &rig : rigs_) {
+#ifdef CONFIG_SINGLE_THREADED
+    rig->Teardown();
+#else
+    rig->quit();
+#endif
+  }
+
+  for (auto &rig : rigs_) {
+    rig->wait();
+  }
+}
+
+bool RigThread::Setup() {
+  rig_.reset(factory_(context_));
+  if (!rig_) {
+    qWarning("Cannot set up rig %s", context_.name.c_str());
+    return false;
+  }
+  return true;
+}
+
+void RigThread::Teardown() {
+  rig_.reset();
+}
+
+void RigThread::run() {
+  if (!Setup()) {
+    emit SetupFailed();
+    return;
+  }
+
+  exec();
+  Teardown();
+}
@@ -0,0 +1,130 @@
+#ifndef RIG_HOST_H_
+#define RIG_HOST_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QObject>
+#include <QThread>
+
+#include "config.h"
+#include "dove_eye/fair_scheduler.h"
+#ifdef CONFIG_SHM
+#include "dove_eye/shm_result_publisher.h"
+#endif
+
+/** Objects of single rig (destroyed in rig's thread, see RigHost) */
+class Rig {
+ public:
+  virtual ~Rig() {
+  }
+};
+
+/** What rig shares with the others */
+struct RigContext {
+  size_t index;
+  std::string name;
+  dove_eye::FairScheduler *scheduler;
+  dove_eye::FairScheduler::ClientId client;
+  /** Prefix of rig's keys in the shared metrics registry */
+  std::string metrics_prefix;
+#ifdef CONFIG_SHM
+  /** Null when shared memory is not available */
+  dove_eye::shm::ResultPublisher *result_publisher;
+#endif
+};
+
+/** Create rig's pipeline (called in the rig's thread)
+ *
+ * @return  new rig (caller owns it) or nullptr on error
+ */
+typedef std::function<Rig *(const RigContext &context)> RigFactory;
+
+/** Thread creating, running and destroying single rig */
+class RigThread : public QThread {
+  Q_OBJECT
+ public:
+  RigThread(const RigContext &context, const RigFactory &factory)
+      : context_(context),
+        factory_(factory) {
+  }
+
+  /** @return  false when the factory failed */
+  bool Setup();
+
+  void Teardown();
+
+ signals:
+  void SetupFailed();
+
+ protected:
+  void run() override;
+
+ private:
+  const RigContext context_;
+  const RigFactory factory_;
+  std::unique_ptr<Rig> rig_;
+};
+
+/** Runs several independent pipelines (rigs) in one process
+ *
+ * Each rig has its own providers, calibration, Parameters and Controller.
+ * Rig objects are created, used and destroyed in the rig's own thread, so
+ * that waiting for frames of one rig doesn't stall the others.
+ *
+ * Rigs share the worker pool (WorkerPool::Shared()), OpenCV threads, the
+ * metrics registry (rig's keys are prefixed with "rig.<name>.") and the result
+ * publisher (records are told apart by source, i.e. rig index). CPU bound processing of framesets is scheduled
+ * fairly between rigs by FairScheduler.
+ *
+ * @note With CONFIG_SINGLE_THREADED all rigs live in the host's thread.
+ */
+class RigHost : public QObject {
+  Q_OBJECT
+ public:
+  /** @param[in]  cpu_slots  rigs processing concurrently (0 means number of
+   *                         hardware threads)
+   */
+  explicit RigHost(const size_t cpu_slots = 0, QObject *parent = nullptr);
+
+  ~RigHost() override;
+
+  /** Shared publisher of all rigs' results (create it before adding rigs) */
+  bool CreateResultPublisher(const std::string &name);
+
+  /** @param[in]  weight  relative CPU share of the rig */
+  void AddRig(const std::string &name, const double weight,
+              const RigFactory &factory);
+
+  inline size_t size() const {
+    return rigs_.size();
+  }
+
+  inline dove_eye::FairScheduler &scheduler() {
+    return scheduler_;
+  }
+
+ signals:
+  /** Some rig could not be created */
+  void Failed();
+
+ public slots:
+  void Start();
+
+  /** Quit rigs' event loops and destroy the rigs */
+  void Stop();
+
+ private:
+  typedef std::unique_ptr<RigThread> RigThreadPtr;
+
+  dove_eye::FairScheduler scheduler_;
+#ifdef CONFIG_SHM
+  dove_eye::shm::ResultPublisher result_publisher_;
+#endif
+
+  std::vector<RigThreadPtr> rigs_;
+};
+
+#endif // RIG_HOST_H_
@@ -16,6 +16,8 @@ PlaybackControl::PlaybackControl(QWidget *parent)
           this, &PlaybackControl::PauseClicked);
   connect(ui_->btn_step, &QPushButton::clicked,
           this, &PlaybackControl::StepClicked);
+  connect(ui_->btn_seek, &QPushButton::clicked,
+          this, &PlaybackControl::SeekClicked);
 
   SetState(kStopped);
 }
@@ -35,6 +37,13 @@ void PlaybackControl::Finish() {
   SetState(kStopped);
 }
 
+void PlaybackControl::SeekDone(const double time) {
+  /* Finished playback can continue after seeking back */
+  if (state_ == kStopped) {
+    SetState(kPaused);
+  }
+}
+
 void PlaybackControl::PlayClicked() {
   switch (state_) {
     case kStopped:
@@ -59,12 +68,17 @@ void PlaybackControl::StepClicked() {
   emit Stepped();
 }
 
+void PlaybackControl::SeekClicked() {
+  emit Seeked(ui_->spin_time->value());
+}
+
 void PlaybackControl::SetState(State state) {
   state_ = state;
 
   ui_->btn_play->setEnabled(state_ == kStopped || state_ == kPaused);
   ui_->btn_pause->setEnabled(state_ == kPlaying);
   ui_->btn_step->setEnabled(state_ == kStopped || state_ == kPaused);
+  ui_->btn_seek->setEnabled(state_ == kStopped || state_ == kPaused);
 }
 
 } // end namespace widgets
@@ -35,15 +35,19 @@ class PlaybackControl : public QWidget {
 
   void Stepped();
 
+  void Seeked(double time);
+
  public slots:
   void Start();
   void Pause();
   void Finish();
+  void SeekDone(const double time);
 
  private slots:
   void PlayClicked();
   void PauseClicked();
   void StepClicked();
+  void SeekClicked();
   void SetState(State state);
 
  private:
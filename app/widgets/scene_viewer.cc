@@ -113,6 +113,13 @@ void SceneViewer::TrajectoryClear() {
   DEBUG("%s", __func__);
 }
 
+void SceneViewer::SetTrajectory(const QVector<Location> &trajectory) {
+  TrajectoryClear();
+  for (auto &location : trajectory) {
+    TrajectoryAppend(location);
+  }
+}
+
 void SceneViewer::TrajectoryAppend(const dove_eye::Location &location) {
   using std::min;
   using std::max;
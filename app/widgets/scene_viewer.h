@@ -29,6 +29,9 @@ class SceneViewer : public QGLViewer {
 
   void TrajectoryClear();
 
+  /** Replace trajectory (e.g. loaded from history) */
+  void SetTrajectory(const QVector<dove_eye::Location> &trajectory);
+
  protected:
   void init() override;
   void draw() override;
@@ -7,4 +7,19 @@
 
 #cmakedefine CONFIG_SINGLE_THREADED
 
+#cmakedefine CONFIG_MAT_POOL
+
+#cmakedefine CONFIG_SHM
+
+#cmakedefine CONFIG_NODES
+
+#cmakedefine CONFIG_HISTORY
+
+#cmakedefine CONFIG_MJPEG
+
+#cmakedefine CONFIG_CHARUCO
+
+#cmakedefine CONFIG_STATIC_TRACKER "${CONFIG_STATIC_TRACKER}"
+#cmakedefine CONFIG_STATIC_TRACKER_CLASS ${CONFIG_STATIC_TRACKER_CLASS}
+
 #endif // CONFIG_H_
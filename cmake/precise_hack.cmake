@@ -7,6 +7,7 @@ endmacro()
 
 setup_qt_module("Qt5Core")
 setup_qt_module("Qt5Gui")
+setup_qt_module("Qt5Network")
 setup_qt_module("Qt5OpenGL")
 setup_qt_module("Qt5Widgets")
 setup_qt_module("Qt5Xml")
@@ -1,8 +1,10 @@
 #ifndef DOVE_EYE_AGGREGATOR_H_
 #define DOVE_EYE_AGGREGATOR_H_
 
+#include <algorithm>
 #include <cassert>
 #include <deque>
+#include <string>
 #include <vector>
 
 #include "dove_eye/aggregator_iterator.h"
@@ -48,6 +50,40 @@ class Aggregator {
     return Iterator(this, false);
   }
 
+  /** Restart reading of all providers at given (aggregated) time
+   *
+   * All existing iterators are invalidated, continue with new begin().
+   *
+   * @return  false when some provider or the frame policy cannot seek
+   */
+  inline bool Seek(const Frame::Timestamp time) {
+    CameraIndex cam = 0;
+    for (auto provider : providers_) {
+      /* Inverse of offset application in AggregatorIterator */
+      const auto offset = parameters_.Get(Parameters::CAM_OFFSET, cam);
+      if (!provider->Seek(std::max(0.0, time + offset))) {
+        return false;
+      }
+      ++cam;
+    }
+
+    return Restart();
+  }
+
+  /** Pace reading anew from the next frame (e.g. after a pause or a step)
+   *
+   * Reading continues where it was, only deadlines of paced playback are
+   * moved, so that the pause doesn't make following frames late.
+   */
+  inline void Reschedule() {
+    RestartSchedule();
+  }
+
+  /** Prefix of frame policy's keys in Metrics::Global() */
+  inline void metrics_prefix(const std::string &value) {
+    SetMetricsPrefix(value);
+  }
+
   inline CameraIndex Arity() const {
     return arity_;
   }
@@ -67,6 +103,13 @@ class Aggregator {
 
   virtual void Start() = 0;
 
+  /** Forget reading state, next Start begins again */
+  virtual bool Restart() = 0;
+
+  virtual void RestartSchedule() = 0;
+
+  virtual void SetMetricsPrefix(const std::string &value) = 0;
+
   virtual bool GetFrame(Frame *frame, CameraIndex *cam) = 0;
 
 };
@@ -7,6 +7,7 @@
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <string>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -15,6 +16,7 @@
 #include "dove_eye/frameset_aggregator.h"
 #include "dove_eye/types.h"
 #include "dove_eye/logging.h"
+#include "dove_eye/parameters.h"
 #include "dove_eye/video_provider.h"
 
 
@@ -25,7 +27,9 @@ class AsyncPolicy {
  public:
   typedef std::vector<VideoProvider *> ProvidersContainer;
 
-  explicit AsyncPolicy(const ProvidersContainer &providers)
+  /* Live sources run at their own pace, parameters are not needed */
+  AsyncPolicy(const ProvidersContainer &providers,
+              const Parameters & /* parameters */)
       : providers_(providers),
         threads_(providers_.size()),
         max_queue_size_(providers_.size() * kQueueSizeFactor_) {
@@ -51,6 +55,20 @@ class AsyncPolicy {
     }
   }
 
+  bool Restart() {
+    /* Live streams cannot be rewound */
+    return false;
+  }
+
+  inline void Reschedule() {
+    /* Live streams are not paced */
+  }
+
+  inline void metrics_prefix(const std::string &value) {
+    /* No metrics of its own */
+    (void) value;
+  }
+
   bool GetFrame(Frame *frame, CameraIndex *cam) {
     Lock lock(queue_mtx_);
 
@@ -59,7 +77,8 @@ class AsyncPolicy {
                     return queue_.size() > 0 || running_producers_ == 0;
                    });
 
-    if (running_producers_ == 0) {
+    /* Finished providers may have left frames in the queue */
+    if (queue_.empty()) {
       return false;
     }
 
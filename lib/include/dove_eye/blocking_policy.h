@@ -2,26 +2,51 @@
 #define DOVE_EYE_BLOCKING_POLICY_H_
 
 #include <cassert>
+#include <chrono>
 #include <memory>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "dove_eye/frame.h"
+#include "dove_eye/metrics.h"
+#include "dove_eye/parameters.h"
 #include "dove_eye/types.h"
 #include "dove_eye/video_provider.h"
 
 
 namespace dove_eye {
 
+/** Reads all frames of (recorded) providers
+ *
+ * By default frames are read as fast as consumer takes them. With
+ * Parameters::PLAYBACK_SPEED set, each frame is held until its deadline,
+ * i.e. its timestamp scaled by the speed from the first paced frame.
+ * Deadlines are absolute, so time spent decoding and processing doesn't
+ * accumulate. Late frames are passed immediately (the consumer catches up)
+ * unless they're late more than Parameters::PLAYBACK_DROP_LATE, then they're
+ * dropped. After kMaxDrops consecutive drops (reading itself is slower than
+ * the speed) a frame is passed and the schedule restarts from it, so that
+ * playback never drops everything until the end. Speeds below kMinSpeed are
+ * raised to it. When consumer pauses, it must call Reschedule(), otherwise
+ * frames after the pause are late.
+ */
 class BlockingPolicy {
  public:
   typedef std::vector<VideoProvider *> ProvidersContainer;
 
-  explicit BlockingPolicy(const ProvidersContainer &providers)
+  BlockingPolicy(const ProvidersContainer &providers,
+                 const Parameters &parameters)
       : providers_(providers),
+        parameters_(parameters),
         current_cam_(0),
         initialized_(false),
         iterators_(providers_.size()),
-        ends_(providers_.size()) {
+        ends_(providers_.size()),
+        paced_(false),
+        drops_(0),
+        late_metric_("playback.late"),
+        dropped_metric_("playback.dropped") {
   }
 
   void Start() {
@@ -39,7 +64,66 @@ class BlockingPolicy {
     }
   }
 
+  bool Restart() {
+    /* Release old iterators, Start creates new ones */
+    for (int i = 0; i < providers_.size(); ++i) {
+      iterators_[i] = FrameIterator();
+      ends_[i] = FrameIterator();
+    }
+    current_cam_ = 0;
+    initialized_ = false;
+    /* Timestamps jump, schedule anew */
+    paced_ = false;
+    return true;
+  }
+
+  /** Next frame starts a new schedule (consumer paused meanwhile) */
+  inline void Reschedule() {
+    paced_ = false;
+  }
+
+  inline void metrics_prefix(const std::string &value) {
+    late_metric_ = value + "playback.late";
+    dropped_metric_ = value + "playback.dropped";
+  }
+
   bool GetFrame(Frame *frame, CameraIndex *cam) {
+    do {
+      if (!NextFrame(frame, cam)) {
+        return false;
+      }
+    } while (!Pace(frame->timestamp));
+
+    return true;
+  }
+
+ private:
+  typedef std::vector<FrameIterator> Iterators;
+  typedef std::chrono::steady_clock Clock;
+
+  /** Lowest speed of paced playback */
+  static constexpr double kMinSpeed = 0.25;
+  /** Consecutive dropped frames before schedule restarts */
+  static const int kMaxDrops = 16;
+
+  ProvidersContainer providers_;
+  const Parameters &parameters_;
+  CameraIndex current_cam_;
+  bool initialized_;
+  Iterators iterators_;
+  Iterators ends_;
+
+  /* Pacing schedule, frame with origin_timestamp_ is due at origin_ */
+  bool paced_;
+  double speed_;
+  Clock::time_point origin_;
+  Frame::Timestamp origin_timestamp_;
+  int drops_;
+
+  std::string late_metric_;
+  std::string dropped_metric_;
+
+  bool NextFrame(Frame *frame, CameraIndex *cam) {
     assert(initialized_);
 
     int attempts = 0;
@@ -64,14 +148,65 @@ class BlockingPolicy {
     return true;
   }
 
- private:
-  typedef std::vector<FrameIterator> Iterators;
+  /** Wait for frame's deadline
+   *
+   * @return  false when the frame should be dropped
+   */
+  bool Pace(const Frame::Timestamp timestamp) {
+    const double speed = parameters_.Get(Parameters::PLAYBACK_SPEED);
+    if (speed <= 0) {
+      paced_ = false;
+      return true;
+    }
 
-  ProvidersContainer providers_;
-  CameraIndex current_cam_;
-  bool initialized_;
-  Iterators iterators_;
-  Iterators ends_;
+    const auto now = Clock::now();
+    /* Speed change keeps position in the recording, not the deadlines */
+    if (!paced_ || speed != speed_) {
+      speed_ = speed;
+      Schedule(now, timestamp);
+      return true;
+    }
+
+    const double effective_speed = (speed_ < kMinSpeed) ? kMinSpeed : speed_;
+    const std::chrono::duration<double> offset(
+        (timestamp - origin_timestamp_) / effective_speed);
+    const auto deadline =
+        origin_ + std::chrono::duration_cast<Clock::duration>(offset);
+    if (deadline > now) {
+      drops_ = 0;
+      Metrics::Global().Set(late_metric_, 0);
+      std::this_thread::sleep_until(deadline);
+      return true;
+    }
+
+    const double late = std::chrono::duration<double>(now - deadline).count();
+    const double drop_late = parameters_.Get(Parameters::PLAYBACK_DROP_LATE);
+    if (drop_late > 0 && late > drop_late) {
+      if (drops_ < kMaxDrops) {
+        ++drops_;
+        Metrics::Global().Add(dropped_metric_);
+        return false;
+      }
+
+      /* Dropping doesn't catch up, continue from this frame */
+      Schedule(now, timestamp);
+      Metrics::Global().Set(late_metric_, 0);
+      return true;
+    }
+
+    drops_ = 0;
+    Metrics::Global().Set(late_metric_, late);
+    return true;
+  }
+
+  /** Make the frame with timestamp due at the time */
+  void Schedule(const Clock::time_point time,
+                const Frame::Timestamp timestamp) {
+    paced_ = true;
+    origin_ = time;
+    origin_timestamp_ = timestamp;
+    drops_ = 0;
+  }
 };
 
 
@@ -0,0 +1,114 @@
+#ifndef DOVE_EYE_BUNDLE_ADJUSTMENT_H_
+#define DOVE_EYE_BUNDLE_ADJUSTMENT_H_
+
+#include <cstddef>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "dove_eye/types.h"
+
+namespace dove_eye {
+
+/** Joint refinement of camera poses from views of calibration pattern
+ *
+ * Unknowns are poses of all cameras relative to camera 0 (optionally their
+ * intrinsics too) and pose of the pattern in each view, residuals are
+ * reprojection errors of pattern points. They're minimized by
+ * Levenberg-Marquardt method.
+ *
+ * Each residual depends on single camera and single view only. Thanks to
+ * that, view parameters are eliminated from normal equations (Schur
+ * complement of their block diagonal) and only small dense system of camera
+ * parameters is solved. Iteration is linear in number of observations.
+ */
+class BundleAdjustment {
+ public:
+  struct Camera {
+    cv::Mat camera_matrix;
+    cv::Mat distortion_coefficients;
+    /** Rotation (3x3) from camera 0 coordinates */
+    cv::Mat rotation;
+    /** Translation (3x1) from camera 0 coordinates */
+    cv::Mat translation;
+  };
+
+  typedef std::vector<Camera> CameraVector;
+
+  struct Observation {
+    CameraIndex cam;
+    Point2Vector image_points;
+    /** Indices of object points (partial view), empty when all are seen */
+    PointIdVector point_ids;
+  };
+
+  /** Observations of the pattern in single frameset */
+  typedef std::vector<Observation> View;
+
+  static const int kMaxIterations = 50;
+
+  /** @param[in]  refine_intrinsics  refine focal lengths, principal point and
+   *                                 two radial distortion coefficients too
+   */
+  BundleAdjustment(const Point3Vector &object_points,
+                   const bool refine_intrinsics);
+
+  void AddView(const View &view);
+
+  inline size_t ViewCount() const {
+    return views_.size();
+  }
+
+  /** Refine cameras (initial estimate on input)
+   *
+   * Camera 0 pose stays fixed, it defines the coordinate system.
+   *
+   * @return  RMS reprojection error, negative on failure (cameras intact)
+   */
+  double Solve(CameraVector *cameras,
+               const int max_iterations = kMaxIterations) const;
+
+ private:
+  struct NormalEquations;
+
+  const Point3Vector object_points_;
+  const bool refine_intrinsics_;
+
+  std::vector<View> views_;
+
+  inline int CameraParamCount() const {
+    return refine_intrinsics_ ? 12 : 6;
+  }
+
+  Point3Vector ObjectPoints(const Observation &observation) const;
+
+  void CameraModel(const Camera &camera, const cv::Mat &params,
+                   cv::Mat *camera_matrix, cv::Mat *distortion) const;
+
+  /** Residuals of the observation (and their Jacobians when not null) */
+  void Project(const Observation &observation, const Camera &camera,
+               const cv::Mat &camera_params, const cv::Mat &view_params,
+               cv::Mat *residuals,
+               cv::Mat *camera_jacobian, cv::Mat *view_jacobian) const;
+
+  /** @return  sum of squared residuals */
+  double Cost(const CameraVector &cameras, const cv::Mat &camera_params,
+              const cv::Mat &view_params) const;
+
+  bool InitializeViews(const CameraVector &cameras,
+                       const cv::Mat &camera_params,
+                       cv::Mat *view_params) const;
+
+  void BuildNormalEquations(const CameraVector &cameras,
+                            const cv::Mat &camera_params,
+                            const cv::Mat &view_params,
+                            NormalEquations *equations) const;
+
+  /** Damped step, @return  false when the system is singular */
+  bool SolveStep(const NormalEquations &equations, const double lambda,
+                 cv::Mat *camera_step, cv::Mat *view_step) const;
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_BUNDLE_ADJUSTMENT_H_
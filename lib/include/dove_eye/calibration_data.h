@@ -9,12 +9,6 @@
 #include "dove_eye/camera_pair.h"
 #include "dove_eye/types.h"
 
-#ifdef HAVE_GUI
-/* Forwards */
-class QString;
-#include "io/calibration_data_storage.h"
-#endif
-
 namespace dove_eye {
 
 struct CameraParameters {
@@ -34,9 +28,7 @@ struct PairParameters {
  */
 class CalibrationData {
   friend class CameraCalibration;
-#ifdef HAVE_GUI
-  friend CalibrationData io::CalibrationDataStorage::LoadFromFile(const QString &);
-#endif
+  friend class CalibrationStorage;
 
  public:
   explicit CalibrationData(const CameraIndex arity = 0)
@@ -11,12 +11,28 @@ namespace dove_eye {
 
 class CalibrationPattern {
  public:
+  virtual ~CalibrationPattern() {
+  }
+
+  /** Find all points of the pattern (in order of ObjectPoints()) */
   virtual bool Match(const cv::Mat &image, Point2Vector *points) const = 0;
 
+  /** Find identified points of partially visible pattern
+   *
+   * Patterns that cannot identify single points match whole pattern only.
+   *
+   * @param[out]  ids  indices of found points into ObjectPoints()
+   * @return      true when any point was found
+   */
+  virtual bool MatchPartial(const cv::Mat &image, Point2Vector *points,
+                            PointIdVector *ids) const;
+
   virtual const Point3Vector & ObjectPoints() const = 0;
+
+  /** Object points of given ids */
+  Point3Vector SelectObjectPoints(const PointIdVector &ids) const;
 };
 
 } // namespace dove_eye
 
 #endif // DOVE_EYE_CALIBRATION_PATTERN_H_
-
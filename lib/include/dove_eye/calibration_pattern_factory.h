@@ -0,0 +1,18 @@
+#ifndef DOVE_EYE_CALIBRATION_PATTERN_FACTORY_H_
+#define DOVE_EYE_CALIBRATION_PATTERN_FACTORY_H_
+
+#include "dove_eye/calibration_pattern.h"
+#include "dove_eye/parameters.h"
+
+namespace dove_eye {
+
+/** Create calibration pattern selected by Parameters::CALIBRATION_PATTERN
+ *
+ * @note ChArUco board falls back to chessboard when it's not compiled in.
+ * @return  new pattern (caller owns it)
+ */
+CalibrationPattern *CreateCalibrationPattern(const Parameters &parameters);
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_CALIBRATION_PATTERN_FACTORY_H_
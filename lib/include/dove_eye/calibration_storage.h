@@ -0,0 +1,36 @@
+#ifndef DOVE_EYE_CALIBRATION_STORAGE_H_
+#define DOVE_EYE_CALIBRATION_STORAGE_H_
+
+#include <string>
+
+#include "dove_eye/calibration_data.h"
+
+namespace dove_eye {
+
+/** Serialization of calibration data (OpenCV FileStorage format)
+ *
+ * Unlike io::CalibrationDataStorage it doesn't depend on Qt, so that it can
+ * be used by command line tools.
+ */
+class CalibrationStorage {
+ public:
+  static bool LoadFromFile(const std::string &filename,
+                           CalibrationData *result);
+
+  static bool SaveToFile(const std::string &filename,
+                         const CalibrationData &data);
+
+ private:
+  static const char *kNameArity;
+  static const char *kNameCameraMatrix;
+  static const char *kNameDistortionCoefficients;
+  static const char *kNameFundamentalMatrix;
+  static const char *kNamePairRotation;
+  static const char *kNamePosition;
+  static const char *kNameRotation;
+  static const char *kNameTranslation;
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_CALIBRATION_STORAGE_H_
@@ -7,6 +7,7 @@
 
 #include <opencv2/opencv.hpp>
 
+#include "dove_eye/bundle_adjustment.h"
 #include "dove_eye/calibration_data.h"
 #include "dove_eye/calibration_pattern.h"
 #include "dove_eye/camera_pair.h"
@@ -69,10 +70,17 @@ class CameraCalibration {
   std::unique_ptr<const CalibrationPattern> pattern_;
 
   typedef std::vector<Point2Vector> ImagePoints;
+  typedef std::vector<Point3Vector> ObjectPoints;
   /** Image points per camera */
   std::vector<ImagePoints> image_points_;
-  /** Image points per camera pair */
+  /** Object points (of each view) per camera */
+  std::vector<ObjectPoints> object_points_;
+  /** Image points per camera pair (only points seen by both cameras) */
   std::vector<std::pair<ImagePoints, ImagePoints>> image_points_pair_;
+  /** Object points (of each view) per camera pair */
+  std::vector<ObjectPoints> object_points_pair_;
+  /** All pattern views from pair calibration, for bundle adjustment */
+  std::vector<BundleAdjustment::View> views_;
 
   std::vector<MeasurementState> camera_states_;
   std::vector<MeasurementState> pair_states_;
@@ -80,6 +88,9 @@ class CameraCalibration {
   CalibrationData data_;
 
   CameraPair::PairArray pairs_;
+
+  /** Refine pair parameters jointly (see Parameters::CALIBRATION_BUNDLE) */
+  void AdjustBundle();
 };
 
 } // namespace dove_eye
@@ -0,0 +1,97 @@
+#ifndef DOVE_EYE_CAMERA_PROFILE_H_
+#define DOVE_EYE_CAMERA_PROFILE_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace dove_eye {
+
+/** Capture mode of a camera with its measured performance */
+struct CameraMode {
+  int width;
+  int height;
+  /** As reported by CV_CAP_PROP_FOURCC (0 means backend default) */
+  uint32_t fourcc;
+  /** Nominal frame rate (0 when backend doesn't report it) */
+  double fps;
+
+  /** Sustained frame rate */
+  double measured_fps;
+  /** Mean time of retrieve() (decoding and conversion) [s] */
+  double latency;
+  /** Standard deviation of frame interval [s] */
+  double jitter;
+  /** Process CPU time per frame [s] */
+  double cpu;
+
+  CameraMode(const int width = 0, const int height = 0,
+             const uint32_t fourcc = 0, const double fps = 0)
+      : width(width),
+        height(height),
+        fourcc(fourcc),
+        fps(fps),
+        measured_fps(0),
+        latency(0),
+        jitter(0),
+        cpu(0) {
+  }
+
+  /** Camera keeps (nearly) nominal frame rate */
+  bool Sustained() const;
+
+  static std::string FourccToString(const uint32_t fourcc);
+
+  static uint32_t StringToFourcc(const std::string &value);
+};
+
+/** Measured capture modes of camera devices
+ *
+ * Created by dove-eye-camprofile, CameraVideoProvider uses it to pick the
+ * best mode for desired resolution.
+ * Serialized in OpenCV FileStorage format.
+ */
+class CameraProfile {
+ public:
+  typedef std::vector<CameraMode> ModesVector;
+
+  inline const ModesVector &modes(const int device) const {
+    static const ModesVector empty;
+    auto it = devices_.find(device);
+    return (it == devices_.end()) ? empty : it->second;
+  }
+
+  inline void AddMode(const int device, const CameraMode &mode) {
+    devices_[device].push_back(mode);
+  }
+
+  /** Best sustained mode of given resolution
+   *
+   * Highest frame rate wins, then lower latency and CPU cost.
+   *
+   * @param[in]  fourcc  restrict pixel format (0 means any)
+   * @return     false when the profile has no sustained mode of the resolution
+   */
+  bool BestMode(const int device, const int width, const int height,
+                CameraMode *result, const uint32_t fourcc = 0) const;
+
+  static bool LoadFromFile(const std::string &filename,
+                           CameraProfile *result);
+
+  static bool SaveToFile(const std::string &filename,
+                         const CameraProfile &profile);
+
+ private:
+  typedef std::map<int, ModesVector> DevicesMap;
+
+  static const char *kNameDevices;
+  static const char *kNameDevice;
+  static const char *kNameModes;
+
+  DevicesMap devices_;
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_CAMERA_PROFILE_H_
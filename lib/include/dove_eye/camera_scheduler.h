@@ -0,0 +1,92 @@
+#ifndef DOVE_EYE_CAMERA_SCHEDULER_H_
+#define DOVE_EYE_CAMERA_SCHEDULER_H_
+
+#include <cassert>
+#include <vector>
+
+#include "dove_eye/parameters.h"
+#include "dove_eye/types.h"
+
+namespace dove_eye {
+
+/** Decides which cameras are tracked in a frameset under CPU budget
+ *
+ * Each camera has a priority given by its value for localization geometry,
+ * urgency (low tracking confidence needs attention) and the number of
+ * framesets it has been skipped. Cameras are picked by priority until the
+ * estimated cost exceeds the per-frameset budget.
+ *
+ * @note Zero budget means all cameras are always tracked.
+ */
+class CameraScheduler {
+ public:
+  typedef std::vector<bool> Selection;
+
+  CameraScheduler(const CameraIndex arity, const Parameters &parameters);
+
+  inline CameraIndex Arity() const {
+    return arity_;
+  }
+
+  /** Relative contribution of camera to localization (default 1) */
+  inline void camera_value(const CameraIndex cam, const double value) {
+    assert(cam < arity_);
+    cameras_[cam].value = value;
+  }
+
+  inline double camera_value(const CameraIndex cam) const {
+    assert(cam < arity_);
+    return cameras_[cam].value;
+  }
+
+  /** Select cameras to track in the next frameset
+   *
+   * Unselected cameras are accounted as skipped.
+   */
+  const Selection &Schedule();
+
+  /** Account result of tracking a selected camera
+   *
+   * @param[in]  cost  time spent tracking (in seconds)
+   */
+  void Report(const CameraIndex cam, const bool success, const double cost);
+
+  /** Estimated cost of tracking the camera (in seconds) */
+  inline double Cost(const CameraIndex cam) const {
+    assert(cam < arity_);
+    return cameras_[cam].cost;
+  }
+
+ private:
+  struct CameraState {
+    double value;
+    /** Exponential moving average of tracking time */
+    double cost;
+    size_t success_streak;
+    size_t skipped;
+
+    CameraState()
+        : value(1),
+          cost(0),
+          success_streak(0),
+          skipped(0) {
+    }
+  };
+
+  typedef std::vector<CameraState> StateVector;
+
+  const CameraIndex arity_;
+  const Parameters &parameters_;
+
+  StateVector cameras_;
+  Selection selection_;
+
+  /** Preallocated buffer for ordering cameras */
+  std::vector<CameraIndex> order_;
+
+  double Priority(const CameraIndex cam) const;
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_CAMERA_SCHEDULER_H_
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include "dove_eye/camera_profile.h"
+#include "dove_eye/mjpeg_decoder.h"
 #include "dove_eye/video_provider.h"
 
 namespace dove_eye {
@@ -30,6 +32,7 @@ class CameraVideoProvider : public VideoProvider {
 
   FrameIterator end() override;
 
+  /** Resolutions of sustained modes from profile (or common guesses) */
   ResolutionVector AvailableResolutions() const;
 
   inline Resolution resolution() const {
@@ -48,12 +51,46 @@ class CameraVideoProvider : public VideoProvider {
     resolution_ = Resolution(width, height);
   }
 
+  inline const CameraProfile *profile() const {
+    return profile_;
+  }
+
+  /** Use measured modes to pick pixel format and frame rate
+   *
+   * @note Profile must outlive the provider.
+   */
+  inline void profile(const CameraProfile *value) {
+    profile_ = value;
+  }
+
+  inline bool mjpeg() const {
+    return mjpeg_;
+  }
+
+  /** Capture compressed frames and decode them on the shared worker pool
+   *
+   * Saves USB bandwidth at high resolutions. Falls back to OpenCV capture
+   * when the device can't do it (or without CONFIG_MJPEG).
+   *
+   * @note Grayscale decoding suits only trackers that don't need colors.
+   */
+  inline void mjpeg(const bool value,
+                    const MjpegDecoder::Options &options =
+                        MjpegDecoder::Options()) {
+    mjpeg_ = value;
+    mjpeg_options_ = options;
+  }
+
  private:
   const int device_;
   std::string id_;
   /** 0x0 means default (unmodified) size */
   Resolution resolution_;
+  const CameraProfile *profile_;
+  bool mjpeg_;
+  MjpegDecoder::Options mjpeg_options_;
 
+  void ApplyProfile(cv::VideoCapture *capture) const;
 };
 
 } // namespace dove_eye
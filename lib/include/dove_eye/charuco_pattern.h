@@ -0,0 +1,44 @@
+#ifndef DOVE_EYE_CHARUCO_PATTERN_H_
+#define DOVE_EYE_CHARUCO_PATTERN_H_
+
+#include <opencv2/aruco/charuco.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "dove_eye/calibration_pattern.h"
+
+namespace dove_eye {
+
+/** ChArUco board (chessboard with ArUco markers in its white squares)
+ *
+ * Each inner corner is identified by adjacent markers, so partially visible
+ * board still yields usable points.
+ *
+ * @note Needs aruco module from opencv_contrib (CONFIG_CHARUCO).
+ */
+class CharucoPattern : public CalibrationPattern {
+ public:
+  /**
+   * @param[in]  rows, columns  inner corners (same as ChessboardPattern)
+   * @param[in]  marker_size    side of marker (smaller than square)
+   */
+  CharucoPattern(const int rows, const int columns, const double square_size,
+                 const double marker_size);
+
+  bool Match(const cv::Mat &image, Point2Vector *points) const override;
+
+  bool MatchPartial(const cv::Mat &image, Point2Vector *points,
+                    PointIdVector *ids) const override;
+
+  const Point3Vector & ObjectPoints() const override {
+    return object_points_;
+  }
+
+ private:
+  cv::Ptr<cv::aruco::Dictionary> dictionary_;
+  cv::Ptr<cv::aruco::CharucoBoard> board_;
+  Point3Vector object_points_;
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_CHARUCO_PATTERN_H_
@@ -9,7 +9,7 @@
 
 namespace dove_eye {
 
-class CircleTracker : public SearchingTracker {
+class CircleTracker final : public SearchingTracker<CircleTracker> {
  public:
   struct CircleData : public TrackerData {
     const int histogram_size = 32;
@@ -28,62 +28,79 @@ class CircleTracker : public SearchingTracker {
     }
   };
 
+  typedef CircleData Data;
+
   explicit CircleTracker(const Parameters &parameters)
       : SearchingTracker(parameters) {
   }
 
-  inline const TrackerData &tracker_data() const override {
-    return data_;
-  }
- 
-  inline TrackerData &tracker_data() override {
-    return data_;
-  }
-
-  InnerTracker *Clone() const override {
+  CircleTracker *Clone() const override {
     assert(!initialized());
 
     return new CircleTracker(*this);
   }
 
+  CircleTracker *CloneState() const override {
+    auto result = new CircleTracker(*this);
+    result->DetachState();
+    result->data_.histogram = data_.histogram.clone();
+    return result;
+  }
+
   inline InnerTracker::Mark::Type PreferredMarkType() const {
     return InnerTracker::Mark::kCircle;
   }
 
- protected:
-  bool InitTrackerData(const cv::Mat &data, const Mark &mark) override;
+ private:
+  friend class SearchingTracker<CircleTracker>;
+
+  CircleData data_;
+
+  inline CircleData &data() {
+    return data_;
+  }
+
+  inline const CircleData &data() const {
+    return data_;
+  }
+
+  bool InitTrackerData(const cv::Mat &data, const Mark &mark);
+
+  void SaveTrackerData(ModelWriter *writer) const;
+
+  bool LoadTrackerData(ModelReader *reader);
 
   bool Search(
       const cv::Mat &data,
-      TrackerData &tracker_data,
+      CircleData &circle_data,
       const cv::Rect *roi,
       const cv::Mat *mask,
       const double threshold,
-      Mark *result) const override;
+      Mark *result) const;
 
-  inline Posit MarkToPosit(const Mark &mark) const override {
+  inline Posit MarkToPosit(const Mark &mark) const {
     assert(mark.type == Mark::kCircle);
     return mark.center;
   }
 
-  inline cv::Rect DataToRoi(const TrackerData &tracker_data, const Point2 exp,
-                            const double search_factor) const override {
+  inline cv::Rect DataToRoi(const CircleData &data, const Point2 exp,
+                            const double search_factor) const {
     const auto f = search_factor;
-    const auto &data = static_cast<const CircleData &>(tracker_data);
 
     cv::Size new_size(2 * data.radius * f, 2 * data.radius * f);
     return cv::Rect(exp - 0.5 * Point2(new_size), new_size);
   }
 
- private:
   typedef cv::Vec3f Circle;
   typedef std::vector<Circle> CircleVector;
 
-  CircleData data_;
-  
   bool UpdateData(CircleData &circle_data, const cv::Mat &data,
                   const Mark &mark) const;
 
+  /** Circles of radius band from fast radial symmetry transform */
+  void RadialSymmetryCircles(const cv::Mat &data, const double radius,
+                             CircleVector *circles) const;
+
   cv::Mat PreprocessImage(const cv::Mat &data,
                           const CircleData &circle_data,
                           const double threshold) const;
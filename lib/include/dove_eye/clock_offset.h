@@ -0,0 +1,64 @@
+#ifndef DOVE_EYE_CLOCK_OFFSET_H_
+#define DOVE_EYE_CLOCK_OFFSET_H_
+
+#include <cstddef>
+#include <deque>
+
+#include "dove_eye/frame.h"
+
+namespace dove_eye {
+
+/** NTP-like estimation of offset between local and remote clock
+ *
+ * Each sample is a round trip: request sent at local t0, received at remote t1,
+ * answered at remote t2 and the answer received at local t3. Of the recent
+ * samples the one with the shortest round trip is trusted, as its delays are
+ * least asymmetric.
+ */
+class ClockOffset {
+ public:
+  static const size_t kDefaultWindow = 16;
+
+  explicit ClockOffset(const size_t window = kDefaultWindow)
+      : window_(window),
+        offset_(0),
+        delay_(0) {
+  }
+
+  void AddSample(const Frame::Timestamp t0, const Frame::Timestamp t1,
+                 const Frame::Timestamp t2, const Frame::Timestamp t3);
+
+  inline bool valid() const {
+    return !samples_.empty();
+  }
+
+  /** Remote time minus local time */
+  inline Frame::TimestampDiff offset() const {
+    return offset_;
+  }
+
+  /** Round trip delay of the trusted sample */
+  inline Frame::TimestampDiff delay() const {
+    return delay_;
+  }
+
+  inline Frame::Timestamp ToLocal(const Frame::Timestamp remote_time) const {
+    return remote_time - offset_;
+  }
+
+ private:
+  struct Sample {
+    Frame::TimestampDiff offset;
+    Frame::TimestampDiff delay;
+  };
+
+  const size_t window_;
+  std::deque<Sample> samples_;
+
+  Frame::TimestampDiff offset_;
+  Frame::TimestampDiff delay_;
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_CLOCK_OFFSET_H_
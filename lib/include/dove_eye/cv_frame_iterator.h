@@ -41,8 +41,9 @@ class CvFrameIterator : public FrameIteratorImpl {
 
   inline void MoveNext() override {
     valid_ = video_capture_->grab();
+    /* Stamp before decoding */
+    frame_.timestamp = timestamp_policy_.GetTimestamp(video_capture_.get());
     valid_ = valid_ && video_capture_->retrieve(frame_.data);
-    frame_.timestamp = timestamp_policy_.GetTimestamp();
     blocking_policy_.Wait();
   }
 
@@ -50,6 +51,16 @@ class CvFrameIterator : public FrameIteratorImpl {
     return valid_;
   }
 
+  /** Skip to given time, must be called before first MoveNext
+   *
+   * @note Only for timestamp policies that support seeking.
+   */
+  inline void Seek(const Frame::Timestamp time) {
+    if (valid_) {
+      timestamp_policy_.Seek(video_capture_.get(), time);
+    }
+  }
+
   inline cv::VideoCapture &CvVideoCapture() {
     return *video_capture_;
   }
@@ -23,6 +23,12 @@ class CvKalmanFilter {
 
   Point2 PredictChange(const double time);
 
+  /** Advance the filter by one step without observation
+   *
+   * @return  predicted position
+   */
+  Point2 Extrapolate(const double time);
+
   Point2 Update(const double time, const Point2 observation);
 
   Point2 Reset(const double time = 0, const Point2 observation = Point2());
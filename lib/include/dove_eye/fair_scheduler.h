@@ -0,0 +1,100 @@
+#ifndef DOVE_EYE_FAIR_SCHEDULER_H_
+#define DOVE_EYE_FAIR_SCHEDULER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace dove_eye {
+
+/** Weighted fair sharing of CPU slots between pipelines
+ *
+ * Pipelines (clients) hold a slot for each unit of CPU bound work (e.g.
+ * processing of a frameset), waiting for input is done without it. When
+ * more clients wait than there are free slots, the one with the least
+ * virtual time (consumed time divided by weight) goes first. A client that
+ * was idle starts (almost) from the current virtual time, i.e. it cannot bank
+ * credit.
+ *
+ * Consumed and waiting time of each client is accounted in Metrics as
+ * scheduler.<name>.busy and scheduler.<name>.wait (in seconds).
+ */
+class FairScheduler {
+ public:
+  typedef size_t ClientId;
+
+  /** Slot held during lifetime of the object (no-op with null scheduler) */
+  class Slot {
+   public:
+    Slot(FairScheduler *scheduler, const ClientId client)
+        : scheduler_(scheduler),
+          client_(client) {
+      if (scheduler_) {
+        scheduler_->Acquire(client_);
+      }
+    }
+
+    ~Slot() {
+      if (scheduler_) {
+        scheduler_->Release(client_);
+      }
+    }
+
+    Slot(const Slot &) = delete;
+    Slot &operator=(const Slot &) = delete;
+
+   private:
+    FairScheduler *scheduler_;
+    const ClientId client_;
+  };
+
+  /** @param[in]  slots  0 means number of hardware threads */
+  explicit FairScheduler(const size_t slots = 0);
+
+  FairScheduler(const FairScheduler &) = delete;
+  FairScheduler &operator=(const FairScheduler &) = delete;
+
+  ClientId AddClient(const std::string &name, const double weight = 1);
+
+  /** Block until the client gets a slot */
+  void Acquire(const ClientId client);
+
+  void Release(const ClientId client);
+
+  inline size_t slots() const {
+    return slots_;
+  }
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+  typedef std::unique_lock<std::mutex> Lock;
+
+  struct Client {
+    std::string name;
+    double weight;
+    double virtual_time;
+    bool waiting;
+    Clock::time_point requested;
+    Clock::time_point started;
+  };
+
+  /** Stable references to clients (they're added concurrently) */
+  typedef std::deque<Client> ClientsContainer;
+
+  const size_t slots_;
+
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  size_t free_slots_;
+  double virtual_time_;
+  ClientsContainer clients_;
+
+  bool IsNext(const ClientId client) const;
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_FAIR_SCHEDULER_H_
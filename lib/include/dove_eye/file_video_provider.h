@@ -15,12 +15,27 @@ class FileVideoProvider : public VideoProvider {
     return filename_;
   }
 
+  inline Frame::Timestamp start_time() const {
+    return start_time_;
+  }
+
+  /** Iterators will start at given time of the video */
+  inline void start_time(const Frame::Timestamp value) {
+    start_time_ = value;
+  }
+
   FrameIterator begin() override;
 
   FrameIterator end() override;
 
+  inline bool Seek(const Frame::Timestamp time) override {
+    start_time(time);
+    return true;
+  }
+
  private:
   const std::string filename_;
+  Frame::Timestamp start_time_;
 
 };
 
@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <chrono>
+#include <thread>
 
 #include <opencv2/opencv.hpp>
 
@@ -11,24 +12,33 @@
 namespace dove_eye {
 namespace frame_iterator {
 
+/** Deliver frames at capture's FPS
+ *
+ * Frames are due at absolute times (multiples of frame period from the
+ * start), so time spent decoding doesn't make the playback drift.
+ */
 class BlockingPolicy {
  public:
   inline void Initialize(cv::VideoCapture *capture) {
     assert(capture->get(CV_CAP_PROP_FPS) > 0);
-    frame_period_ = 1000000 / capture->get(CV_CAP_PROP_FPS);
+    frame_period_ = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1 / capture->get(CV_CAP_PROP_FPS)));
+    deadline_ = Clock::now();
   }
 
   inline void Wait() {
-      std::this_thread::sleep_for(
-        std::chrono::microseconds(frame_period_));
+    deadline_ += frame_period_;
+    std::this_thread::sleep_until(deadline_);
   }
 
  private:
-  size_t frame_period_;
+  typedef std::chrono::steady_clock Clock;
+
+  Clock::duration frame_period_;
+  Clock::time_point deadline_;
 };
 
 } // namespace frame_iterator
 } // namespace dove_eye
 
 #endif // DOVE_EYE_FRAME_ITERATOR_BLOCKING_POLICY_H_
-
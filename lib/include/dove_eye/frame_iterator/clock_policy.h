@@ -2,38 +2,114 @@
 #define DOVE_EYE_FRAME_ITERATOR_CLOCK_POLICY_H_
 
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 
-/* Forward declaration */
-namespace cv {
-class VideoCapture;
-}
+#include <opencv2/opencv.hpp>
 
 
 namespace dove_eye {
 namespace frame_iterator {
 
+/** Timestamps frames with wall time
+ *
+ * All cameras share the process-wide epoch, so that their timestamps are
+ * comparable (and comparable with Now()).
+ *
+ * Clock is kept in integer nanoseconds, conversion to (double) seconds
+ * happens only at the output. Frame is stamped when it is grabbed, i.e.
+ * decoding time is not included. When the backend reports capture time of
+ * the buffer in the same monotonic clock (V4L2 does), it is used instead.
+ */
 class ClockPolicy {
  public:
+  typedef int64_t Nanoseconds;
+
   inline void Initialize(cv::VideoCapture *capture) {
-    start_ = Clock::now();
+    (void)Epoch();
+    buffer_timestamps_ = kUnknown;
+  }
+
+  /** Called right after grab(), before retrieve() */
+  inline double GetTimestamp(cv::VideoCapture *capture) {
+    const auto grab_time = NowNanoseconds();
+    if (buffer_timestamps_ == kUnavailable) {
+      return ToSeconds(grab_time);
+    }
+
+    Nanoseconds buffer_time;
+    const bool plausible = BufferTime(capture, grab_time, &buffer_time);
+    if (buffer_timestamps_ == kUnknown) {
+      /* Decide once, mixing sources would add jitter */
+      buffer_timestamps_ = plausible ? kAvailable : kUnavailable;
+    }
+
+    /* Clamp buffers queued before the epoch was set */
+    return ToSeconds(plausible ? std::max<Nanoseconds>(0, buffer_time)
+                               : grab_time);
+  }
+
+  /** Seconds since the process-wide epoch */
+  static inline double Now() {
+    return ToSeconds(NowNanoseconds());
+  }
+
+  /** Nanoseconds since the process-wide epoch */
+  static inline Nanoseconds NowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - Epoch()).count();
+  }
+
+  static inline double ToSeconds(const Nanoseconds value) {
+    return value * 1e-9;
   }
 
-  inline double GetTimestamp() {
-    auto now = Clock::now();
-    std::chrono::duration<double> duration(now - start_);
-    return duration.count();
+  /** Convert steady clock time (CLOCK_MONOTONIC on Linux) to the epoch */
+  static inline Nanoseconds FromSteady(const Nanoseconds value) {
+    return value - std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Epoch().time_since_epoch()).count();
   }
 
  private:
   typedef std::chrono::steady_clock Clock;
   typedef decltype(Clock::now()) TimePoint;
 
-  TimePoint start_;
+  enum BufferTimestamps {
+    kUnknown,
+    kAvailable,
+    kUnavailable
+  };
+
+  /** Buffer older than this is taken as a different clock */
+  static const Nanoseconds kMaxBufferAge = 1000000000;
+
+  BufferTimestamps buffer_timestamps_;
+
+  static inline TimePoint Epoch() {
+    static const TimePoint epoch = Clock::now();
+    return epoch;
+  }
+
+  /** Backend's buffer timestamp converted to our epoch
+   *
+   * @return  whether it's plausible (i.e. the same clock)
+   */
+  static inline bool BufferTime(cv::VideoCapture *capture,
+                                const Nanoseconds grab_time,
+                                Nanoseconds *result) {
+    const double msec = capture->get(CV_CAP_PROP_POS_MSEC);
+    if (!(msec > 0)) {
+      return false;
+    }
+
+    *result = FromSteady(static_cast<Nanoseconds>(msec * 1e6));
+
+    return *result <= grab_time && *result > grab_time - kMaxBufferAge;
+  }
 };
 
 } // namespace frame_iterator
 } // namespace dove_eye
 
 #endif // DOVE_EYE_FRAME_ITERATOR_CLOCK_POLICY_H_
-
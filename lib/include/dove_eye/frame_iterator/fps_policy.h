@@ -1,6 +1,8 @@
 #ifndef DOVE_EYE_FRAME_ITERATOR_FPS_POLICY_H_
 #define DOVE_EYE_FRAME_ITERATOR_FPS_POLICY_H_
 
+#include <algorithm>
+#include <cmath>
 
 #include <opencv2/opencv.hpp>
 
@@ -16,10 +18,18 @@ class FpsPolicy {
     frame_no_ = 0;
   }
 
-  inline double GetTimestamp() {
+  inline double GetTimestamp(cv::VideoCapture *capture) {
     return (++frame_no_) * frame_period_;
   }
 
+  /** Move to the frame closest to time (timestamps stay absolute) */
+  inline void Seek(cv::VideoCapture *capture, const double time) {
+    const auto frame_no = static_cast<size_t>(
+        std::max(0.0, std::floor(time / frame_period_)));
+    capture->set(CV_CAP_PROP_POS_FRAMES, frame_no);
+    frame_no_ = frame_no;
+  }
+
  private:
   double frame_period_;
   size_t frame_no_;
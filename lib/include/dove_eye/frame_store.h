@@ -0,0 +1,71 @@
+#ifndef DOVE_EYE_FRAME_STORE_H_
+#define DOVE_EYE_FRAME_STORE_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "dove_eye/aggregator.h"
+#include "dove_eye/frameset.h"
+#include "dove_eye/types.h"
+
+namespace dove_eye {
+
+/** Decoded recording kept in memory
+ *
+ * Framesets are decoded only once and then they can be replayed by any
+ * number of consumers, also concurrently (stored data are never modified).
+ */
+class FrameStore {
+ public:
+  typedef std::vector<Frameset> FramesetsContainer;
+  typedef FramesetsContainer::const_iterator const_iterator;
+
+  explicit FrameStore(const CameraIndex arity)
+      : arity_(arity),
+        bytes_(0) {
+  }
+
+  /** Decode framesets from the aggregator
+   *
+   * @param[in]  max_framesets  limit of stored framesets (0 means no limit)
+   * @return     number of stored framesets
+   */
+  size_t Load(Aggregator *aggregator, const size_t max_framesets = 0);
+
+  /** Append frameset that owns its data (e.g. synthetic one) */
+  void Add(Frameset &&frameset);
+
+  inline CameraIndex Arity() const {
+    return arity_;
+  }
+
+  inline size_t size() const {
+    return framesets_.size();
+  }
+
+  /** Memory occupied by image data */
+  inline size_t bytes() const {
+    return bytes_;
+  }
+
+  inline const Frameset &operator[](const size_t index) const {
+    return framesets_[index];
+  }
+
+  inline const_iterator begin() const {
+    return framesets_.begin();
+  }
+
+  inline const_iterator end() const {
+    return framesets_.end();
+  }
+
+ private:
+  const CameraIndex arity_;
+  FramesetsContainer framesets_;
+  size_t bytes_;
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_FRAME_STORE_H_
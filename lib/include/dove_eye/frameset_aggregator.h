@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <deque>
+#include <string>
 #include <vector>
 
 #include "dove_eye/aggregator.h"
@@ -26,7 +27,7 @@ class FramesetAggregator : public Aggregator {
   FramesetAggregator(const ProvidersContainer &providers,
                      const dove_eye::Parameters &parameters)
       : Aggregator(providers, parameters),
-        frame_policy_(providers) {
+        frame_policy_(providers, parameters) {
 
   }
 
@@ -38,6 +39,18 @@ class FramesetAggregator : public Aggregator {
     frame_policy_.Start();
   }
 
+  virtual bool Restart() override {
+    return frame_policy_.Restart();
+  }
+
+  virtual void RestartSchedule() override {
+    frame_policy_.Reschedule();
+  }
+
+  virtual void SetMetricsPrefix(const std::string &value) override {
+    frame_policy_.metrics_prefix(value);
+  }
+
   virtual bool GetFrame(Frame *frame, CameraIndex *cam) override {
     return frame_policy_.GetFrame(frame, cam);
   }
@@ -9,7 +9,7 @@
 
 namespace dove_eye {
 
-class HistogramTracker : public SearchingTracker {
+class HistogramTracker final : public SearchingTracker<HistogramTracker> {
  public:
   struct HistogramData : public TrackerData {
     const int histogram_size = 16;
@@ -29,59 +29,72 @@ class HistogramTracker : public SearchingTracker {
     }
   };
 
+  typedef HistogramData Data;
+
   explicit HistogramTracker(const Parameters &parameters)
       : SearchingTracker(parameters) {
   }
-
-  inline const TrackerData &tracker_data() const override {
-    return data_;
-  }
- 
-  inline TrackerData &tracker_data() override {
-    return data_;
-  }
  
-  InnerTracker *Clone() const override {
+  HistogramTracker *Clone() const override {
     assert(!initialized());
 
     return new HistogramTracker(*this);
   }
 
+  HistogramTracker *CloneState() const override {
+    auto result = new HistogramTracker(*this);
+    result->DetachState();
+    result->data_.histogram = data_.histogram.clone();
+    return result;
+  }
+
   inline InnerTracker::Mark::Type PreferredMarkType() const {
     return InnerTracker::Mark::kRectangle;
   }
 
- protected:
-  bool InitTrackerData(const cv::Mat &data, const Mark &mark) override;
+ private:
+  friend class SearchingTracker<HistogramTracker>;
+
+  HistogramData data_;
+
+  inline HistogramData &data() {
+    return data_;
+  }
+
+  inline const HistogramData &data() const {
+    return data_;
+  }
+
+  bool InitTrackerData(const cv::Mat &data, const Mark &mark);
+
+  void SaveTrackerData(ModelWriter *writer) const;
+
+  bool LoadTrackerData(ModelReader *reader);
 
   bool Search(
       const cv::Mat &data,
-      TrackerData &tracker_data,
+      HistogramData &hist_data,
       const cv::Rect *roi,
       const cv::Mat *mask,
       const double threshold,
-      Mark *result) const override;
+      Mark *result) const;
 
-  inline Posit MarkToPosit(const Mark &mark) const override {
+  inline Posit MarkToPosit(const Mark &mark) const {
     assert(mark.type == Mark::kRectangle);
     return mark.top_left + 0.5 * mark.size;
   }
 
-  inline cv::Rect DataToRoi(const TrackerData &tracker_data, const Point2 exp,
-                            const double search_factor) const override {
+  inline cv::Rect DataToRoi(const HistogramData &data, const Point2 exp,
+                            const double search_factor) const {
     const auto f = search_factor;
-    const auto &data = static_cast<const HistogramData &>(tracker_data);
 
     cv::Size new_size(data.size.width * f, data.size.height * f);
     return cv::Rect(exp - 0.5 * Point2(new_size), new_size);
   }
 
- private:
   typedef std::vector<cv::Point> Contour;
   typedef std::vector<Contour> ContourVector;
 
-  HistogramData data_;
-  
   cv::Mat PreprocessImage(const cv::Mat &data,
                           const HistogramData &hist_data,
                           cv::Mat *mask) const;
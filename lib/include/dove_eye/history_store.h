@@ -0,0 +1,274 @@
+#ifndef DOVE_EYE_HISTORY_STORE_H_
+#define DOVE_EYE_HISTORY_STORE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "dove_eye/frame.h"
+#include "dove_eye/location.h"
+#include "dove_eye/positset.h"
+#include "dove_eye/types.h"
+
+namespace dove_eye {
+
+/*
+ * History file layout (version 1), values in host byte order
+ *
+ *   HistoryFileHeader
+ *   chunk*
+ *
+ * Chunk is HistoryChunkHeader followed by columns of its rows (each column
+ * padded to 8 bytes):
+ *
+ *   double   time[count]           wall clock (seconds since Unix epoch)
+ *   double   stream_time[count]    timestamp of frameset
+ *   uint64_t sequence_no[count]
+ *   uint32_t posit_valid[count]    bit per camera
+ *   uint8_t  states[arity][count]  Tracker::TrackState
+ *   uint8_t  location_valid[count]
+ *   double   posits[arity][2][count]
+ *   double   location[3][count]
+ *
+ * Time is non-decreasing over the file, thus chunk headers form sparse
+ * index. Chunk header also summarizes locations of the chunk so that long
+ * ranges can be summarized without reading rows. Incomplete chunk at the end
+ * (crashed writer) is ignored.
+ */
+const uint32_t kHistoryMagic = 0x53484544; /* "DEHS" */
+const uint32_t kHistoryVersion = 1;
+const uint32_t kHistoryChunkMagic = 0x43484544; /* "DEHC" */
+
+struct HistoryFileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t arity;
+  uint32_t reserved;
+};
+
+struct HistoryChunkHeader {
+  uint32_t magic;
+  uint32_t count;
+  /** Including header */
+  uint64_t size;
+  double first_time;
+  double last_time;
+
+  uint64_t location_count;
+  double location_sum[3];
+  double location_min[3];
+  double location_max[3];
+};
+
+/** Tracker output of single frameset */
+struct HistoryRecord {
+  typedef std::vector<uint8_t> StatesVector;
+
+  /** Wall clock (seconds since Unix epoch) */
+  double time;
+  Frame::Timestamp stream_time;
+
+  /** Carries sequence number of frameset */
+  Positset positset;
+  StatesVector states;
+
+  bool location_valid;
+  Location location;
+
+  explicit HistoryRecord(const CameraIndex arity = 0)
+      : time(0),
+        stream_time(0),
+        positset(arity),
+        states(arity, 0),
+        location_valid(false) {
+  }
+};
+
+/** Aggregated locations of a time interval */
+struct HistorySummary {
+  double start;
+  double end;
+
+  size_t records;
+  size_t locations;
+  Location mean;
+  Location min;
+  Location max;
+
+  HistorySummary(const double start = 0, const double end = 0)
+      : start(start),
+        end(end),
+        records(0),
+        locations(0) {
+  }
+};
+
+/** Append-only writer of history file
+ *
+ * Rows are buffered and written as chunks, chunk is closed when it's full or
+ * it spans too much time. Readers see only closed chunks.
+ *
+ * @note Not available on Windows.
+ */
+class HistoryWriter {
+ public:
+  static const uint32_t kDefaultChunkRows = 4096;
+
+  HistoryWriter()
+      : arity_(0),
+        chunk_rows_(kDefaultChunkRows),
+        wall_offset_valid_(false),
+        wall_offset_(0),
+        last_time_(0) {
+  }
+
+  ~HistoryWriter() {
+    Close();
+  }
+
+  HistoryWriter(const HistoryWriter &) = delete;
+  HistoryWriter &operator=(const HistoryWriter &) = delete;
+
+  /** Open file for appending (created when it doesn't exist)
+   *
+   * Existing file must be of the same arity, its incomplete tail is cut.
+   */
+  bool Open(const std::string &filename, const CameraIndex arity,
+            const uint32_t chunk_rows = kDefaultChunkRows);
+
+  inline bool IsOpen() const {
+    return output_.is_open();
+  }
+
+  /** Append record, its wall clock is derived from stream time
+   *
+   * @note Records older than the last one are dropped (e.g. replay after
+   *       seek), history stays ordered.
+   */
+  void Append(HistoryRecord record);
+
+  /** Write buffered rows (as a possibly short chunk) */
+  bool Flush();
+
+  void Close();
+
+ private:
+  std::ofstream output_;
+  CameraIndex arity_;
+  uint32_t chunk_rows_;
+
+  /** Wall clock minus stream time, set by the first record */
+  bool wall_offset_valid_;
+  double wall_offset_;
+  double last_time_;
+
+  std::vector<HistoryRecord> rows_;
+};
+
+/** Memory mapped reader of history file
+ *
+ * File may be being written, Refresh() makes newly closed chunks visible.
+ *
+ * @note Not available on Windows.
+ */
+class HistoryReader {
+ public:
+  typedef std::vector<HistoryRecord> RecordsVector;
+  typedef std::vector<HistorySummary> SummariesVector;
+
+  HistoryReader()
+      : fd_(-1),
+        address_(nullptr),
+        size_(0),
+        arity_(0),
+        indexed_size_(0) {
+  }
+
+  ~HistoryReader() {
+    Close();
+  }
+
+  HistoryReader(const HistoryReader &) = delete;
+  HistoryReader &operator=(const HistoryReader &) = delete;
+
+  bool Open(const std::string &filename);
+
+  void Close();
+
+  /** Map grown file and index its new chunks */
+  bool Refresh();
+
+  inline bool IsOpen() const {
+    return address_ != nullptr;
+  }
+
+  inline CameraIndex Arity() const {
+    return arity_;
+  }
+
+  /** Size of complete chunks (with file header) */
+  inline size_t valid_size() const {
+    return indexed_size_;
+  }
+
+  size_t RecordCount() const;
+
+  bool Empty() const {
+    return index_.empty();
+  }
+
+  /** Wall clock of the first record */
+  double start_time() const;
+
+  /** Wall clock of the last record */
+  double end_time() const;
+
+  /** Records with time in [start, end]
+   *
+   * @param[in]  max_records  stop after this many records (0 means no limit)
+   * @return     number of records appended to result
+   */
+  size_t Query(const double start, const double end, RecordsVector *result,
+               const size_t max_records = 0) const;
+
+  /** Locations of [start, end) summarized in buckets of equal duration
+   *
+   * Chunks inside single bucket are summarized from their headers, i.e. long
+   * ranges are cheap.
+   */
+  void Summarize(const double start, const double end, const size_t buckets,
+                 SummariesVector *result) const;
+
+ private:
+  struct ChunkEntry {
+    size_t offset;
+    double first_time;
+    double last_time;
+  };
+
+  typedef std::vector<ChunkEntry> IndexVector;
+
+  int fd_;
+  void *address_;
+  size_t size_;
+
+  CameraIndex arity_;
+
+  IndexVector index_;
+  size_t indexed_size_;
+
+  bool Map(const size_t size);
+
+  const HistoryChunkHeader &Chunk(const ChunkEntry &entry) const;
+
+  /** @return  index of the first chunk that may contain time */
+  size_t FindChunk(const double time) const;
+
+  HistoryRecord ReadRow(const ChunkEntry &entry, const size_t row) const;
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_HISTORY_STORE_H_
@@ -10,6 +10,10 @@
 
 namespace dove_eye {
 
+/* Forward */
+class ModelReader;
+class ModelWriter;
+
 /** Implementation specific data of tracker (e.g. shape, template,...)
  *
  * @note TrackerData can be destroyed only directly on particular
@@ -48,6 +52,20 @@ class InnerTracker {
   /** Vector of a, b, c for image line ax + by + c = 0 */
   typedef Vector3 Epiline;
 
+  /** Expected position of object obtained from outside of the tracker
+   * (e.g. projection of predicted location)
+   */
+  struct Prior {
+    Point2 center;
+    /** Radius of uncertainty around center (in pixels) */
+    double radius;
+
+    Prior(const Point2 center = Point2(), const double radius = 0)
+        : center(center),
+          radius(radius) {
+    }
+  };
+
   explicit InnerTracker(const Parameters &parameters)
       : parameters_(parameters) {
   }
@@ -79,6 +97,20 @@ class InnerTracker {
   /** Track the given frame */
   virtual bool Track(const Frame &frame, Posit *result) = 0;
 
+  /** Track the given frame with external prior of object position */
+  virtual inline bool Track(const Frame &frame, const Prior prior,
+                            Posit *result) {
+    return Track(frame, result);
+  }
+
+  /** Estimate position without searching the frame (e.g. to save time)
+   *
+   * @return  false when tracker cannot predict
+   */
+  virtual inline bool Coast(const Frame &frame, Posit *result) {
+    return false;
+  }
+
   /** Global reinitialization */
   virtual bool ReinitializeTracking(const Frame &frame, Posit *result) = 0;
 
@@ -101,8 +133,36 @@ class InnerTracker {
    */
   virtual InnerTracker *Clone() const = 0;
 
+  /** Clone tracker including its current state (tracker data, filters)
+   *
+   * The copy doesn't share any mutable data with the original, thus it can
+   * serve as a snapshot.
+   *
+   * @return  new tracker or nullptr when tracker doesn't support snapshots
+   */
+  virtual inline InnerTracker *CloneState() const {
+    return nullptr;
+  }
+
   virtual Mark::Type PreferredMarkType() const = 0;
 
+  /** Store appearance model of initialized tracker (e.g. for warm start)
+   *
+   * @return  false when tracker cannot store its model
+   */
+  virtual inline bool SaveModel(ModelWriter *writer) const {
+    return false;
+  }
+
+  /** Initialize tracker from stored appearance model
+   *
+   * Object position is unknown, tracker must be reinitialized
+   * (ReinitializeTracking) to obtain it.
+   */
+  virtual inline bool LoadModel(ModelReader *reader) {
+    return false;
+  }
+
  protected:
   cv::Mat EpilineToMask(const cv::Size size, const int thickness,
                         const Epiline epiline) const;
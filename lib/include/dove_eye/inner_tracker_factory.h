@@ -0,0 +1,21 @@
+#ifndef DOVE_EYE_INNER_TRACKER_FACTORY_H_
+#define DOVE_EYE_INNER_TRACKER_FACTORY_H_
+
+#include <string>
+
+#include "dove_eye/inner_tracker.h"
+#include "dove_eye/parameters.h"
+
+namespace dove_eye {
+
+/** Create single camera tracker by name
+ *
+ * @param[in]  name  "circle", "histogram" or "template"
+ * @return     new tracker (caller owns it) or nullptr for unknown name
+ */
+InnerTracker *CreateInnerTracker(const std::string &name,
+                                 const Parameters &parameters);
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_INNER_TRACKER_FACTORY_H_
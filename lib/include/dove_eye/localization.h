@@ -1,9 +1,13 @@
 #ifndef DOVE_EYE_LOCALIZATION_H_
 #define DOVE_EYE_LOCALIZATION_H_
 
+#include <string>
+#include <vector>
+
 #include "dove_eye/calibration_data.h"
 #include "dove_eye/camera_pair.h"
 #include "dove_eye/location.h"
+#include "dove_eye/parameters.h"
 #include "dove_eye/positset.h"
 #include "dove_eye/types.h"
 
@@ -11,9 +15,14 @@ namespace dove_eye {
 
 class Localization {
  public:
-  explicit Localization(const CameraIndex arity)
+  Localization(const CameraIndex arity, const Parameters &parameters)
       : arity_(arity),
+        parameters_(parameters),
         pairs_(CameraPair::GenerateArray(arity_)),
+        pair_scores_(pairs_.size(), 1),
+        ranked_pairs_(pairs_),
+        projections_(arity_),
+        outliers_(arity_, false),
         calibration_data_(nullptr) {
   }
 
@@ -25,26 +34,80 @@ class Localization {
     return 2;
   }
 
-  inline void calibration_data(const CalibrationData *value) {
-    calibration_data_ = value;
-  }
+  /** Setting calibration data (re)calculates conditioning of camera pairs */
+  void calibration_data(const CalibrationData *value);
 
   inline const CalibrationData* calibration_data() const {
     return calibration_data_;
   }
 
+  /** Prefix of localization's keys in Metrics::Global() */
+  inline void metrics_prefix(const std::string &value) {
+    metrics_prefix_ = value;
+  }
+
+  /** Conditioning score of camera pair
+   *
+   * @return  value (0, 1], sine of triangulation angle in the working volume
+   */
+  inline double PairScore(const CameraIndex index) const {
+    assert(index < pair_scores_.size());
+    return pair_scores_[index];
+  }
+
+  /** Contribution of camera to localization geometry
+   *
+   * @return  sum of scores of pairs the camera is part of
+   */
+  double CameraScore(const CameraIndex cam) const;
+
+  /** Localize object from posits
+   *
+   * Posits that are inconsistent with the others are excluded from
+   * localization and marked as outliers. Predicted posits are used only
+   * when there are less than two observed ones.
+   */
   bool Locate(const Positset &positset, Location *result);
 
+  /** Was the camera's posit rejected in the last Locate() call? */
+  inline bool IsOutlier(const CameraIndex cam) const {
+    assert(cam < Arity());
+    return outliers_[cam];
+  }
+
  private:
+  typedef std::vector<cv::Matx34d> ProjectionVector;
+
   const CameraIndex arity_;
+  const Parameters &parameters_;
   const CameraPair::PairArray pairs_;
 
+  std::vector<double> pair_scores_;
+  /** Pairs ordered by decreasing score */
+  CameraPair::PairArray ranked_pairs_;
+
+  /** Cached projection matrices for fast (allocation free) triangulation */
+  ProjectionVector projections_;
+
+  std::vector<bool> outliers_;
+
   const CalibrationData *calibration_data_;
 
+  std::string metrics_prefix_;
+
   Location PairLocate(const Positset &positset, const CameraPair pair);
+
+  void CalculatePairScores();
+
+  void FindConsensus(const Positset &positset, Positset *inliers);
+
+  bool FastPairLocate(const Positset &positset, const CameraPair pair,
+                      cv::Vec3d *result) const;
+
+  bool ReprojectionError(const cv::Vec3d &point, const CameraIndex cam,
+                         const Posit &posit, double *error) const;
 };
 
 } // namespace dove_eye
 
 #endif // DOVE_EYE_LOCALIZATION_H_
-
@@ -0,0 +1,65 @@
+#ifndef DOVE_EYE_LOCATION_FILTER_H_
+#define DOVE_EYE_LOCATION_FILTER_H_
+
+#include <opencv2/opencv.hpp>
+
+#include "dove_eye/frame.h"
+#include "dove_eye/location.h"
+
+namespace dove_eye {
+
+/** Constant velocity Kalman filter over world-space locations
+ *
+ * Unlike CvKalmanFilter it takes the actual time between observations into
+ * account, since locations are not available in every frameset.
+ */
+class LocationFilter {
+ public:
+  LocationFilter()
+      : process_var_(0),
+        observation_var_(0),
+        initialized_(false),
+        time_(0) {
+  }
+
+  void Init(const double process_var, const double observation_var);
+
+  inline bool initialized() const {
+    return initialized_;
+  }
+
+  /** Time of the last observation */
+  inline Frame::Timestamp time() const {
+    return time_;
+  }
+
+  Location Predict(const Frame::Timestamp time) const;
+
+  /** Standard deviation of predicted location (in world units) */
+  double PredictDeviation(const Frame::Timestamp time) const;
+
+  Location Update(const Frame::Timestamp time, const Location observation);
+
+  Location Reset(const Frame::Timestamp time, const Location observation);
+
+ private:
+  typedef cv::Matx<double, 6, 1> StateMat;
+  typedef cv::Matx<double, 6, 6> CovarianceMat;
+
+  double process_var_;
+  double observation_var_;
+
+  bool initialized_;
+  Frame::Timestamp time_;
+
+  /** State is [x, y, z, dx, dy, dz] */
+  StateMat state_;
+  CovarianceMat covariance_;
+
+  void PredictState(const Frame::Timestamp time, StateMat *state,
+                    CovarianceMat *covariance) const;
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_LOCATION_FILTER_H_
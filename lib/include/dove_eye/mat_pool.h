@@ -0,0 +1,105 @@
+#ifndef DOVE_EYE_MAT_POOL_H_
+#define DOVE_EYE_MAT_POOL_H_
+
+#include <cassert>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "dove_eye/metrics.h"
+
+namespace dove_eye {
+
+/** Allocator of image buffers that reuses freed buffers of the same size
+ *
+ * Allocations are bucketed by size class, recently freed large buffers are
+ * kept (up to a limit) for the next allocation of the class. Each allocation
+ * is accounted to the call site (see Site) and the statistics are published
+ * via Metrics as "mat_pool.<site>.*".
+ *
+ * OpenCV 2.4 has no default allocator hook, matrices must be prepared by
+ * Use() before they're allocated. Pooling is enabled by CONFIG_MAT_POOL,
+ * otherwise Use() keeps OpenCV allocator and nothing is accounted.
+ */
+class MatPool : public cv::MatAllocator {
+ public:
+  /** Name of call site for allocations in the scope (per thread)
+   *
+   * @note Name must be a string literal (it's stored as a pointer).
+   */
+  class Site {
+   public:
+    explicit Site(const char *name);
+
+    ~Site();
+
+    /** @return  innermost site of calling thread ("other" when none) */
+    static const char *Current();
+
+   private:
+    const char *previous_;
+  };
+
+  /** @return  process-wide pool or nullptr when pooling is disabled */
+  static MatPool *Global();
+
+  /** Allocate mat from the global pool (when enabled)
+   *
+   * @note Mat must not hold data, the allocator is used when the mat is
+   *       created (e.g. as an output of OpenCV function).
+   */
+  static inline void Use(cv::Mat *mat) {
+    assert(!mat->refcount);
+    mat->allocator = Global();
+  }
+
+  /** Deep copy of mat allocated from the global pool */
+  static inline cv::Mat Clone(const cv::Mat &mat) {
+    cv::Mat result;
+    Use(&result);
+    mat.copyTo(result);
+    return result;
+  }
+
+  void allocate(int dims, const int *sizes, int type, int *&refcount,
+                uchar *&datastart, uchar *&data, size_t *step) override;
+
+  void deallocate(int *refcount, uchar *datastart, uchar *data) override;
+
+  /** Update statistics in metrics (as a Metrics::Source) */
+  void Publish(Metrics *metrics) const;
+
+ private:
+  /** Prepended to each buffer */
+  struct Header {
+    int refcount;
+    size_t capacity;
+  };
+
+  struct SiteStats {
+    double allocations = 0;
+    double reused = 0;
+    double bytes = 0;
+  };
+
+  typedef std::vector<Header *> HeaderVector;
+  /** Cached buffers by their capacity */
+  typedef std::map<size_t, HeaderVector> CacheMap;
+  /** Keyed by pointer to site name */
+  typedef std::map<const char *, SiteStats> SiteStatsMap;
+
+  mutable std::mutex mtx_;
+  CacheMap cache_;
+  SiteStatsMap site_stats_;
+  size_t cached_bytes_ = 0;
+  size_t live_bytes_ = 0;
+
+  static size_t SizeClass(const size_t size);
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_MAT_POOL_H_
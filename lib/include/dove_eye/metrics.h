@@ -0,0 +1,54 @@
+#ifndef DOVE_EYE_METRICS_H_
+#define DOVE_EYE_METRICS_H_
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dove_eye {
+
+/** Process-wide registry of named runtime statistics
+ *
+ * Counters accumulate, gauges hold the last value. Updates are cheap enough
+ * to be done a few times per frameset, not per pixel.
+ */
+class Metrics {
+ public:
+  typedef std::vector<std::pair<std::string, double>> Values;
+
+  /** Component that keeps its own statistics and updates them on demand */
+  typedef std::function<void (Metrics *metrics)> Source;
+
+  static Metrics &Global();
+
+  void Add(const std::string &name, const double delta = 1);
+
+  void Set(const std::string &name, const double value);
+
+  double Get(const std::string &name) const;
+
+  /** Source is called before each Snapshot (it must not take snapshots) */
+  void Register(const Source &source);
+
+  /** Consistent copy of all values ordered by name */
+  Values Snapshot();
+
+  void Reset();
+
+ private:
+  typedef std::map<std::string, double> ValuesMap;
+  typedef std::vector<Source> SourcesVector;
+
+  mutable std::mutex values_mtx_;
+  ValuesMap values_;
+
+  std::mutex sources_mtx_;
+  SourcesVector sources_;
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_METRICS_H_
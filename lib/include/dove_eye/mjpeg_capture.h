@@ -0,0 +1,91 @@
+#ifndef DOVE_EYE_MJPEG_CAPTURE_H_
+#define DOVE_EYE_MJPEG_CAPTURE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dove_eye {
+
+/** Compressed (motion JPEG) frames directly from V4L2 device
+ *
+ * OpenCV capture decodes MJPEG inside retrieve(), this one hands out the
+ * compressed buffers so that they can be decoded elsewhere.
+ *
+ * @note Only available with CONFIG_MJPEG (Linux).
+ */
+class MjpegCapture {
+ public:
+  enum GrabResult {
+    kFrame,
+    kNoFrame,
+    kError
+  };
+
+  MjpegCapture()
+      : fd_(-1),
+        width_(0),
+        height_(0) {
+  }
+
+  ~MjpegCapture() {
+    Close();
+  }
+
+  MjpegCapture(const MjpegCapture &) = delete;
+  MjpegCapture &operator=(const MjpegCapture &) = delete;
+
+  /** Open /dev/video<device> and start streaming
+   *
+   * @param[in]  width, height  0 keeps current size
+   * @param[in]  fps            0 keeps current frame rate
+   */
+  bool Open(const int device, const int width, const int height,
+            const double fps);
+
+  void Close();
+
+  inline bool IsOpen() const {
+    return fd_ >= 0;
+  }
+
+  inline int width() const {
+    return width_;
+  }
+
+  inline int height() const {
+    return height_;
+  }
+
+  /** Copy out the next frame and give its buffer back to the driver
+   *
+   * @param[out]  timestamp  capture time (ClockPolicy epoch) [ns]
+   * @param[in]   block      wait for the frame
+   * @return      kNoFrame only when not blocking and no frame is ready
+   */
+  GrabResult Grab(std::vector<uint8_t> *data, int64_t *timestamp,
+                  const bool block);
+
+ private:
+  struct Buffer {
+    void *address;
+    size_t length;
+  };
+
+  typedef std::vector<Buffer> BuffersVector;
+
+  static const int kBufferCount = 4;
+  /** Blocking grab fails after this time [ms] */
+  static const int kGrabTimeout = 2000;
+
+  int fd_;
+  int width_;
+  int height_;
+  BuffersVector buffers_;
+
+  bool Ioctl(const unsigned long request, void *arg) const;
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_MJPEG_CAPTURE_H_
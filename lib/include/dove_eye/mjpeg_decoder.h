@@ -0,0 +1,46 @@
+#ifndef DOVE_EYE_MJPEG_DECODER_H_
+#define DOVE_EYE_MJPEG_DECODER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <opencv2/opencv.hpp>
+
+namespace dove_eye {
+
+/** Decoder of motion JPEG frames (libjpeg)
+ *
+ * Frames of UVC cameras often omit Huffman tables, standard ones are used
+ * then (libjpeg-turbo does this itself).
+ *
+ * @note Only available with CONFIG_MJPEG.
+ */
+class MjpegDecoder {
+ public:
+  struct Options {
+    /** Decode luminance only (skips chroma upsampling and conversion) */
+    bool grayscale;
+    /** Decode at 1/scale_denom resolution (1, 2, 4 or 8) */
+    int scale_denom;
+    /** Faster, less accurate IDCT and upsampling */
+    bool fast;
+
+    Options(const bool grayscale = false, const int scale_denom = 1,
+            const bool fast = true)
+        : grayscale(grayscale),
+          scale_denom(scale_denom),
+          fast(fast) {
+    }
+  };
+
+  /** Decode frame into BGR (or single channel) image
+   *
+   * Result is (re)allocated only when its size or type differs.
+   */
+  static bool Decode(const uint8_t *data, const size_t size,
+                     const Options &options, cv::Mat *result);
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_MJPEG_DECODER_H_
@@ -0,0 +1,61 @@
+#ifndef DOVE_EYE_MJPEG_FRAME_ITERATOR_H_
+#define DOVE_EYE_MJPEG_FRAME_ITERATOR_H_
+
+#include <deque>
+#include <future>
+
+#include "dove_eye/frame.h"
+#include "dove_eye/frame_iterator.h"
+#include "dove_eye/mjpeg_capture.h"
+#include "dove_eye/mjpeg_decoder.h"
+#include "dove_eye/worker_pool.h"
+
+namespace dove_eye {
+
+/** Frames of MJPEG camera decoded on worker pool
+ *
+ * Usually a frame is decoded before the next one arrives and there's no
+ * pipelining. When frames wait in the driver, their decoding is started in
+ * parallel (up to kMaxInFlight frames), so that slow decoding doesn't limit
+ * frame rate.
+ *
+ * @note Only available with CONFIG_MJPEG (Linux).
+ */
+class MjpegFrameIterator : public FrameIteratorImpl {
+ public:
+  MjpegFrameIterator(const int device, const int width, const int height,
+                     const double fps, const MjpegDecoder::Options &options,
+                     WorkerPool *pool = &WorkerPool::Shared());
+
+  /** Each frame is decoded into its own buffer (no copy) */
+  inline Frame GetFrame() const override {
+    return frame_;
+  }
+
+  void MoveNext() override;
+
+  inline bool IsValid() override {
+    return valid_;
+  }
+
+ private:
+  typedef std::deque<std::future<Frame>> FramesQueue;
+
+  static const size_t kMaxInFlight = 3;
+
+  MjpegCapture capture_;
+  const MjpegDecoder::Options options_;
+  WorkerPool *pool_;
+
+  FramesQueue in_flight_;
+  bool capture_error_;
+  bool valid_;
+  Frame frame_;
+
+  /** @return  whether a frame was grabbed and submitted for decoding */
+  bool Submit(const bool block);
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_MJPEG_FRAME_ITERATOR_H_
@@ -0,0 +1,85 @@
+#ifndef DOVE_EYE_MODEL_STORAGE_H_
+#define DOVE_EYE_MODEL_STORAGE_H_
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+namespace dove_eye {
+
+/* Forward */
+class InnerTracker;
+template <class InnerTrackerT> class BasicTracker;
+typedef BasicTracker<InnerTracker> Tracker;
+
+/** Binary output of tracker appearance models
+ *
+ * Values are stored in host byte order, the file header detects foreign
+ * order.
+ */
+class ModelWriter {
+ public:
+  explicit ModelWriter(std::ostream &output)
+      : output_(output) {
+  }
+
+  inline bool good() const {
+    return output_.good();
+  }
+
+  void Write(const uint32_t value);
+
+  void Write(const double value);
+
+  void Write(const std::string &value);
+
+  /** Any continuous or non-continuous matrix (data are packed) */
+  void Write(const cv::Mat &value);
+
+ private:
+  std::ostream &output_;
+};
+
+class ModelReader {
+ public:
+  explicit ModelReader(std::istream &input)
+      : input_(input) {
+  }
+
+  inline bool good() const {
+    return input_.good();
+  }
+
+  bool Read(uint32_t *value);
+
+  bool Read(double *value);
+
+  bool Read(std::string *value);
+
+  bool Read(cv::Mat *value);
+
+  /** Read string and compare it to expected value */
+  bool Expect(const std::string &value);
+
+ private:
+  std::istream &input_;
+};
+
+/** Files with appearance models of all cameras of a tracker */
+class ModelStorage {
+ public:
+  static bool LoadFromFile(const std::string &filename, Tracker *tracker);
+
+  static bool SaveToFile(const std::string &filename, const Tracker &tracker);
+
+ private:
+  static const uint32_t kMagic;
+  static const uint32_t kVersion;
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_MODEL_STORAGE_H_
@@ -0,0 +1,148 @@
+#ifndef DOVE_EYE_NODE_PROTOCOL_H_
+#define DOVE_EYE_NODE_PROTOCOL_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "dove_eye/frame.h"
+
+namespace dove_eye {
+namespace node {
+
+/*
+ * Capture nodes track their cameras locally and stream posits to a hub over
+ * TCP. Every message is
+ *
+ *   uint16 length (of type and payload), uint8 type, payload
+ *
+ * with integers in network byte order and doubles as IEEE 754 bit patterns
+ * (in network byte order too).
+ *
+ *   kHello  node -> hub  uint32 node_id, uint32 first_cam,
+ *                        uint32 camera_count, uint8 media_time
+ *   kPosit  node -> hub  uint32 cam, uint8 flags, uint64 sequence_no,
+ *                        double timestamp, double x, double y
+ *   kPing   hub -> node  double t0 (hub clock)
+ *   kPong   node -> hub  double t0, double t1, double t2 (node clock)
+ *
+ * Posit flags are bit 0 valid, bit 1 predicted (camera coasted, posit is
+ * not an observation).
+ *
+ * Cameras are identified by global index (first_cam + local index).
+ * Unless media_time is set, timestamps are in node's clock and the hub
+ * estimates offsets from ping/pong round trips. Media time (video files) is
+ * assumed to be synchronized already.
+ */
+const uint16_t kDefaultPort = 5117;
+
+struct Message {
+  enum Type {
+    kInvalid = 0,
+    kHello = 1,
+    kPosit = 2,
+    kPing = 3,
+    kPong = 4
+  };
+
+  Type type;
+
+  /* kHello */
+  uint32_t node_id;
+  uint32_t first_cam;
+  uint32_t camera_count;
+  bool media_time;
+
+  /* kPosit */
+  uint32_t cam;
+  bool valid;
+  bool predicted;
+  uint64_t sequence_no;
+  Frame::Timestamp timestamp;
+  double x;
+  double y;
+
+  /* kPing, kPong */
+  Frame::Timestamp t0;
+  Frame::Timestamp t1;
+  Frame::Timestamp t2;
+
+  explicit Message(const Type type = kInvalid)
+      : type(type),
+        node_id(0),
+        first_cam(0),
+        camera_count(0),
+        media_time(false),
+        cam(0),
+        valid(false),
+        predicted(false),
+        sequence_no(0),
+        timestamp(0),
+        x(0),
+        y(0),
+        t0(0),
+        t1(0),
+        t2(0) {
+  }
+};
+
+/** Message framing on a connected TCP socket
+ *
+ * Sending blocks until the message is written, receiving is non-blocking
+ * (suitable for poll loops).
+ */
+class Connection {
+ public:
+  /** Takes ownership of the socket */
+  explicit Connection(const int fd = -1)
+      : fd_(fd) {
+  }
+
+  ~Connection() {
+    Close();
+  }
+
+  Connection(const Connection &) = delete;
+  Connection &operator=(const Connection &) = delete;
+
+  static Connection *Connect(const std::string &host, const uint16_t port);
+
+  inline int fd() const {
+    return fd_;
+  }
+
+  inline bool IsOpen() const {
+    return fd_ >= 0;
+  }
+
+  void Close();
+
+  bool Send(const Message &message);
+
+  /** Read all available data
+   *
+   * @return  false when connection was closed or failed
+   */
+  bool Receive();
+
+  /** Take next complete message out of received data */
+  bool Pop(Message *message);
+
+ private:
+  int fd_;
+  std::vector<uint8_t> buffer_;
+};
+
+/** Listening socket for node connections
+ *
+ * @return  socket descriptor or -1 on failure
+ */
+int Listen(const uint16_t port);
+
+/** Accept a pending connection on listening socket */
+Connection *Accept(const int listen_fd);
+
+} // namespace node
+} // namespace dove_eye
+
+#endif // DOVE_EYE_NODE_PROTOCOL_H_
@@ -28,13 +28,26 @@ class Parameters {
     DECLARE_PARAM(SEARCH_MIN_SPEED),
     DECLARE_PARAM(SEARCH_KF_PROC_V),
     DECLARE_PARAM(SEARCH_KF_OBS_V),
+    DECLARE_PARAM(CIRCLE_DETECTOR),
+    DECLARE_PARAM(LOCATION_KF_PROC_V),
+    DECLARE_PARAM(LOCATION_KF_OBS_V),
+    DECLARE_PARAM(LOCATION_TIMEOUT),
+    DECLARE_PARAM(TRACK_BUDGET),
+    DECLARE_PARAM(LOCALIZATION_MAX_PAIRS),
+    DECLARE_PARAM(LOCALIZATION_INLIER_THR),
     DECLARE_PARAM(AGGREGATOR_WINDOW),
+    DECLARE_PARAM(PLAYBACK_SNAPSHOT_PERIOD),
+    DECLARE_PARAM(PLAYBACK_SPEED),
+    DECLARE_PARAM(PLAYBACK_DROP_LATE),
     DECLARE_PARAM_ARRAY(CAM_OFFSET, CONFIG_MAX_ARITY),
     DECLARE_PARAM(CALIBRATION_ROWS),
     DECLARE_PARAM(CALIBRATION_COLS),
     DECLARE_PARAM(CALIBRATION_SIZE),
     DECLARE_PARAM(CALIBRATION_FRAMES),
     DECLARE_PARAM(CALIBRATION_SKIP),
+    DECLARE_PARAM(CALIBRATION_BUNDLE),
+    DECLARE_PARAM(CALIBRATION_PATTERN),
+    DECLARE_PARAM(CALIBRATION_MARKER_RATIO),
     _MAX_KEY
   };
 
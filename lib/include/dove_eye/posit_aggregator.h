@@ -0,0 +1,73 @@
+#ifndef DOVE_EYE_POSIT_AGGREGATOR_H_
+#define DOVE_EYE_POSIT_AGGREGATOR_H_
+
+#include <deque>
+#include <vector>
+
+#include "dove_eye/frame.h"
+#include "dove_eye/parameters.h"
+#include "dove_eye/positset.h"
+#include "dove_eye/types.h"
+
+namespace dove_eye {
+
+/** Groups timestamped posits of individual cameras into positsets
+ *
+ * It's a counterpart of AggregatorIterator for posits that were tracked
+ * elsewhere (e.g. on remote nodes), the time window is the same.
+ */
+class PositAggregator {
+ public:
+  PositAggregator(const CameraIndex arity, const Parameters &parameters);
+
+  inline CameraIndex Arity() const {
+    return arity_;
+  }
+
+  /** Add result of tracking a camera frame
+   *
+   * @param[in]  valid      false when frame was processed but object not found
+   * @param[in]  predicted  posit was coasted, not observed
+   * @return     true when a new positset is ready
+   */
+  bool Add(const CameraIndex cam, const Posit &posit, const bool valid,
+           const Frame::Timestamp timestamp, const bool predicted = false);
+
+  inline const Positset &positset() const {
+    return positset_;
+  }
+
+  /** Time of the last positset
+   *
+   * It's the start of the current window, the positset holds the latest
+   * posits older than it. Hence it's between time of the frames the positset
+   * comes from and time of the next frames.
+   */
+  inline Frame::Timestamp time() const {
+    return window_start_;
+  }
+
+ private:
+  struct TimedPosit {
+    Posit posit;
+    bool valid;
+    bool predicted;
+    Frame::Timestamp timestamp;
+  };
+
+  typedef std::deque<TimedPosit> PositQueue;
+  typedef std::vector<PositQueue> QueuesContainer;
+
+  const CameraIndex arity_;
+  const Parameters &parameters_;
+
+  Frame::Timestamp window_start_;
+  QueuesContainer queues_;
+  Positset positset_;
+
+  bool PreparePositset();
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_POSIT_AGGREGATOR_H_
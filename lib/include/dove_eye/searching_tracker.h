@@ -10,11 +10,56 @@
 
 namespace dove_eye {
 
+/** Tracker that searches for the object around its expected position
+ *
+ * Implementation specific steps are provided by DerivedT (CRTP), which
+ * declares typedef Data (its TrackerData) and these non-virtual members:
+ *
+ *   Data &data(), const Data &data() const
+ *   bool InitTrackerData(const cv::Mat &data, const Mark &mark)
+ *   void SaveTrackerData(ModelWriter *writer) const
+ *   bool LoadTrackerData(ModelReader *reader)
+ *   bool Search(const cv::Mat &data, Data &tracker_data, const cv::Rect *roi,
+ *               const cv::Mat *mask, const double threshold,
+ *               Mark *result) const
+ *   Posit MarkToPosit(const Mark &mark) const
+ *   cv::Rect DataToRoi(const Data &tracker_data, const Point2 exp,
+ *                      const double search_factor) const
+ *
+ * Search
+ *   Generic search for an matching object.
+ *   data          image to search for object
+ *   tracker_data  search query (implementation specific)
+ *   roi           (optional) region of interest that should be searched
+ *                 (in the image)
+ *   mask          (optional) boolean mask restricting search (in the image
+ *                 too)
+ *   threshold     value [0,1] to accept the match (the higher, the better)
+ *   result        mark positioned to the best match
+ *   Returns true if sufficient match was found, false otherwise.
+ *
+ * SaveTrackerData output should start with implementation tag,
+ * LoadTrackerData returns false for invalid data or data of other
+ * implementation.
+ *
+ * Hooks are called directly and they get typed tracker data, so that
+ * tracking loop needs no virtual calls nor casts.
+ */
+template <class DerivedT>
 class SearchingTracker : public InnerTracker {
  public:
   explicit SearchingTracker(const Parameters &parameters)
       : InnerTracker(parameters),
-        initialized_(false) {
+        initialized_(false),
+        kalman_seeded_(false) {
+  }
+
+  inline const TrackerData &tracker_data() const override {
+    return derived().data();
+  }
+
+  inline TrackerData &tracker_data() override {
+    return derived().data();
   }
 
   bool InitializeTracking(const Frame &frame, const Mark mark,
@@ -28,9 +73,20 @@ class SearchingTracker : public InnerTracker {
  
   bool Track(const Frame &frame, Posit *result) override;
 
-  // FIXME override other ReinitializeTracking overloads
+  bool Track(const Frame &frame, const Prior prior, Posit *result) override;
+
+  bool Coast(const Frame &frame, Posit *result) override;
+
+  // FIXME override epiline ReinitializeTracking overload
   bool ReinitializeTracking(const Frame &frame, Posit *result) override;
 
+  bool ReinitializeTracking(const Frame &frame, const Point2 guess,
+                            Posit *result) override;
+
+  bool SaveModel(ModelWriter *writer) const override;
+
+  bool LoadModel(ModelReader *reader) override;
+
  protected:
   typedef CvKalmanFilter KalmanFilterT;
 
@@ -46,41 +102,17 @@ class SearchingTracker : public InnerTracker {
     return bg_subtractor_;
   }
 
-
-  /** Initialize tracker data
-   * @return  false when initialization failed
-   */
-  virtual bool InitTrackerData(const cv::Mat &data, const Mark &mark) = 0;
-
-  /** Generic search for an matching object
+  /** Stop sharing state with the tracker this one was copied from
    *
-   * @param[in]   data         image to search for object
-   * @param[in]   tracker_data search query (implementation specific)
-   * @param[in]   roi          (optional) region of interest that should be searched
-   *                           (in the image)
-   * @param[in]   mask         (optional) boolean mask restricting search (in the
-   *                           image too)
-   * @param[in]   threshold    value [0,1] to accept the match (the higher, the
-   *                           better)
-   * @param[out]  result       mark positioned to the best match
-   *
-   * @return      true if sufficient match was found, false otherwise
+   * Background model is not copied but restarted, it's large and it is
+   * relearned in a few frames.
    */
-  virtual bool Search(
-      const cv::Mat &data,
-      TrackerData &tracker_data,
-      const cv::Rect *roi,
-      const cv::Mat *mask,
-      const double threshold,
-      Mark *result) const = 0;
-
-  virtual Posit MarkToPosit(const Mark &mark) const = 0;
-
-  virtual cv::Rect DataToRoi(const TrackerData &tracker_data, const Point2 exp,
-                             const double search_factor) const = 0;
+  void DetachState();
 
  private:
   bool initialized_;
+  /** Filter has an observation (false after model load until reacquire) */
+  bool kalman_seeded_;
   KalmanFilterT kalman_filter_;
   cv::BackgroundSubtractorMOG bg_subtractor_;
 
@@ -89,6 +121,27 @@ class SearchingTracker : public InnerTracker {
   }
 
   void InitializeKalmanFilter();
+
+  /** Feed observed posit to the filter, first one resets it
+   * @return  filtered posit
+   */
+  Posit FilterPosit(const double time, const Posit posit);
+
+  /** Learn background model from frame
+   * @return  foreground mask of the frame
+   */
+  cv::Mat UpdateForeground(const Frame &frame);
+
+  bool SearchAndUpdate(const Frame &frame, const cv::Rect &roi,
+                       const cv::Mat *mask, Posit *result);
+
+  inline DerivedT &derived() {
+    return static_cast<DerivedT &>(*this);
+  }
+
+  inline const DerivedT &derived() const {
+    return static_cast<const DerivedT &>(*this);
+  }
 };
 
 } // namespace dove_eye
@@ -0,0 +1,144 @@
+#ifndef DOVE_EYE_SHM_FRAME_RING_H_
+#define DOVE_EYE_SHM_FRAME_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+#include "dove_eye/shm_segment.h"
+
+namespace dove_eye {
+namespace shm {
+
+/*
+ * Layout of shared memory frame ring (version 1)
+ *
+ *   0                        FrameRingHeader
+ *   data_offset              slot 0: FrameSlotHeader, pixels at +kSlotDataOffset
+ *   data_offset + slot_size  slot 1
+ *   ...                      (slot_count slots)
+ *
+ * All offsets are multiples of kAlignment, integers are in host byte order
+ * (the ring is meant for processes of a single host). Pixels of a frame are
+ * height rows of step bytes, format is given by OpenCV type (e.g. CV_8UC3
+ * for BGR).
+ *
+ * Protocol (single producer, single consumer):
+ *  - Frame number s is stored in slot s % slot_count.
+ *  - Producer marks the slot kSlotWriting, checks it's not held by consumer
+ *    (see below), copies data and stores s to slot's seq, then increments
+ *    write_seq and notify (futex word, woken when waiters > 0).
+ *  - Consumer announces frames it holds by storing consumed = s + 1. Frames
+ *    consumed - hold ... consumed - 1 are never overwritten, the producer
+ *    drops new frames instead (counted in dropped). Consumer then verifies
+ *    slot's seq is still s, otherwise it has been lapped by the producer.
+ *  - Producer sets closed when it finishes.
+ *
+ * Slot's timestamp_ns is capture time in CLOCK_MONOTONIC (steady clock of the
+ * host), consumers convert it to their epoch (ClockPolicy::FromSteady), so
+ * that ring frames are comparable with frames of local cameras.
+ */
+const uint32_t kFrameRingMagic = 0x52464544; /* "DEFR" */
+const uint32_t kFrameRingVersion = 1;
+const size_t kAlignment = 64;
+
+const uint64_t kSlotEmpty = UINT64_MAX;
+const uint64_t kSlotWriting = UINT64_MAX - 1;
+
+struct FrameRingHeader {
+  /* Immutable after creation */
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t width;
+  uint32_t height;
+  int32_t type;
+  uint64_t step;
+  uint64_t slot_size;
+  uint64_t data_offset;
+  /** Nominal frame rate of producer, 0 when unknown */
+  double fps;
+
+  /* Written by producer */
+  alignas(kAlignment) std::atomic<uint64_t> write_seq;
+  std::atomic<uint64_t> dropped;
+  std::atomic<uint32_t> notify;
+  std::atomic<uint32_t> closed;
+
+  /* Written by consumer */
+  alignas(kAlignment) std::atomic<uint64_t> consumed;
+  std::atomic<uint32_t> hold;
+  std::atomic<uint32_t> waiters;
+};
+
+struct FrameSlotHeader {
+  /** Number of stored frame (or kSlotEmpty, kSlotWriting) */
+  std::atomic<uint64_t> seq;
+  /** Capture time, CLOCK_MONOTONIC in nanoseconds */
+  uint64_t timestamp_ns;
+};
+
+const size_t kSlotDataOffset = kAlignment;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+              "Shared memory ring requires lock-free atomics");
+static_assert(sizeof(FrameSlotHeader) <= kSlotDataOffset,
+              "Slot header overlaps pixel data");
+
+inline size_t AlignUp(const size_t value) {
+  return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+inline FrameSlotHeader *SlotAt(FrameRingHeader *header, const uint64_t seq) {
+  auto base = reinterpret_cast<uint8_t *>(header) + header->data_offset;
+  auto slot = base + (seq % header->slot_count) * header->slot_size;
+  return reinterpret_cast<FrameSlotHeader *>(slot);
+}
+
+inline uint8_t *SlotData(FrameSlotHeader *slot) {
+  return reinterpret_cast<uint8_t *>(slot) + kSlotDataOffset;
+}
+
+/** Check that segment contains consistent ring */
+bool ValidateRing(const ShmSegment &segment);
+
+/** Producer side of the ring */
+class FrameRingWriter {
+ public:
+  FrameRingWriter()
+      : header_(nullptr) {
+  }
+
+  ~FrameRingWriter() {
+    Close();
+  }
+
+  bool Create(const std::string &name, const cv::Size size, const int type,
+              const uint32_t slot_count, const double fps = 0);
+
+  /** Copy frame into the ring
+   *
+   * @param[in]  timestamp_ns  capture time (CLOCK_MONOTONIC)
+   * @return     false when frame was dropped (consumer holds the slot)
+   */
+  bool Publish(const cv::Mat &frame, const uint64_t timestamp_ns);
+
+  /** Mark the stream finished, segment is removed */
+  void Close();
+
+  inline uint64_t dropped() const {
+    return header_ ? header_->dropped.load() : 0;
+  }
+
+ private:
+  ShmSegment segment_;
+  FrameRingHeader *header_;
+};
+
+} // namespace shm
+} // namespace dove_eye
+
+#endif // DOVE_EYE_SHM_FRAME_RING_H_
@@ -0,0 +1,84 @@
+#ifndef DOVE_EYE_SHM_RESULT_PUBLISHER_H_
+#define DOVE_EYE_SHM_RESULT_PUBLISHER_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "dove_eye/frame.h"
+#include "dove_eye/location.h"
+#include "dove_eye/positset.h"
+#include "dove_eye/shm_result_ring.h"
+#include "dove_eye/shm_segment.h"
+
+namespace dove_eye {
+namespace shm {
+
+/** Publishes tracking results into shared memory ring
+ *
+ * Publishing is wait-free, readers (see ResultReader) cannot slow it down.
+ *
+ * @note Single writer only, unless writers are serialized (see shared()).
+ */
+class ResultPublisher {
+ public:
+  static const uint32_t kDefaultSlotCount = 256;
+
+  ResultPublisher()
+      : header_(nullptr),
+        source_(0),
+        shared_(false) {
+  }
+
+  bool Create(const std::string &name,
+              const uint32_t slot_count = kDefaultSlotCount);
+
+  inline bool IsOpen() const {
+    return header_ != nullptr;
+  }
+
+  /** Identification of producer stored in records */
+  inline void source(const uint32_t value) {
+    source_ = value;
+  }
+
+  /** Serialize writers, so that several pipelines can share the ring
+   *
+   * They tell their records apart by source.
+   */
+  inline void shared(const bool value) {
+    shared_ = value;
+  }
+
+  inline void Publish(const Positset &positset,
+                      const Frame::Timestamp timestamp) {
+    Publish(positset, timestamp, source_);
+  }
+
+  void Publish(const Positset &positset, const Frame::Timestamp timestamp,
+               const uint32_t source);
+
+  inline void Publish(const Location &location, const uint64_t sequence_no,
+                      const Frame::Timestamp timestamp) {
+    Publish(location, sequence_no, timestamp, source_);
+  }
+
+  void Publish(const Location &location, const uint64_t sequence_no,
+               const Frame::Timestamp timestamp, const uint32_t source);
+
+  void Publish(const ResultRecord &record);
+
+ private:
+  ShmSegment segment_;
+  ResultRingHeader *header_;
+  uint32_t source_;
+  bool shared_;
+  std::mutex writers_mtx_;
+
+  void Write(const ResultRecord &record);
+};
+
+} // namespace shm
+} // namespace dove_eye
+
+#endif // DOVE_EYE_SHM_RESULT_PUBLISHER_H_
@@ -0,0 +1,186 @@
+#ifndef DOVE_EYE_SHM_RESULT_READER_H_
+#define DOVE_EYE_SHM_RESULT_READER_H_
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dove_eye/shm_result_ring.h"
+
+namespace dove_eye {
+namespace shm {
+
+/** Reader of results published by dove-eye
+ *
+ * Header only, so that consumers need not link against dove-eye (only -lrt
+ * on older systems). Reading never blocks the publisher, there can be any
+ * number of readers.
+ */
+class ResultReader {
+ public:
+  ResultReader()
+      : header_(nullptr),
+        size_(0),
+        next_(0) {
+  }
+
+  ~ResultReader() {
+    Close();
+  }
+
+  ResultReader(const ResultReader &) = delete;
+  ResultReader &operator=(const ResultReader &) = delete;
+
+  /** Open ring, reading starts with the next published record */
+  bool Open(const char *name) {
+    Close();
+
+    const int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+      return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(ResultRingHeader)) {
+      close(fd);
+      return false;
+    }
+
+    /* Mapped writable because atomics may not be readable from RO pages */
+    void *address = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+      return false;
+    }
+
+    header_ = static_cast<ResultRingHeader *>(address);
+    size_ = st.st_size;
+
+    const bool valid = header_->magic == kResultRingMagic &&
+        header_->version == kResultRingVersion &&
+        header_->record_size == sizeof(ResultRecord) &&
+        header_->slot_count > 0 &&
+        header_->slot_offset + header_->slot_count * sizeof(ResultSlot) <=
+            size_;
+    if (!valid) {
+      Close();
+      return false;
+    }
+
+    next_ = Count();
+    return true;
+  }
+
+  void Close() {
+    if (header_) {
+      munmap(header_, size_);
+      header_ = nullptr;
+      size_ = 0;
+    }
+  }
+
+  inline bool IsOpen() const {
+    return header_ != nullptr;
+  }
+
+  /** Number of records published so far */
+  inline uint64_t Count() const {
+    return header_->write_count.load(std::memory_order_acquire);
+  }
+
+  /** Read record of given number
+   *
+   * @return  false when it's not published yet or already overwritten
+   */
+  bool Read(const uint64_t index, ResultRecord *record) const {
+    auto slot = ResultSlotAt(header_, index);
+    const uint64_t expected = ResultSlotVersion(header_, index);
+
+    const uint64_t before = slot->version.load(std::memory_order_acquire);
+    if (before != expected) {
+      return false;
+    }
+
+    uint64_t words[kRecordWords];
+    for (size_t i = 0; i < kRecordWords; ++i) {
+      words[i] = slot->words[i].load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->version.load(std::memory_order_relaxed) != before) {
+      return false;
+    }
+
+    std::memcpy(record, words, sizeof(ResultRecord));
+    return true;
+  }
+
+  /** Read the oldest unread record
+   *
+   * @param[out]  lost  number of records overwritten before they were read
+   * @return      false when there is no new record
+   */
+  bool Next(ResultRecord *record, uint64_t *lost = nullptr) {
+    uint64_t skipped = 0;
+
+    while (true) {
+      const uint64_t count = Count();
+      if (next_ >= count) {
+        break;
+      }
+
+      /* Records older than one lap are gone for sure */
+      if (count - next_ > header_->slot_count) {
+        skipped += count - header_->slot_count - next_;
+        next_ = count - header_->slot_count;
+      }
+
+      if (Read(next_, record)) {
+        ++next_;
+        if (lost) {
+          *lost = skipped;
+        }
+        return true;
+      }
+
+      /* Overwritten meanwhile */
+      ++next_;
+      ++skipped;
+    }
+
+    if (lost) {
+      *lost = skipped;
+    }
+    return false;
+  }
+
+  /** Read the newest record (does not affect Next()) */
+  bool Latest(ResultRecord *record) const {
+    /* Retry few times when the writer is faster than us */
+    for (int attempt = 0; attempt < 3; ++attempt) {
+      const uint64_t count = Count();
+      if (count == 0) {
+        return false;
+      }
+      if (Read(count - 1, record)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  ResultRingHeader *header_;
+  size_t size_;
+  uint64_t next_;
+};
+
+} // namespace shm
+} // namespace dove_eye
+
+#endif // DOVE_EYE_SHM_RESULT_READER_H_
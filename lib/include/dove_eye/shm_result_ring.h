@@ -0,0 +1,90 @@
+#ifndef DOVE_EYE_SHM_RESULT_RING_H_
+#define DOVE_EYE_SHM_RESULT_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * This header is shared with consumers outside of dove-eye, it must not
+ * depend on OpenCV nor the rest of the library.
+ */
+
+namespace dove_eye {
+namespace shm {
+
+/*
+ * Layout of shared memory result ring (version 1)
+ *
+ *   0            ResultRingHeader
+ *   slot_offset  ResultSlot[slot_count]
+ *
+ * Record number i is stored in slot i % slot_count. Each slot is a seqlock:
+ * writer makes its version odd, stores the record and makes the version even
+ * again, so slot holding record i has version 2 * (i / slot_count + 1).
+ * Readers never block the writer, they retry (or skip) torn reads.
+ * Record is stored as 64-bit words accessed atomically, so that concurrent
+ * reading is well defined.
+ */
+const uint32_t kResultRingMagic = 0x52524544; /* "DERR" */
+const uint32_t kResultRingVersion = 1;
+const uint32_t kResultMaxCameras = 8;
+
+struct ResultRecord {
+  enum Kind {
+    kPositset = 1,
+    kLocation = 2
+  };
+
+  /** Sequence number of frameset the result comes from */
+  uint64_t sequence_no;
+  /** Time of the frameset (in seconds) */
+  double timestamp;
+  uint32_t kind;
+  /** Producer of the result (0 for local pipeline) */
+  uint32_t source;
+  uint32_t arity;
+  /** Bit per camera, set when posit is valid (kPositset only) */
+  uint32_t valid_mask;
+  /** World coordinates (kLocation only) */
+  double location[3];
+  /** Image coordinates (kPositset only) */
+  double posits[kResultMaxCameras][2];
+};
+
+const size_t kRecordWords = sizeof(ResultRecord) / sizeof(uint64_t);
+
+static_assert(sizeof(ResultRecord) % sizeof(uint64_t) == 0,
+              "Record must consist of whole words");
+
+struct ResultSlot {
+  std::atomic<uint64_t> version;
+  std::atomic<uint64_t> words[kRecordWords];
+};
+
+struct ResultRingHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t record_size;
+  uint64_t slot_offset;
+
+  /** Number of records written so far */
+  alignas(64) std::atomic<uint64_t> write_count;
+};
+
+inline ResultSlot *ResultSlotAt(ResultRingHeader *header,
+                                const uint64_t index) {
+  auto base = reinterpret_cast<uint8_t *>(header) + header->slot_offset;
+  return reinterpret_cast<ResultSlot *>(base) + index % header->slot_count;
+}
+
+inline uint64_t ResultSlotVersion(const ResultRingHeader *header,
+                                  const uint64_t index) {
+  return 2 * (index / header->slot_count + 1);
+}
+
+} // namespace shm
+} // namespace dove_eye
+
+#endif // DOVE_EYE_SHM_RESULT_RING_H_
@@ -0,0 +1,101 @@
+#ifndef DOVE_EYE_SHM_SEGMENT_H_
+#define DOVE_EYE_SHM_SEGMENT_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace dove_eye {
+
+/** POSIX shared memory segment mapped into process memory
+ *
+ * Creator of the segment owns it, i.e. it's unlinked when the creator closes
+ * it. Mapping is released with the object.
+ *
+ * Owner holds an exclusive flock of the segment while it lives. The lock is
+ * released by the kernel even when the owner crashes, which tells a stale
+ * segment from one of a running process.
+ *
+ * @note Not available on Windows.
+ */
+class ShmSegment {
+ public:
+  ShmSegment()
+      : address_(nullptr),
+        size_(0),
+        owner_(false),
+        owner_fd_(-1) {
+  }
+
+  ~ShmSegment() {
+    Close();
+  }
+
+  ShmSegment(const ShmSegment &) = delete;
+  ShmSegment &operator=(const ShmSegment &) = delete;
+
+  /** Create new segment
+   *
+   * Stale segment with the same name (its owner died) is replaced, segment
+   * of a running owner is not.
+   *
+   * @param[in]  name  POSIX shm name (e.g. "/dove-eye-cam0")
+   */
+  bool Create(const std::string &name, const size_t size);
+
+  /** Map existing segment (as a whole) */
+  bool Open(const std::string &name);
+
+  void Close();
+
+  inline bool IsOpen() const {
+    return address_ != nullptr;
+  }
+
+  inline void *address() const {
+    return address_;
+  }
+
+  inline size_t size() const {
+    return size_;
+  }
+
+  inline const std::string &name() const {
+    return name_;
+  }
+
+ private:
+  std::string name_;
+  void *address_;
+  size_t size_;
+  bool owner_;
+  /** Keeps the owner lock */
+  int owner_fd_;
+
+  bool Map(const int fd, const size_t size);
+
+  /** Unlink segment of the name if its owner is gone
+   *
+   * @return  false when the segment is alive (or cannot be checked)
+   */
+  static bool UnlinkStale(const std::string &name);
+};
+
+/** Nanoseconds of CLOCK_MONOTONIC (shared by all processes of the host) */
+uint64_t MonotonicNanoseconds();
+
+/** Wait on inter-process futex word while it has the expected value
+ *
+ * @param[in]  timeout  in seconds
+ * @return     false on timeout
+ */
+bool FutexWait(std::atomic<uint32_t> *word, const uint32_t expected,
+               const double timeout);
+
+/** Wake all inter-process waiters of the futex word */
+void FutexWake(std::atomic<uint32_t> *word);
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_SHM_SEGMENT_H_
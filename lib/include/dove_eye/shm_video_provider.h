@@ -0,0 +1,51 @@
+#ifndef DOVE_EYE_SHM_VIDEO_PROVIDER_H_
+#define DOVE_EYE_SHM_VIDEO_PROVIDER_H_
+
+#include <cstdint>
+#include <string>
+
+#include "dove_eye/shm_segment.h"
+#include "dove_eye/video_provider.h"
+
+namespace dove_eye {
+
+/** Frames from shared memory ring written by another local process
+ *
+ * Each frame is copied out of the ring (into a MatPool buffer) while its slot
+ * is protected, so frames stay valid however long they're queued.
+ *
+ * @see dove_eye/shm_frame_ring.h for the layout and protocol
+ * @note Only one iterator (consumer) may be active at a time.
+ */
+class ShmVideoProvider : public VideoProvider {
+ public:
+  /**
+   * @param[in]  name     POSIX shm name of the ring
+   * @param[in]  hold     number of recent frames protected from overwriting
+   *                      (while they're copied), 0 means half of the ring
+   * @param[in]  timeout  the stream ends when no frame comes for this long
+   *                      (in seconds)
+   */
+  explicit ShmVideoProvider(const std::string &name, const uint32_t hold = 0,
+                            const double timeout = 5);
+
+  inline std::string Id() const {
+    return "shm:" + name_;
+  }
+
+  FrameIterator begin() override;
+
+  FrameIterator end() override;
+
+ private:
+  const std::string name_;
+  const uint32_t hold_;
+  const double timeout_;
+
+  /** Mapping must outlive frames given out, i.e. it lives with provider */
+  ShmSegment segment_;
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_SHM_VIDEO_PROVIDER_H_
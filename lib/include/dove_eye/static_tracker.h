@@ -0,0 +1,58 @@
+#ifndef DOVE_EYE_STATIC_TRACKER_H_
+#define DOVE_EYE_STATIC_TRACKER_H_
+
+#include <memory>
+#include <string>
+
+#include "config.h"
+#include "dove_eye/inner_tracker.h"
+#include "dove_eye/inner_tracker_factory.h"
+#include "dove_eye/parameters.h"
+#include "dove_eye/tracker.h"
+#ifdef CONFIG_STATIC_TRACKER
+#include "dove_eye/circle_tracker.h"
+#include "dove_eye/histogram_tracker.h"
+#include "dove_eye/template_tracker.h"
+#endif
+
+namespace dove_eye {
+
+/** Inner tracker of headless tools
+ *
+ * Build can pin single implementation (CONFIG_STATIC_TRACKER), tracking loop
+ * then calls it statically. Otherwise it's selected at runtime.
+ */
+#ifdef CONFIG_STATIC_TRACKER
+typedef CONFIG_STATIC_TRACKER_CLASS StaticInnerTracker;
+#else
+typedef InnerTracker StaticInnerTracker;
+#endif
+
+typedef BasicTracker<StaticInnerTracker> StaticTracker;
+
+/** Tracker of headless tools unless chosen otherwise (always in the build) */
+#ifdef CONFIG_STATIC_TRACKER
+const char kDefaultStaticTracker[] = CONFIG_STATIC_TRACKER;
+#else
+const char kDefaultStaticTracker[] = "circle";
+#endif
+
+/** Create inner tracker by name (see CreateInnerTracker)
+ *
+ * @return  new tracker (caller owns it) or nullptr for unknown name or
+ *          implementation other than the pinned one
+ */
+inline StaticInnerTracker *CreateStaticInnerTracker(
+    const std::string &name,
+    const Parameters &parameters) {
+  std::unique_ptr<InnerTracker> tracker(CreateInnerTracker(name, parameters));
+  auto result = dynamic_cast<StaticInnerTracker *>(tracker.get());
+  if (result) {
+    tracker.release();
+  }
+  return result;
+}
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_STATIC_TRACKER_H_
@@ -0,0 +1,69 @@
+#ifndef DOVE_EYE_TEE_VIDEO_PROVIDER_H_
+#define DOVE_EYE_TEE_VIDEO_PROVIDER_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "dove_eye/video_provider.h"
+
+namespace dove_eye {
+
+/** Branch of a source shared by several consumers
+ *
+ * Source (e.g. a camera that can be opened only once) is read by a capture
+ * thread, started by the first iteration of any branch. Each captured frame
+ * is copied once and the copy is shared by all branches (cv::Mat is
+ * reference counted), consumers mustn't modify frame data in place.
+ *
+ * Every iterator has its own queue of given depth. When a consumer is slow
+ * and its queue is full, frames are dropped by the branch's policy, capture
+ * and other branches never wait for it.
+ *
+ * @note Meant for live sources, the capture runs once (no seeking).
+ */
+class TeeVideoProvider : public VideoProvider {
+ public:
+  enum DropPolicy {
+    /** Keep the newest frames (e.g. tracking, preview) */
+    kDropOldest,
+    /** Keep continuous run of frames until consumer catches up */
+    kDropNewest
+  };
+
+  static const size_t kDefaultDepth = 4;
+
+  /** Tee of the source (takes ownership), this is its first branch */
+  explicit TeeVideoProvider(VideoProvider *source,
+                            const size_t depth = kDefaultDepth,
+                            const DropPolicy policy = kDropOldest);
+
+  /** Another consumer of the same source (thread safe)
+   *
+   * @return  new provider (caller owns it), it may outlive this one
+   */
+  TeeVideoProvider *Branch(const size_t depth = kDefaultDepth,
+                           const DropPolicy policy = kDropOldest) const;
+
+  std::string Id() const override;
+
+  FrameIterator begin() override;
+
+  FrameIterator end() override;
+
+ private:
+  class Hub;
+  class Iterator;
+
+  std::shared_ptr<Hub> hub_;
+  const size_t branch_;
+  const size_t depth_;
+  const DropPolicy policy_;
+
+  TeeVideoProvider(const std::shared_ptr<Hub> &hub, const size_t branch,
+                   const size_t depth, const DropPolicy policy);
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_TEE_VIDEO_PROVIDER_H_
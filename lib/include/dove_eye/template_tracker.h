@@ -7,7 +7,7 @@
 
 namespace dove_eye {
 
-class TemplateTracker : public SearchingTracker {
+class TemplateTracker final : public SearchingTracker<TemplateTracker> {
  public:
   struct TemplateData : public TrackerData {
     cv::Mat search_template;
@@ -30,55 +30,67 @@ class TemplateTracker : public SearchingTracker {
     }
   };
 
+  typedef TemplateData Data;
+
   explicit TemplateTracker(const Parameters &parameters)
       : SearchingTracker(parameters) {
   }
-
-  inline const TrackerData &tracker_data() const override {
-    return data_;
-  }
- 
-  inline TrackerData &tracker_data() override {
-    return data_;
-  }
  
-  InnerTracker *Clone() const override {
+  TemplateTracker *Clone() const override {
     assert(!initialized());
 
     return new TemplateTracker(*this);
   }
 
+  TemplateTracker *CloneState() const override {
+    auto result = new TemplateTracker(*this);
+    result->DetachState();
+    result->data_.search_template = data_.search_template.clone();
+    return result;
+  }
+
   inline InnerTracker::Mark::Type PreferredMarkType() const {
     return InnerTracker::Mark::kCircle;
   }
 
- protected:
-  bool InitTrackerData(const cv::Mat &data, const Mark &mark) override;
+ private:
+  friend class SearchingTracker<TemplateTracker>;
+
+  TemplateData data_;
+
+  inline TemplateData &data() {
+    return data_;
+  }
+
+  inline const TemplateData &data() const {
+    return data_;
+  }
+
+  bool InitTrackerData(const cv::Mat &data, const Mark &mark);
+
+  void SaveTrackerData(ModelWriter *writer) const;
+
+  bool LoadTrackerData(ModelReader *reader);
 
   bool Search(
       const cv::Mat &data,
-      TrackerData &tracker_data,
+      TemplateData &tpl,
       const cv::Rect *roi,
       const cv::Mat *mask,
       const double threshold,
-      Mark *result) const override;
+      Mark *result) const;
 
-  inline Posit MarkToPosit(const Mark &mark) const override {
+  inline Posit MarkToPosit(const Mark &mark) const {
     assert(mark.type == Mark::kCircle);
     return mark.center;
   }
 
-  inline cv::Rect DataToRoi(const TrackerData &tracker_data, const Point2 exp,
-                            const double search_factor) const override {
+  inline cv::Rect DataToRoi(const TemplateData &data, const Point2 exp,
+                            const double search_factor) const {
     const auto f = search_factor;
-    const auto &data = static_cast<const TemplateData &>(tracker_data);
     return cv::Rect(exp.x - f * data.radius, exp.y - f * data.radius,
                     2 * f * data.radius, 2 * f * data.radius);
   }
-
- private:
-  TemplateData data_;
-  
 };
 
 } // namespace dove_eye
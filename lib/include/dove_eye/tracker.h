@@ -2,34 +2,105 @@
 #define DOVE_EYE_TRACKER_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <opencv2/opencv.hpp>
 
 #include "dove_eye/calibration_data.h"
+#include "dove_eye/camera_scheduler.h"
 #include "dove_eye/frame.h"
 #include "dove_eye/frameset.h"
 #include "dove_eye/inner_tracker.h"
 #include "dove_eye/location.h"
+#include "dove_eye/location_filter.h"
+#include "dove_eye/parameters.h"
 #include "dove_eye/positset.h"
 
 namespace dove_eye {
 
 /**
+ * Cameras are tracked by copies of InnerTrackerT. InnerTracker itself selects
+ * implementation at runtime (see Tracker), a final implementation class makes
+ * calls to inner trackers static (and inlinable) in single-tracker builds.
+ *
  * @note This class is not (intentionaly) thread safe, i.e. can be used in
  *       single thread only.
  */
-class Tracker {
+template <class InnerTrackerT>
+class BasicTracker {
  public:
-  explicit Tracker(const CameraIndex arity, const InnerTracker &inner_tracker);
+  enum TrackState {
+    kUninitialized,
+    kTracking,
+    kLost
+  };
+
+  /** Copy of tracker state (see SaveSnapshot) */
+  struct Snapshot;
+
+  BasicTracker(const CameraIndex arity, const InnerTrackerT &inner_tracker,
+               const Parameters &parameters);
+
+  inline CameraIndex Arity() const {
+    return arity_;
+  }
 
   Positset SetMark(const Frameset &frameset, const CameraIndex cam,
                const InnerTracker::Mark mark, bool project_other = false);
 
+  /** Feed location of the last tracked frameset back to the tracker
+   *
+   * Location is filtered in world space and its prediction is projected to
+   * each camera to guide the search.
+   */
   bool SetLocation(const Location location);
 
+  /** Drop the camera's track (e.g. it follows a distractor)
+   *
+   * The camera is re-acquired in the next frameset, preferably around the
+   * projection of the current location.
+   */
+  void Reacquire(const CameraIndex cam);
+
   Positset Track(const Frameset &frameset);
 
+  /** Capture current state, so that tracking can be resumed from it later
+   *
+   * @return  new snapshot (caller owns it) or nullptr when some inner
+   *          tracker doesn't support snapshots
+   */
+  Snapshot *SaveSnapshot() const;
+
+  /** Continue from saved state, snapshot can be restored repeatedly */
+  bool RestoreSnapshot(const Snapshot &snapshot);
+
+  inline TrackState track_state(const CameraIndex cam) const {
+    return trackstates_[cam];
+  }
+
+  /** Whether the camera's tracker has an appearance model to save */
+  bool HasModel(const CameraIndex cam) const;
+
+  bool SaveModel(const CameraIndex cam, ModelWriter *writer) const;
+
+  /** Warm start from stored appearance model
+   *
+   * Camera is considered lost, i.e. the object is searched for in the next
+   * frameset.
+   */
+  bool LoadModel(const CameraIndex cam, ModelReader *reader);
+
+  /** Scheduler deciding which cameras are tracked under CPU budget */
+  inline CameraScheduler &scheduler() {
+    return scheduler_;
+  }
+
+  /** Time of the last tracked frameset */
+  inline Frame::Timestamp time() const {
+    return time_;
+  }
+
   inline bool distorted_input() const {
     return distorted_input_;
   }
@@ -50,18 +121,19 @@ class Tracker {
     calibration_data_ = value;
   }
 
- private:
-  enum TrackState {
-    kUninitialized,
-    kTracking,
-    kLost
-  };
+  /** Prefix of tracker's keys in Metrics::Global() (e.g. "rig.name.") */
+  inline void metrics_prefix(const std::string &value) {
+    metrics_prefix_ = value;
+  }
 
+ private:
   typedef std::vector<TrackState> StateVector;
-  typedef std::unique_ptr<InnerTracker> InnerTrackerPtr;
+  typedef std::unique_ptr<InnerTrackerT> InnerTrackerPtr;
   typedef std::vector<InnerTrackerPtr> TrackerVector;
 
   const CameraIndex arity_;
+
+  const Parameters &parameters_;
   
   /** Output */
   Positset positset_;
@@ -76,8 +148,23 @@ class Tracker {
 
   Location location_;
   bool location_valid_;
+  LocationFilter location_filter_;
+
+  /** Time of the last tracked frameset */
+  Frame::Timestamp time_;
+
+  CameraScheduler scheduler_;
 
-  bool TrackSingle(const CameraIndex cam, const Frame &frame);
+  std::string metrics_prefix_;
+
+  bool TrackSingle(const CameraIndex cam, const Frame &frame,
+                   const bool use_prior);
+
+  bool CoastSingle(const CameraIndex cam, const Frame &frame);
+
+  bool LocationPredictable() const;
+
+  bool ProjectPrior(const CameraIndex cam, InnerTracker::Prior *prior) const;
 
   Point2 Undistort(const Point2 &point, const CameraIndex cam) const;
 
@@ -90,6 +177,30 @@ class Tracker {
 
 };
 
+template <class InnerTrackerT>
+struct BasicTracker<InnerTrackerT>::Snapshot {
+  Positset positset;
+  StateVector trackstates;
+  TrackerVector trackers;
+
+  Location location;
+  bool location_valid;
+  LocationFilter location_filter;
+
+  Frame::Timestamp time;
+
+  explicit Snapshot(const CameraIndex arity)
+      : positset(arity),
+        trackstates(arity),
+        trackers(arity),
+        location_valid(false),
+        time(0) {
+  }
+};
+
+/** Tracker with runtime selected inner tracker */
+typedef BasicTracker<InnerTracker> Tracker;
+
 } // namespace dove_eye
 
 #endif // DOVE_EYE_TRACKER_H_
@@ -33,7 +33,8 @@ class Tuple {
   explicit Tuple(const CameraIndex size = 0, const size_t sequence_no = 0)
       : sequence_no(sequence_no),
         arity_(size),
-        validity_() {
+        validity_(),
+        predicted_() {
     assert(arity_ <= kMaxArity);
   }
 
@@ -45,6 +46,7 @@ class Tuple {
     for (CameraIndex cam = 0; cam < arity_; ++cam) {
       items_[cam] = other.items_[cam];
       validity_[cam] = other.validity_[cam];
+      predicted_[cam] = other.predicted_[cam];
     }
   }
 
@@ -56,6 +58,7 @@ class Tuple {
     for (CameraIndex cam = 0; cam < arity_; ++cam) {
       items_[cam] = std::move(other.items_[cam]);
       validity_[cam] = other.validity_[cam];
+      predicted_[cam] = other.predicted_[cam];
     }
   }
 
@@ -71,6 +74,7 @@ class Tuple {
     std::swap(sequence_no, rhs.sequence_no);
     std::swap(items_, rhs.items_);
     std::swap(validity_, rhs.validity_);
+    std::swap(predicted_, rhs.predicted_);
 
     return *this;
   }
@@ -101,9 +105,11 @@ class Tuple {
     return items_ + arity_;
   }
 
+  /** Setting validity marks the item as observed (not predicted) */
   inline void SetValid(const CameraIndex cam, const bool value = true) {
     assert(cam < arity_);
     validity_[cam] = value;
+    predicted_[cam] = false;
   }
 
   inline bool IsValid(const CameraIndex cam) const {
@@ -111,6 +117,17 @@ class Tuple {
     return validity_[cam];
   }
 
+  /** Valid item is an estimate (e.g. coasted posit), not an observation */
+  inline void SetPredicted(const CameraIndex cam, const bool value = true) {
+    assert(cam < arity_);
+    predicted_[cam] = value;
+  }
+
+  inline bool IsPredicted(const CameraIndex cam) const {
+    assert(cam < arity_);
+    return validity_[cam] && predicted_[cam];
+  }
+
   inline CameraIndex ValidCount() const {
     CameraIndex result = 0;
     for (CameraIndex cam = 0; cam < arity_; ++cam) {
@@ -127,6 +144,7 @@ class Tuple {
   const CameraIndex arity_;
   T items_[kMaxArity];
   bool validity_[kMaxArity];
+  bool predicted_[kMaxArity];
 };
 
 } // namespace dove_eye
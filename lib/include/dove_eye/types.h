@@ -16,6 +16,9 @@ typedef cv::Vec3f Vector3;
 typedef std::vector<Point2> Point2Vector;
 typedef std::vector<Point3> Point3Vector;
 
+/** Indices of (calibration pattern) points */
+typedef std::vector<int> PointIdVector;
+
 typedef int CameraIndex;
 
 };
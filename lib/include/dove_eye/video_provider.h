@@ -26,6 +26,14 @@ class VideoProvider {
   virtual FrameIterator begin() = 0;
   virtual FrameIterator end() = 0;
 
+  /** Position iterators created by next begin() at given time
+   *
+   * @return  false when provider cannot seek (e.g. live stream)
+   */
+  virtual inline bool Seek(const Frame::Timestamp time) {
+    return false;
+  }
+
   inline bool undistort() const {
     return undistort_;
   }
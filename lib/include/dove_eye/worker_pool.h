@@ -0,0 +1,68 @@
+#ifndef DOVE_EYE_WORKER_POOL_H_
+#define DOVE_EYE_WORKER_POOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace dove_eye {
+
+/** Fixed set of threads executing submitted tasks in FIFO order
+ *
+ * Shared() pool is meant for short CPU bound work of providers (e.g.
+ * decoding), so that many cameras don't oversubscribe the cores.
+ */
+class WorkerPool {
+ public:
+  typedef std::function<void()> Task;
+
+  /** @param[in]  threads  0 means number of hardware threads */
+  explicit WorkerPool(const size_t threads = 0);
+
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  template <typename F>
+  std::future<typename std::result_of<F()>::type> Submit(F function) {
+    typedef typename std::result_of<F()>::type Result;
+
+    /* std::function needs copyable callable */
+    auto task = std::make_shared<std::packaged_task<Result()>>(
+        std::move(function));
+    auto future = task->get_future();
+    Enqueue([task]() { (*task)(); });
+    return future;
+  }
+
+  inline size_t size() const {
+    return threads_.size();
+  }
+
+  static WorkerPool &Shared();
+
+ private:
+  typedef std::unique_lock<std::mutex> Lock;
+
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::queue<Task> tasks_;
+  bool stop_;
+
+  std::vector<std::thread> threads_;
+
+  void Enqueue(Task task);
+
+  void Run();
+};
+
+} // namespace dove_eye
+
+#endif // DOVE_EYE_WORKER_POOL_H_
@@ -0,0 +1,478 @@
+#include "dove_eye/bundle_adjustment.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "dove_eye/logging.h"
+
+using std::vector;
+
+namespace {
+
+const int kPoseParams = 6;
+
+const double kInitialLambda = 1e-3;
+const double kMaxLambda = 1e9;
+/** Relative cost decrease considered as convergence */
+const double kMinImprovement = 1e-6;
+
+/** 3x1 vector of parameters at offset of the row */
+cv::Mat Vector3(const cv::Mat &params, const int offset) {
+  return (cv::Mat_<double>(3, 1) << params.at<double>(offset),
+                                    params.at<double>(offset + 1),
+                                    params.at<double>(offset + 2));
+}
+
+/** Marquardt damping, scaled by the diagonal */
+cv::Mat Damped(const cv::Mat &hessian, const double lambda) {
+  cv::Mat result = hessian.clone();
+  for (int i = 0; i < result.rows; ++i) {
+    result.at<double>(i, i) += lambda * hessian.at<double>(i, i);
+  }
+  return result;
+}
+
+} // namespace
+
+namespace dove_eye {
+
+struct BundleAdjustment::NormalEquations {
+  /* Blocks J^T J and gradients J^T r of cameras and views */
+  vector<cv::Mat> camera_hessian;
+  vector<cv::Mat> camera_gradient;
+  vector<cv::Mat> view_hessian;
+  vector<cv::Mat> view_gradient;
+  /** Blocks J_camera^T J_view, per view and its observation */
+  vector<vector<cv::Mat>> mixed;
+};
+
+BundleAdjustment::BundleAdjustment(const Point3Vector &object_points,
+                                   const bool refine_intrinsics)
+    : object_points_(object_points),
+      refine_intrinsics_(refine_intrinsics) {
+}
+
+void BundleAdjustment::AddView(const View &view) {
+  for (auto &observation : view) {
+    assert(observation.point_ids.empty() ?
+           observation.image_points.size() == object_points_.size() :
+           observation.image_points.size() == observation.point_ids.size());
+    (void) observation;
+  }
+  views_.push_back(view);
+}
+
+double BundleAdjustment::Solve(CameraVector *cameras,
+                               const int max_iterations) const {
+  assert(cameras);
+  const CameraIndex arity = cameras->size();
+  const int param_count = CameraParamCount();
+
+  if (arity < 2 || views_.empty()) {
+    return -1;
+  }
+
+  cv::Mat camera_params(arity, param_count, CV_64F);
+  for (CameraIndex cam = 0; cam < arity; ++cam) {
+    const auto &camera = (*cameras)[cam];
+    cv::Mat row = camera_params.row(cam);
+    cv::Mat rvec;
+    cv::Rodrigues(camera.rotation, rvec);
+    for (int i = 0; i < 3; ++i) {
+      row.at<double>(i) = rvec.at<double>(i);
+      row.at<double>(3 + i) = camera.translation.at<double>(i);
+    }
+
+    if (refine_intrinsics_) {
+      cv::Mat camera_matrix, distortion;
+      CameraModel(camera, cv::Mat(), &camera_matrix, &distortion);
+      row.at<double>(6) = camera_matrix.at<double>(0, 0);
+      row.at<double>(7) = camera_matrix.at<double>(1, 1);
+      row.at<double>(8) = camera_matrix.at<double>(0, 2);
+      row.at<double>(9) = camera_matrix.at<double>(1, 2);
+      row.at<double>(10) = distortion.at<double>(0);
+      row.at<double>(11) = distortion.at<double>(1);
+    }
+  }
+
+  cv::Mat view_params(views_.size(), kPoseParams, CV_64F);
+  if (!InitializeViews(*cameras, camera_params, &view_params)) {
+    return -1;
+  }
+
+  size_t point_count = 0;
+  for (auto &view : views_) {
+    for (auto &observation : view) {
+      point_count += observation.image_points.size();
+    }
+  }
+
+  double cost = Cost(*cameras, camera_params, view_params);
+  const double initial_cost = cost;
+
+  double lambda = kInitialLambda;
+  int iteration = 0;
+  for (; iteration < max_iterations; ++iteration) {
+    NormalEquations equations;
+    BuildNormalEquations(*cameras, camera_params, view_params, &equations);
+
+    bool improved = false;
+    double new_cost = cost;
+    for (; lambda < kMaxLambda; lambda *= 10) {
+      cv::Mat camera_step, view_step;
+      if (!SolveStep(equations, lambda, &camera_step, &view_step)) {
+        continue;
+      }
+
+      const cv::Mat new_camera_params = camera_params + camera_step;
+      const cv::Mat new_view_params = view_params + view_step;
+      new_cost = Cost(*cameras, new_camera_params, new_view_params);
+      if (new_cost < cost) {
+        camera_params = new_camera_params;
+        view_params = new_view_params;
+        lambda = std::max(lambda / 10, 1e-9);
+        improved = true;
+        break;
+      }
+    }
+
+    if (!improved) {
+      break;
+    }
+
+    const bool converged = (cost - new_cost) < kMinImprovement * cost;
+    cost = new_cost;
+    if (converged) {
+      break;
+    }
+  }
+
+  for (CameraIndex cam = 0; cam < arity; ++cam) {
+    auto &camera = (*cameras)[cam];
+    const cv::Mat row = camera_params.row(cam);
+
+    /* New matrices, inputs may share data with the caller's */
+    cv::Mat rotation;
+    cv::Rodrigues(Vector3(row, 0), rotation);
+    camera.rotation = rotation;
+    camera.translation = Vector3(row, 3);
+
+    if (refine_intrinsics_) {
+      cv::Mat camera_matrix, distortion;
+      CameraModel(camera, row, &camera_matrix, &distortion);
+      camera.camera_matrix = camera_matrix;
+      if (camera.distortion_coefficients.total() >= 2) {
+        /* Keep layout of the coefficients */
+        cv::Mat coefficients;
+        camera.distortion_coefficients.convertTo(coefficients, CV_64F);
+        coefficients.at<double>(0) = distortion.at<double>(0);
+        coefficients.at<double>(1) = distortion.at<double>(1);
+        camera.distortion_coefficients = coefficients;
+      } else {
+        camera.distortion_coefficients = distortion;
+      }
+    }
+  }
+
+  const double error = std::sqrt(cost / point_count);
+  DEBUG("Bundle adjustment of %i views, RMS error %f -> %f (%i iterations)",
+        static_cast<int>(views_.size()),
+        std::sqrt(initial_cost / point_count), error, iteration);
+  return error;
+}
+
+Point3Vector BundleAdjustment::ObjectPoints(
+    const Observation &observation) const {
+  if (observation.point_ids.empty()) {
+    return object_points_;
+  }
+
+  Point3Vector result;
+  result.reserve(observation.point_ids.size());
+  for (auto id : observation.point_ids) {
+    result.push_back(object_points_[id]);
+  }
+  return result;
+}
+
+void BundleAdjustment::CameraModel(const Camera &camera,
+                                   const cv::Mat &params,
+                                   cv::Mat *camera_matrix,
+                                   cv::Mat *distortion) const {
+  camera.camera_matrix.convertTo(*camera_matrix, CV_64F);
+
+  /* Jacobian of projectPoints has columns for k1, k2, p1, p2, k3 at least */
+  const int coefficients = std::max(5,
+      static_cast<int>(camera.distortion_coefficients.total()));
+  *distortion = cv::Mat::zeros(1, coefficients, CV_64F);
+  cv::Mat source;
+  camera.distortion_coefficients.convertTo(source, CV_64F);
+  for (size_t i = 0; i < source.total(); ++i) {
+    distortion->at<double>(i) = source.at<double>(i);
+  }
+
+  if (refine_intrinsics_ && params.cols > kPoseParams) {
+    camera_matrix->at<double>(0, 0) = params.at<double>(6);
+    camera_matrix->at<double>(1, 1) = params.at<double>(7);
+    camera_matrix->at<double>(0, 2) = params.at<double>(8);
+    camera_matrix->at<double>(1, 2) = params.at<double>(9);
+    distortion->at<double>(0) = params.at<double>(10);
+    distortion->at<double>(1) = params.at<double>(11);
+  }
+}
+
+void BundleAdjustment::Project(const Observation &observation,
+                               const Camera &camera,
+                               const cv::Mat &camera_params,
+                               const cv::Mat &view_params,
+                               cv::Mat *residuals,
+                               cv::Mat *camera_jacobian,
+                               cv::Mat *view_jacobian) const {
+  /* Pattern -> camera 0 (view pose) -> camera */
+  cv::Mat rvec, tvec;
+  cv::Mat dr3dr1, dr3dt1, dr3dr2, dr3dt2, dt3dr1, dt3dt1, dt3dr2, dt3dt2;
+  cv::composeRT(Vector3(view_params, 0), Vector3(view_params, 3),
+                Vector3(camera_params, 0), Vector3(camera_params, 3),
+                rvec, tvec,
+                dr3dr1, dr3dt1, dr3dr2, dr3dt2,
+                dt3dr1, dt3dt1, dt3dr2, dt3dt2);
+
+  cv::Mat camera_matrix, distortion;
+  CameraModel(camera, camera_params, &camera_matrix, &distortion);
+
+  const Point3Vector object_points = ObjectPoints(observation);
+  Point2Vector projected;
+  cv::Mat jacobian;
+  if (camera_jacobian) {
+    cv::projectPoints(object_points, rvec, tvec, camera_matrix, distortion,
+                      projected, jacobian);
+  } else {
+    cv::projectPoints(object_points, rvec, tvec, camera_matrix, distortion,
+                      projected);
+  }
+
+  const auto &image_points = observation.image_points;
+  assert(projected.size() == image_points.size());
+  residuals->create(2 * projected.size(), 1, CV_64F);
+  for (size_t i = 0; i < projected.size(); ++i) {
+    residuals->at<double>(2 * i) = projected[i].x - image_points[i].x;
+    residuals->at<double>(2 * i + 1) = projected[i].y - image_points[i].y;
+  }
+
+  if (!camera_jacobian) {
+    return;
+  }
+  assert(view_jacobian);
+
+  /* Chain rule through the pose composition */
+  const cv::Mat jr = jacobian.colRange(0, 3);
+  const cv::Mat jt = jacobian.colRange(3, 6);
+
+  view_jacobian->create(residuals->rows, kPoseParams, CV_64F);
+  cv::Mat(jr * dr3dr1 + jt * dt3dr1).copyTo(view_jacobian->colRange(0, 3));
+  cv::Mat(jr * dr3dt1 + jt * dt3dt1).copyTo(view_jacobian->colRange(3, 6));
+
+  camera_jacobian->create(residuals->rows, CameraParamCount(), CV_64F);
+  cv::Mat(jr * dr3dr2 + jt * dt3dr2).copyTo(camera_jacobian->colRange(0, 3));
+  cv::Mat(jr * dr3dt2 + jt * dt3dt2).copyTo(camera_jacobian->colRange(3, 6));
+  if (refine_intrinsics_) {
+    /* Focal lengths, principal point, k1 and k2 */
+    jacobian.colRange(6, 12).copyTo(camera_jacobian->colRange(6, 12));
+  }
+}
+
+double BundleAdjustment::Cost(const CameraVector &cameras,
+                              const cv::Mat &camera_params,
+                              const cv::Mat &view_params) const {
+  double cost = 0;
+  cv::Mat residuals;
+  for (size_t v = 0; v < views_.size(); ++v) {
+    for (auto &observation : views_[v]) {
+      const auto cam = observation.cam;
+      Project(observation, cameras[cam], camera_params.row(cam),
+              view_params.row(v), &residuals, nullptr, nullptr);
+      cost += residuals.dot(residuals);
+    }
+  }
+  return cost;
+}
+
+bool BundleAdjustment::InitializeViews(const CameraVector &cameras,
+                                       const cv::Mat &camera_params,
+                                       cv::Mat *view_params) const {
+  for (size_t v = 0; v < views_.size(); ++v) {
+    if (views_[v].empty()) {
+      return false;
+    }
+
+    /* Pattern pose seen by any camera, moved to camera 0 coordinates */
+    const auto &observation = views_[v].front();
+    const auto cam = observation.cam;
+    assert(cam < cameras.size());
+
+    cv::Mat camera_matrix, distortion;
+    CameraModel(cameras[cam], camera_params.row(cam), &camera_matrix,
+                &distortion);
+
+    cv::Mat rvec, tvec;
+    if (!cv::solvePnP(ObjectPoints(observation), observation.image_points,
+                      camera_matrix, distortion, rvec, tvec)) {
+      ERROR("Cannot estimate pattern pose in view %i", static_cast<int>(v));
+      return false;
+    }
+
+    cv::Mat rotation;
+    cv::Rodrigues(Vector3(camera_params.row(cam), 0), rotation);
+    const cv::Mat inverse_rotation = rotation.t();
+    const cv::Mat inverse_translation =
+        -inverse_rotation * Vector3(camera_params.row(cam), 3);
+    cv::Mat inverse_rvec;
+    cv::Rodrigues(inverse_rotation, inverse_rvec);
+
+    cv::Mat view_rvec, view_tvec;
+    cv::composeRT(rvec, tvec, inverse_rvec, inverse_translation,
+                  view_rvec, view_tvec);
+
+    cv::Mat row = view_params->row(v);
+    for (int i = 0; i < 3; ++i) {
+      row.at<double>(i) = view_rvec.at<double>(i);
+      row.at<double>(3 + i) = view_tvec.at<double>(i);
+    }
+  }
+
+  return true;
+}
+
+void BundleAdjustment::BuildNormalEquations(const CameraVector &cameras,
+                                            const cv::Mat &camera_params,
+                                            const cv::Mat &view_params,
+                                            NormalEquations *equations) const {
+  const CameraIndex arity = cameras.size();
+  const int param_count = CameraParamCount();
+
+  equations->camera_hessian.clear();
+  equations->camera_gradient.clear();
+  for (CameraIndex cam = 0; cam < arity; ++cam) {
+    equations->camera_hessian.push_back(
+        cv::Mat::zeros(param_count, param_count, CV_64F));
+    equations->camera_gradient.push_back(
+        cv::Mat::zeros(param_count, 1, CV_64F));
+  }
+
+  equations->view_hessian.resize(views_.size());
+  equations->view_gradient.resize(views_.size());
+  equations->mixed.resize(views_.size());
+
+  cv::Mat residuals, camera_jacobian, view_jacobian;
+  for (size_t v = 0; v < views_.size(); ++v) {
+    auto &view_hessian = equations->view_hessian[v];
+    auto &view_gradient = equations->view_gradient[v];
+    view_hessian = cv::Mat::zeros(kPoseParams, kPoseParams, CV_64F);
+    view_gradient = cv::Mat::zeros(kPoseParams, 1, CV_64F);
+    equations->mixed[v].clear();
+
+    for (auto &observation : views_[v]) {
+      const auto cam = observation.cam;
+      Project(observation, cameras[cam], camera_params.row(cam),
+              view_params.row(v), &residuals,
+              &camera_jacobian, &view_jacobian);
+
+      const cv::Mat camera_jacobian_t = camera_jacobian.t();
+      const cv::Mat view_jacobian_t = view_jacobian.t();
+
+      equations->camera_hessian[cam] += camera_jacobian_t * camera_jacobian;
+      equations->camera_gradient[cam] += camera_jacobian_t * residuals;
+      view_hessian += view_jacobian_t * view_jacobian;
+      view_gradient += view_jacobian_t * residuals;
+      equations->mixed[v].push_back(camera_jacobian_t * view_jacobian);
+    }
+  }
+}
+
+bool BundleAdjustment::SolveStep(const NormalEquations &equations,
+                                 const double lambda,
+                                 cv::Mat *camera_step,
+                                 cv::Mat *view_step) const {
+  const CameraIndex arity = equations.camera_hessian.size();
+  const int param_count = CameraParamCount();
+  const int size = arity * param_count;
+
+  auto block = [param_count](cv::Mat &m, const CameraIndex row,
+                             const CameraIndex col) -> cv::Mat {
+    return m(cv::Rect(col * param_count, row * param_count,
+                      param_count, param_count));
+  };
+  auto segment = [param_count](const cv::Mat &m,
+                               const CameraIndex cam) -> cv::Mat {
+    return m.rowRange(cam * param_count, (cam + 1) * param_count);
+  };
+
+  /* Reduced system S = U - W V^-1 W^T, b = -g_c + W V^-1 g_v */
+  cv::Mat reduced = cv::Mat::zeros(size, size, CV_64F);
+  cv::Mat rhs(size, 1, CV_64F);
+  for (CameraIndex cam = 0; cam < arity; ++cam) {
+    Damped(equations.camera_hessian[cam], lambda).copyTo(
+        block(reduced, cam, cam));
+    cv::Mat(-equations.camera_gradient[cam]).copyTo(segment(rhs, cam));
+  }
+
+  vector<cv::Mat> view_inverse(views_.size());
+  for (size_t v = 0; v < views_.size(); ++v) {
+    if (cv::invert(Damped(equations.view_hessian[v], lambda),
+                   view_inverse[v], cv::DECOMP_CHOLESKY) == 0) {
+      return false;
+    }
+
+    const auto &view = views_[v];
+    const auto &mixed = equations.mixed[v];
+    for (size_t o = 0; o < view.size(); ++o) {
+      const cv::Mat product = mixed[o] * view_inverse[v];
+      cv::Mat rhs_segment = segment(rhs, view[o].cam);
+      rhs_segment += product * equations.view_gradient[v];
+
+      for (size_t o2 = 0; o2 < view.size(); ++o2) {
+        cv::Mat reduced_block = block(reduced, view[o].cam, view[o2].cam);
+        reduced_block -= product * mixed[o2].t();
+      }
+    }
+  }
+
+  /* Camera 0 pose is fixed (gauge) */
+  for (int i = 0; i < kPoseParams; ++i) {
+    reduced.row(i).setTo(0);
+    reduced.col(i).setTo(0);
+    reduced.at<double>(i, i) = 1;
+    rhs.at<double>(i) = 0;
+  }
+  /* Parameters of cameras without any observation stay too */
+  for (int i = 0; i < size; ++i) {
+    if (reduced.at<double>(i, i) <= 0) {
+      reduced.at<double>(i, i) = 1;
+    }
+  }
+
+  cv::Mat camera_solution;
+  if (!cv::solve(reduced, rhs, camera_solution, cv::DECOMP_CHOLESKY)) {
+    return false;
+  }
+  *camera_step = camera_solution.reshape(1, arity);
+
+  /* Back substitution, step_v = V^-1 (-g_v - W^T step_c) */
+  view_step->create(views_.size(), kPoseParams, CV_64F);
+  for (size_t v = 0; v < views_.size(); ++v) {
+    cv::Mat view_rhs = -equations.view_gradient[v];
+    const auto &view = views_[v];
+    for (size_t o = 0; o < view.size(); ++o) {
+      view_rhs -= equations.mixed[v][o].t() *
+          segment(camera_solution, view[o].cam);
+    }
+    cv::Mat(view_inverse[v] * view_rhs).reshape(1, 1).copyTo(
+        view_step->row(v));
+  }
+
+  return true;
+}
+
+} // namespace dove_eye
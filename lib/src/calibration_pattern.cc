@@ -0,0 +1,36 @@
+#include "dove_eye/calibration_pattern.h"
+
+#include <cassert>
+
+namespace dove_eye {
+
+bool CalibrationPattern::MatchPartial(const cv::Mat &image,
+                                      Point2Vector *points,
+                                      PointIdVector *ids) const {
+  assert(ids);
+
+  ids->clear();
+  if (!Match(image, points)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < points->size(); ++i) {
+    ids->push_back(i);
+  }
+  return true;
+}
+
+Point3Vector CalibrationPattern::SelectObjectPoints(
+    const PointIdVector &ids) const {
+  const auto &all_points = ObjectPoints();
+
+  Point3Vector result;
+  result.reserve(ids.size());
+  for (auto id : ids) {
+    assert(id >= 0 && static_cast<size_t>(id) < all_points.size());
+    result.push_back(all_points[id]);
+  }
+  return result;
+}
+
+} // namespace dove_eye
@@ -0,0 +1,30 @@
+#include "dove_eye/calibration_pattern_factory.h"
+
+#include "config.h"
+#ifdef CONFIG_CHARUCO
+#include "dove_eye/charuco_pattern.h"
+#endif
+#include "dove_eye/chessboard_pattern.h"
+#include "dove_eye/logging.h"
+
+namespace dove_eye {
+
+CalibrationPattern *CreateCalibrationPattern(const Parameters &parameters) {
+  const int rows = parameters.Get(Parameters::CALIBRATION_ROWS);
+  const int columns = parameters.Get(Parameters::CALIBRATION_COLS);
+  const double size = parameters.Get(Parameters::CALIBRATION_SIZE);
+
+  if (parameters.Get(Parameters::CALIBRATION_PATTERN) == 1) {
+#ifdef CONFIG_CHARUCO
+    const double marker_size =
+        size * parameters.Get(Parameters::CALIBRATION_MARKER_RATIO);
+    return new CharucoPattern(rows, columns, size, marker_size);
+#else
+    ERROR("ChArUco pattern is not available, using chessboard");
+#endif
+  }
+
+  return new ChessboardPattern(rows, columns, size);
+}
+
+} // namespace dove_eye
@@ -0,0 +1,145 @@
+#include "dove_eye/calibration_storage.h"
+
+#include <cassert>
+
+#include <opencv2/opencv.hpp>
+
+#include "dove_eye/camera_pair.h"
+#include "dove_eye/logging.h"
+#include "dove_eye/types.h"
+
+using cv::FileStorage;
+using cv::FileNode;
+
+namespace dove_eye {
+
+const char *CalibrationStorage::kNameArity = "arity";
+const char *CalibrationStorage::kNameCameraMatrix = "C";
+const char *CalibrationStorage::kNameDistortionCoefficients = "D";
+const char *CalibrationStorage::kNameFundamentalMatrix = "F";
+const char *CalibrationStorage::kNamePairRotation = "R";
+const char *CalibrationStorage::kNamePosition = "position";
+const char *CalibrationStorage::kNameRotation = "rotation";
+const char *CalibrationStorage::kNameTranslation = "T";
+
+bool CalibrationStorage::LoadFromFile(const std::string &filename,
+                                      CalibrationData *result) {
+  assert(result);
+
+  FileStorage fs(filename, FileStorage::READ);
+  if (!fs.isOpened()) {
+    ERROR("Cannot open calibration file %s", filename.c_str());
+    return false;
+  }
+
+  int arity_value = 0;
+  fs[kNameArity] >> arity_value;
+  if (arity_value <= 0) {
+    ERROR("Invalid calibration file %s", filename.c_str());
+    return false;
+  }
+
+  const CameraIndex arity = arity_value;
+  const CameraIndex pairity = CameraPair::Pairity(arity);
+  CalibrationData data(arity);
+
+  cv::Mat tmp;
+  fs[kNamePosition] >> tmp;
+  data.position(tmp);
+
+  fs[kNameRotation] >> tmp;
+  data.rotation(tmp);
+
+  auto node = fs[kNameCameraMatrix];
+  assert(node.type() == FileNode::SEQ);
+
+  CameraIndex cam = 0;
+  for (auto file_node : node) {
+    assert(cam < arity);
+    file_node >> data.camera_parameters_[cam].camera_matrix;
+    ++cam;
+  }
+
+  node = fs[kNameDistortionCoefficients];
+  cam = 0;
+  for (auto file_node : node) {
+    assert(cam < arity);
+    file_node >> data.camera_parameters_[cam].distortion_coefficients;
+    ++cam;
+  }
+
+  node = fs[kNameFundamentalMatrix];
+  CameraIndex index = 0;
+  for (auto file_node : node) {
+    assert(index < pairity);
+    file_node >> data.pair_parameters_[index].fundamental_matrix;
+    ++index;
+  }
+
+  node = fs[kNamePairRotation];
+  index = 0;
+  for (auto file_node : node) {
+    assert(index < pairity);
+    file_node >> data.pair_parameters_[index].rotation;
+    ++index;
+  }
+
+  node = fs[kNameTranslation];
+  index = 0;
+  for (auto file_node : node) {
+    assert(index < pairity);
+    file_node >> data.pair_parameters_[index].translation;
+    ++index;
+  }
+
+  *result = data;
+  return true;
+}
+
+bool CalibrationStorage::SaveToFile(const std::string &filename,
+                                    const CalibrationData &data) {
+  FileStorage fs(filename, FileStorage::WRITE);
+  if (!fs.isOpened()) {
+    ERROR("Cannot open calibration file %s", filename.c_str());
+    return false;
+  }
+
+  fs << kNameArity << static_cast<int>(data.Arity());
+  fs << kNamePosition << data.position();
+  fs << kNameRotation << data.rotation();
+
+  fs << kNameCameraMatrix << "[";
+  for (CameraIndex cam = 0; cam < data.Arity(); ++cam) {
+    fs << data.camera_parameters(cam).camera_matrix;
+  }
+  fs << "]";
+
+  fs << kNameDistortionCoefficients << "[";
+  for (CameraIndex cam = 0; cam < data.Arity(); ++cam) {
+    fs << data.camera_parameters(cam).distortion_coefficients;
+  }
+  fs << "]";
+
+  const CameraIndex pairity = CameraPair::Pairity(data.Arity());
+  fs << kNameFundamentalMatrix << "[";
+  for (CameraIndex index = 0; index < pairity; ++index) {
+    fs << data.pair_parameters(index).fundamental_matrix;
+  }
+  fs << "]";
+
+  fs << kNamePairRotation << "[";
+  for (CameraIndex index = 0; index < pairity; ++index) {
+    fs << data.pair_parameters(index).rotation;
+  }
+  fs << "]";
+
+  fs << kNameTranslation << "[";
+  for (CameraIndex index = 0; index < pairity; ++index) {
+    fs << data.pair_parameters(index).translation;
+  }
+  fs << "]";
+
+  return true;
+}
+
+} // namespace dove_eye
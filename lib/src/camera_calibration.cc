@@ -1,6 +1,9 @@
 #include "dove_eye/camera_calibration.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cfloat>
+#include <cmath>
 #include <vector>
 
 #include "dove_eye/logging.h"
@@ -12,6 +15,31 @@ using std::vector;
 
 namespace dove_eye {
 
+namespace {
+
+/** Fewer points of partially visible pattern don't constrain the pose */
+const size_t kMinViewPoints = 6;
+
+/** Partial view is usable when its (planar) points aren't collinear */
+bool IsUsableView(const Point3Vector &object_points) {
+  if (object_points.size() < kMinViewPoints) {
+    return false;
+  }
+
+  const auto &origin = object_points.front();
+  const auto direction = object_points[1] - origin;
+  for (auto &point : object_points) {
+    const auto offset = point - origin;
+    if (std::fabs(direction.x * offset.y - direction.y * offset.x) >
+        FLT_EPSILON) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
 CameraCalibration::CameraCalibration(const Parameters &parameters,
                                      const CameraIndex arity,
                                      CalibrationPattern const *pattern)
@@ -42,20 +70,22 @@ bool CameraCalibration::MeasureFrameset(const Frameset &frameset) {
     }
 
     Point2Vector image_points;
+    PointIdVector ids;
 
     switch (camera_states_[cam]) {
       case kUnitialized:
       case kCollecting:
-        if (pattern_->Match(frameset[cam].data, &image_points)) {
-          image_points_[cam].push_back(image_points);
-          camera_states_[cam] = kCollecting;
+        if (pattern_->MatchPartial(frameset[cam].data, &image_points, &ids)) {
+          auto object_points = pattern_->SelectObjectPoints(ids);
+          if (IsUsableView(object_points)) {
+            image_points_[cam].push_back(image_points);
+            object_points_[cam].push_back(object_points);
+            camera_states_[cam] = kCollecting;
+          }
         }
 
         if (image_points_[cam].size() >= frames_to_collect_) {
-          vector<Point3Vector> object_points(image_points_[cam].size(),
-              pattern_->ObjectPoints());
-
-          auto error = calibrateCamera(object_points, image_points_[cam],
+          auto error = calibrateCamera(object_points_[cam], image_points_[cam],
               frameset[cam].data.size(),
               data_.camera_parameters_[cam].camera_matrix,
               data_.camera_parameters_[cam].distortion_coefficients,
@@ -64,6 +94,7 @@ bool CameraCalibration::MeasureFrameset(const Frameset &frameset) {
 
           camera_states_[cam] = kReady;
           image_points_[cam].clear(); /* Not needed anymore */
+          object_points_[cam].clear();
         }
 
         result = false;
@@ -76,6 +107,21 @@ bool CameraCalibration::MeasureFrameset(const Frameset &frameset) {
     }
   }
 
+  /* Pattern is searched at most once per camera in the frameset */
+  vector<Point2Vector> view_points(arity_);
+  vector<PointIdVector> view_ids(arity_);
+  vector<bool> searched(arity_, false);
+  vector<bool> found(arity_, false);
+  auto match = [&](const CameraIndex cam) -> bool {
+    if (!searched[cam]) {
+      searched[cam] = true;
+      found[cam] = pattern_->MatchPartial(frameset[cam].data,
+                                          &view_points[cam], &view_ids[cam]) &&
+          IsUsableView(pattern_->SelectObjectPoints(view_ids[cam]));
+    }
+    return found[cam];
+  };
+
   for (auto pair : pairs_) {
     auto cam1 = pair.cam1;
     auto cam2 = pair.cam2;
@@ -89,31 +135,42 @@ bool CameraCalibration::MeasureFrameset(const Frameset &frameset) {
       continue;
     }
 
-    Point2Vector image_points1, image_points2;
-    cv::Mat dummy_R, dummy_T;
     size_t collected;
 
     switch (pair_states_[pair.index]) {
       case kUnitialized:
       case kCollecting:
-        if (pattern_->Match(frameset[cam1].data, &image_points1) &&
-            pattern_->Match(frameset[cam2].data, &image_points2)) {
-          image_points_pair_[pair.index].first.push_back(image_points1);
-          image_points_pair_[pair.index].second.push_back(image_points2);
-
-          pair_states_[pair.index] = kCollecting;
+        if (match(cam1) && match(cam2)) {
+          /* Partial views, only points seen by both cameras */
+          Point2Vector image_points1, image_points2;
+          PointIdVector common_ids;
+          for (size_t i = 0; i < view_ids[cam1].size(); ++i) {
+            const auto &ids2 = view_ids[cam2];
+            const auto it = std::find(ids2.begin(), ids2.end(),
+                                      view_ids[cam1][i]);
+            if (it != ids2.end()) {
+              image_points1.push_back(view_points[cam1][i]);
+              image_points2.push_back(view_points[cam2][it - ids2.begin()]);
+              common_ids.push_back(*it);
+            }
+          }
+
+          auto object_points = pattern_->SelectObjectPoints(common_ids);
+          if (IsUsableView(object_points)) {
+            image_points_pair_[pair.index].first.push_back(image_points1);
+            image_points_pair_[pair.index].second.push_back(image_points2);
+            object_points_pair_[pair.index].push_back(object_points);
+            pair_states_[pair.index] = kCollecting;
+          }
         }
 
         /* We add points in lockstep, this checking only first of pair */
         collected = image_points_pair_[pair.index].first.size();
         if (collected >= frames_to_collect_) {
           DEBUG("Calibrating pair %i, %i", cam1, cam2);
-          vector<Point3Vector> object_points(
-              collected,
-              pattern_->ObjectPoints());
 
           // FIXME Getting size more centrally probably.
-          auto error = stereoCalibrate(object_points,
+          auto error = stereoCalibrate(object_points_pair_[pair.index],
               image_points_pair_[pair.index].first,
               image_points_pair_[pair.index].second,
               data_.camera_parameters_[cam1].camera_matrix,
@@ -132,6 +189,7 @@ bool CameraCalibration::MeasureFrameset(const Frameset &frameset) {
           pair_states_[pair.index] = kReady;
           image_points_pair_[pair.index].first.clear();
           image_points_pair_[pair.index].second.clear();
+          object_points_pair_[pair.index].clear();
         }
 
         result = false;
@@ -144,6 +202,22 @@ bool CameraCalibration::MeasureFrameset(const Frameset &frameset) {
     }
   }
 
+  BundleAdjustment::View view;
+  for (CameraIndex cam = 0; cam < arity_; ++cam) {
+    if (found[cam]) {
+      view.push_back({cam, view_points[cam], view_ids[cam]});
+    }
+  }
+  if (view.size() >= 2) {
+    views_.push_back(view);
+  }
+
+  /* Last pair calibrated */
+  if (result && !views_.empty()) {
+    AdjustBundle();
+    views_.clear();
+  }
+
   return result;
 }
 
@@ -153,9 +227,13 @@ void CameraCalibration::Reset() {
   frame_no_ = 0;
   
   image_points_ = decltype(image_points_)(arity_);
+  object_points_ = decltype(object_points_)(arity_);
   image_points_pair_ = decltype(image_points_pair_)(CameraPair::Pairity(arity_));
+  object_points_pair_ =
+      decltype(object_points_pair_)(CameraPair::Pairity(arity_));
   camera_states_ = decltype(camera_states_)(arity_, kUnitialized);
   pair_states_ = decltype(pair_states_)(CameraPair::Pairity(arity_), kUnitialized);
+  views_.clear();
 }
 
 double CameraCalibration::CameraProgress(const CameraIndex cam) const {
@@ -192,4 +270,81 @@ double CameraCalibration::PairProgress(const CameraIndex index) const {
   assert(false); return 0;
 }
 
+/**
+ * Pairs are calibrated independently and CalibrationData derives camera
+ * poses from pairs with camera 0 only, so their errors don't average out.
+ * All views from pair calibration are used to refine camera poses (and
+ * intrinsics) jointly and pair parameters are replaced by consistent ones.
+ */
+void CameraCalibration::AdjustBundle() {
+  const int mode = parameters_.Get(Parameters::CALIBRATION_BUNDLE);
+  if (mode == 0 || arity_ < 2) {
+    return;
+  }
+
+  BundleAdjustment adjustment(pattern_->ObjectPoints(), mode > 1);
+  for (auto &view : views_) {
+    adjustment.AddView(view);
+  }
+
+  BundleAdjustment::CameraVector cameras(arity_);
+  for (CameraIndex cam = 0; cam < arity_; ++cam) {
+    auto &camera = cameras[cam];
+    const auto &parameters = data_.camera_parameters_[cam];
+    camera.camera_matrix = parameters.camera_matrix.clone();
+    camera.distortion_coefficients = parameters.distortion_coefficients.clone();
+
+    if (cam == 0) {
+      camera.rotation = cv::Mat::eye(3, 3, CV_64F);
+      camera.translation = cv::Mat::zeros(3, 1, CV_64F);
+    } else {
+      const auto index = CameraPair::Index(arity_, 0, cam);
+      camera.rotation = data_.pair_parameters_[index].rotation.clone();
+      camera.translation = data_.pair_parameters_[index].translation.clone();
+    }
+  }
+
+  const auto error = adjustment.Solve(&cameras);
+  if (error < 0) {
+    ERROR("Bundle adjustment failed, keeping pairwise calibration");
+    return;
+  }
+
+  for (CameraIndex cam = 0; cam < arity_; ++cam) {
+    data_.camera_parameters_[cam].camera_matrix = cameras[cam].camera_matrix;
+    data_.camera_parameters_[cam].distortion_coefficients =
+        cameras[cam].distortion_coefficients;
+  }
+
+  for (auto pair : pairs_) {
+    const auto &camera1 = cameras[pair.cam1];
+    const auto &camera2 = cameras[pair.cam2];
+    auto &pair_parameters = data_.pair_parameters_[pair.index];
+
+    /* X2 = R X1 + T (as from stereoCalibrate) */
+    const cv::Mat rotation = camera2.rotation * camera1.rotation.t();
+    const cv::Mat translation =
+        camera2.translation - rotation * camera1.translation;
+
+    const double tx = translation.at<double>(0);
+    const double ty = translation.at<double>(1);
+    const double tz = translation.at<double>(2);
+    const cv::Mat cross = (cv::Mat_<double>(3, 3) << 0, -tz, ty,
+                                                     tz, 0, -tx,
+                                                     -ty, tx, 0);
+    cv::Mat fundamental = camera2.camera_matrix.inv().t() * cross * rotation *
+        camera1.camera_matrix.inv();
+    /* Same scale as from stereoCalibrate */
+    if (std::fabs(fundamental.at<double>(2, 2)) > DBL_EPSILON) {
+      fundamental /= fundamental.at<double>(2, 2);
+    }
+
+    pair_parameters.rotation = rotation;
+    pair_parameters.translation = translation;
+    pair_parameters.fundamental_matrix = fundamental;
+  }
+
+  data_.globals_initialized_ = false;
+}
+
 } // namespace dove_eye
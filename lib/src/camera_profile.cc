@@ -0,0 +1,155 @@
+#include "dove_eye/camera_profile.h"
+
+#include <cassert>
+
+#include <opencv2/opencv.hpp>
+
+#include "dove_eye/logging.h"
+
+using cv::FileNode;
+using cv::FileStorage;
+
+namespace dove_eye {
+
+namespace {
+
+/** Frame rate tolerance of sustained mode */
+const double kSustainedRatio = 0.9;
+
+/** Frame rates within this ratio are equal for mode selection */
+const double kFpsTolerance = 0.05;
+
+} // namespace
+
+bool CameraMode::Sustained() const {
+  return measured_fps > 0 &&
+      (fps <= 0 || measured_fps >= kSustainedRatio * fps);
+}
+
+std::string CameraMode::FourccToString(const uint32_t fourcc) {
+  if (fourcc == 0) {
+    return "";
+  }
+
+  std::string result(4, ' ');
+  for (int i = 0; i < 4; ++i) {
+    result[i] = static_cast<char>((fourcc >> (8 * i)) & 0xff);
+  }
+  return result;
+}
+
+uint32_t CameraMode::StringToFourcc(const std::string &value) {
+  if (value.size() != 4) {
+    return 0;
+  }
+  return CV_FOURCC(value[0], value[1], value[2], value[3]);
+}
+
+const char *CameraProfile::kNameDevices = "devices";
+const char *CameraProfile::kNameDevice = "device";
+const char *CameraProfile::kNameModes = "modes";
+
+bool CameraProfile::BestMode(const int device, const int width,
+                             const int height, CameraMode *result,
+                             const uint32_t fourcc) const {
+  assert(result);
+
+  const CameraMode *best = nullptr;
+  for (auto &mode : modes(device)) {
+    if (mode.width != width || mode.height != height || !mode.Sustained() ||
+        (fourcc != 0 && mode.fourcc != fourcc)) {
+      continue;
+    }
+
+    if (!best ||
+        mode.measured_fps > (1 + kFpsTolerance) * best->measured_fps ||
+        (mode.measured_fps >= (1 - kFpsTolerance) * best->measured_fps &&
+         mode.latency + mode.cpu < best->latency + best->cpu)) {
+      best = &mode;
+    }
+  }
+
+  if (!best) {
+    return false;
+  }
+  *result = *best;
+  return true;
+}
+
+bool CameraProfile::LoadFromFile(const std::string &filename,
+                                 CameraProfile *result) {
+  assert(result);
+
+  FileStorage fs(filename, FileStorage::READ);
+  if (!fs.isOpened()) {
+    ERROR("Cannot open camera profile %s", filename.c_str());
+    return false;
+  }
+
+  auto node = fs[kNameDevices];
+  if (node.type() != FileNode::SEQ) {
+    ERROR("Invalid camera profile %s", filename.c_str());
+    return false;
+  }
+
+  CameraProfile profile;
+  for (auto device_node : node) {
+    int device = -1;
+    device_node[kNameDevice] >> device;
+
+    for (auto mode_node : device_node[kNameModes]) {
+      CameraMode mode;
+      std::string fourcc;
+      mode_node["width"] >> mode.width;
+      mode_node["height"] >> mode.height;
+      mode_node["fourcc"] >> fourcc;
+      mode.fourcc = CameraMode::StringToFourcc(fourcc);
+      mode_node["fps"] >> mode.fps;
+      mode_node["measured_fps"] >> mode.measured_fps;
+      mode_node["latency"] >> mode.latency;
+      mode_node["jitter"] >> mode.jitter;
+      mode_node["cpu"] >> mode.cpu;
+
+      profile.AddMode(device, mode);
+    }
+  }
+
+  *result = profile;
+  return true;
+}
+
+bool CameraProfile::SaveToFile(const std::string &filename,
+                               const CameraProfile &profile) {
+  FileStorage fs(filename, FileStorage::WRITE);
+  if (!fs.isOpened()) {
+    ERROR("Cannot open camera profile %s", filename.c_str());
+    return false;
+  }
+
+  fs << kNameDevices << "[";
+  for (auto &device : profile.devices_) {
+    fs << "{" << kNameDevice << device.first;
+
+    fs << kNameModes << "[";
+    for (auto &mode : device.second) {
+      fs << "{";
+      fs << "width" << mode.width;
+      fs << "height" << mode.height;
+      fs << "fourcc" << CameraMode::FourccToString(mode.fourcc);
+      fs << "fps" << mode.fps;
+      fs << "measured_fps" << mode.measured_fps;
+      fs << "latency" << mode.latency;
+      fs << "jitter" << mode.jitter;
+      fs << "cpu" << mode.cpu;
+      fs << "}";
+    }
+    fs << "]";
+
+    fs << "}";
+  }
+  fs << "]";
+
+  return true;
+}
+
+} // namespace dove_eye
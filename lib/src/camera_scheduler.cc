@@ -0,0 +1,102 @@
+#include "dove_eye/camera_scheduler.h"
+
+#include <algorithm>
+
+#include "dove_eye/logging.h"
+
+namespace {
+
+/** Weight of the newest sample in cost average */
+const double kCostSmoothing = 0.2;
+
+/** Localization needs at least two posits, never starve it */
+const dove_eye::CameraIndex kMinTracked = 2;
+
+/** Urgency of the most confident tracker (so that it's not starved) */
+const double kMinUrgency = 0.1;
+
+} // namespace
+
+namespace dove_eye {
+
+CameraScheduler::CameraScheduler(const CameraIndex arity,
+                                 const Parameters &parameters)
+    : arity_(arity),
+      parameters_(parameters),
+      cameras_(arity_),
+      selection_(arity_, true),
+      order_(arity_) {
+}
+
+const CameraScheduler::Selection &CameraScheduler::Schedule() {
+  const double budget = parameters_.Get(Parameters::TRACK_BUDGET) / 1000;
+
+  if (budget <= 0) {
+    selection_.assign(arity_, true);
+    for (auto &camera : cameras_) {
+      camera.skipped = 0;
+    }
+    return selection_;
+  }
+
+  for (CameraIndex cam = 0; cam < arity_; ++cam) {
+    order_[cam] = cam;
+  }
+  std::stable_sort(order_.begin(), order_.end(),
+                   [this](const CameraIndex lhs, const CameraIndex rhs) {
+                     return Priority(lhs) > Priority(rhs);
+                   });
+
+  selection_.assign(arity_, false);
+  double total_cost = 0;
+  CameraIndex selected = 0;
+  for (auto cam : order_) {
+    const double cost = cameras_[cam].cost;
+    if (selected >= kMinTracked && total_cost + cost > budget) {
+      continue;
+    }
+
+    selection_[cam] = true;
+    total_cost += cost;
+    ++selected;
+  }
+
+  for (CameraIndex cam = 0; cam < arity_; ++cam) {
+    if (selection_[cam]) {
+      cameras_[cam].skipped = 0;
+    } else {
+      ++cameras_[cam].skipped;
+      DEBUG("camera %i skipped (%i)", cam,
+            static_cast<int>(cameras_[cam].skipped));
+    }
+  }
+
+  return selection_;
+}
+
+void CameraScheduler::Report(const CameraIndex cam, const bool success,
+                             const double cost) {
+  assert(cam < arity_);
+  auto &camera = cameras_[cam];
+
+  /* Unknown cost is zero, so that first sample is taken as is */
+  if (camera.cost <= 0) {
+    camera.cost = cost;
+  } else {
+    camera.cost += kCostSmoothing * (cost - camera.cost);
+  }
+
+  camera.success_streak = success ? camera.success_streak + 1 : 0;
+}
+
+double CameraScheduler::Priority(const CameraIndex cam) const {
+  const auto &camera = cameras_[cam];
+
+  /* Confident tracker coasts well on prediction, uncertain one does not */
+  const double confidence = 1 - 1.0 / (1 + camera.success_streak);
+  const double urgency = std::max(kMinUrgency, 1 - confidence);
+
+  return camera.value * urgency * (1 + camera.skipped);
+}
+
+} // namespace dove_eye
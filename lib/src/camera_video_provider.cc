@@ -1,31 +1,65 @@
 #include "dove_eye/camera_video_provider.h"
 
+#include <algorithm>
 #include <sstream>
 
+#include "config.h"
 #include "dove_eye/cv_frame_iterator.h"
 #include "dove_eye/frame_iterator/clock_policy.h"
 #include "dove_eye/frame_iterator/nonblocking_policy.h"
+#include "dove_eye/logging.h"
+#ifdef CONFIG_MJPEG
+#include "dove_eye/mjpeg_frame_iterator.h"
+#endif
 
 namespace dove_eye {
 
 /* Provider */
 CameraVideoProvider::CameraVideoProvider(const int device)
     : VideoProvider(),
-      device_(device) {
+      device_(device),
+      profile_(nullptr),
+      mjpeg_(false) {
   std::stringstream ss;
   ss << "Device " << device;
   id_ = ss.str();
 }
 
 FrameIterator CameraVideoProvider::begin() {
+#ifdef CONFIG_MJPEG
+  if (mjpeg_) {
+    CameraMode mode;
+    const bool profiled = profile_ &&
+        profile_->BestMode(device_, resolution_.width, resolution_.height,
+                           &mode, CameraMode::StringToFourcc("MJPG"));
+
+    auto mjpeg_iterator = new MjpegFrameIterator(
+        device_, resolution_.width, resolution_.height,
+        profiled ? mode.fps : 0, mjpeg_options_);
+    if (mjpeg_iterator->IsValid()) {
+      return FrameIterator(this, mjpeg_iterator);
+    }
+
+    delete mjpeg_iterator;
+    ERROR("%s: MJPEG capture failed, using OpenCV capture", id_.c_str());
+  }
+#else
+  if (mjpeg_) {
+    ERROR("%s: MJPEG capture not available, using OpenCV capture",
+          id_.c_str());
+  }
+#endif
+
   typedef CvFrameIterator<frame_iterator::ClockPolicy,
                           frame_iterator::NonblockingPolicy> CvIterator;
 
   auto cv_iterator = new CvIterator(device_);
 
   /* Apply settings */
-  if (resolution_.width > 0 && resolution_.height > 0) {
-    auto &capture = cv_iterator->CvVideoCapture();
+  auto &capture = cv_iterator->CvVideoCapture();
+  if (profile_) {
+    ApplyProfile(&capture);
+  } else if (resolution_.width > 0 && resolution_.height > 0) {
     capture.set(CV_CAP_PROP_FRAME_WIDTH, resolution().width);
     capture.set(CV_CAP_PROP_FRAME_HEIGHT, resolution().height);
   }
@@ -39,6 +73,21 @@ FrameIterator CameraVideoProvider::end() {
 
 CameraVideoProvider::ResolutionVector
 CameraVideoProvider::AvailableResolutions() const {
+  if (profile_ && !profile_->modes(device_).empty()) {
+    ResolutionVector result;
+    for (auto &mode : profile_->modes(device_)) {
+      auto same = [&mode](const Resolution &r) {
+        return r.width == static_cast<size_t>(mode.width) &&
+            r.height == static_cast<size_t>(mode.height);
+      };
+      if (mode.Sustained() &&
+          std::none_of(result.begin(), result.end(), same)) {
+        result.push_back(Resolution(mode.width, mode.height));
+      }
+    }
+    return result;
+  }
+
   /*
    * OpenCV API doesn't allow access to available resolutions, so just use some
    * most common values.
@@ -52,4 +101,33 @@ CameraVideoProvider::AvailableResolutions() const {
   };
 }
 
+/** Switch to the best profiled mode of desired (or current) resolution */
+void CameraVideoProvider::ApplyProfile(cv::VideoCapture *capture) const {
+  Resolution target = resolution_;
+  if (target.width == 0 || target.height == 0) {
+    target = Resolution(capture->get(CV_CAP_PROP_FRAME_WIDTH),
+                        capture->get(CV_CAP_PROP_FRAME_HEIGHT));
+  }
+
+  CameraMode mode;
+  if (!profile_->BestMode(device_, target.width, target.height, &mode)) {
+    DEBUG("%s: no profiled mode for %zux%zu", id_.c_str(), target.width,
+          target.height);
+    mode = CameraMode(target.width, target.height);
+  }
+
+  /* Format first, some backends reset size when it changes */
+  if (mode.fourcc != 0) {
+    capture->set(CV_CAP_PROP_FOURCC, mode.fourcc);
+  }
+  capture->set(CV_CAP_PROP_FRAME_WIDTH, mode.width);
+  capture->set(CV_CAP_PROP_FRAME_HEIGHT, mode.height);
+  if (mode.fps > 0) {
+    capture->set(CV_CAP_PROP_FPS, mode.fps);
+  }
+
+  DEBUG("%s: mode %dx%d %s @%g fps", id_.c_str(), mode.width, mode.height,
+        CameraMode::FourccToString(mode.fourcc).c_str(), mode.fps);
+}
+
 } // namespace dove_eye
@@ -0,0 +1,58 @@
+#include "dove_eye/charuco_pattern.h"
+
+#include <cassert>
+#include <vector>
+
+namespace dove_eye {
+
+CharucoPattern::CharucoPattern(const int rows, const int columns,
+                               const double square_size,
+                               const double marker_size)
+    /* Enough markers for the largest board (CALIBRATION_ROWS/COLS) */
+    : dictionary_(cv::aruco::getPredefinedDictionary(
+            cv::aruco::DICT_4X4_100)) {
+  assert(marker_size < square_size);
+
+  board_ = cv::aruco::CharucoBoard::create(columns + 1, rows + 1, square_size,
+                                           marker_size, dictionary_);
+  object_points_ = board_->chessboardCorners;
+}
+
+bool CharucoPattern::Match(const cv::Mat &image, Point2Vector *points) const {
+  Point2Vector found_points;
+  PointIdVector ids;
+  if (!MatchPartial(image, &found_points, &ids) ||
+      ids.size() != object_points_.size()) {
+    return false;
+  }
+
+  /* Order of object points */
+  points->resize(object_points_.size());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    (*points)[ids[i]] = found_points[i];
+  }
+  return true;
+}
+
+bool CharucoPattern::MatchPartial(const cv::Mat &image, Point2Vector *points,
+                                  PointIdVector *ids) const {
+  assert(points);
+  assert(ids);
+
+  points->clear();
+  ids->clear();
+
+  std::vector<std::vector<cv::Point2f>> marker_corners;
+  std::vector<int> marker_ids;
+  cv::aruco::detectMarkers(image, dictionary_, marker_corners, marker_ids);
+  if (marker_ids.empty()) {
+    return false;
+  }
+
+  /* Corners are refined to subpixel precision from the image */
+  cv::aruco::interpolateCornersCharuco(marker_corners, marker_ids, image,
+                                       board_, *points, *ids);
+  return !ids->empty();
+}
+
+} // namespace dove_eye
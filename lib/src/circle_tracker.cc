@@ -1,5 +1,6 @@
 #include "dove_eye/circle_tracker.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include <opencv2/opencv.hpp>
@@ -7,6 +8,8 @@
 #include "config.h"
 #include "dove_eye/cv_logging.h"
 #include "dove_eye/logging.h"
+#include "dove_eye/mat_pool.h"
+#include "dove_eye/model_storage.h"
 
 using cv::HoughCircles;
 using cv::cvtColor;
@@ -14,6 +17,23 @@ using cv::mixChannels;
 using cv::Scalar;
 using std::vector;
 
+namespace {
+
+const char kModelTag[] = "circle";
+
+/** Searched radii are within [radius / factor, radius * factor] */
+const double kRadiusFactor = 1.5;
+
+/* Radial symmetry detector (Loy, Zelinsky: Fast radial symmetry) */
+const int kSymmetryRadii = 7;
+/** Gradients weaker than this fraction of the strongest one don't vote */
+const double kSymmetryGradientThreshold = 0.1;
+/** Saturation of orientation votes (k_n) */
+const double kSymmetryVotes = 9.9;
+const int kSymmetryCandidates = 3;
+
+} // namespace
+
 namespace dove_eye {
 
 bool CircleTracker::InitTrackerData(const cv::Mat &data, const Mark &mark) {
@@ -21,20 +41,49 @@ bool CircleTracker::InitTrackerData(const cv::Mat &data, const Mark &mark) {
   return UpdateData(data_, data, mark);
 }
 
+void CircleTracker::SaveTrackerData(ModelWriter *writer) const {
+  writer->Write(kModelTag);
+  writer->Write(data_.srange[0]);
+  writer->Write(data_.srange[1]);
+  writer->Write(data_.vrange[0]);
+  writer->Write(data_.vrange[1]);
+  writer->Write(data_.radius);
+  writer->Write(data_.histogram);
+}
+
+bool CircleTracker::LoadTrackerData(ModelReader *reader) {
+  if (!reader->Expect(kModelTag)) {
+    return false;
+  }
+
+  /* CircleData is not assignable (const member), read into temporaries */
+  double srange[2], vrange[2], radius;
+  cv::Mat histogram;
+  if (!reader->Read(&srange[0]) || !reader->Read(&srange[1]) ||
+      !reader->Read(&vrange[0]) || !reader->Read(&vrange[1]) ||
+      !reader->Read(&radius) || !reader->Read(&histogram) ||
+      static_cast<int>(histogram.total()) != data_.histogram_size) {
+    return false;
+  }
+
+  std::copy(srange, srange + 2, data_.srange);
+  std::copy(vrange, vrange + 2, data_.vrange);
+  data_.radius = radius;
+  data_.histogram = histogram;
+  return true;
+}
+
 /** Use Hough transform to find best matching circle
  *
  * @see SearchingTracker::Search()
  */
 bool CircleTracker::Search(
       const cv::Mat &data,
-      TrackerData &tracker_data,
+      CircleData &circle_data,
       const cv::Rect *roi,
       const cv::Mat *mask,
       const double threshold,
       Mark *result) const {
-  CircleData &circle_data = static_cast<CircleData &>(tracker_data);
-  const double radius_factor = 1.5;
-
   auto extended_roi = cv::Rect(cv::Point(0, 0), data.size());
   if (roi) {
     extended_roi &= *roi;
@@ -51,13 +100,17 @@ bool CircleTracker::Search(
   log_mat(reinterpret_cast<size_t>(this) * 100 + 2, data_proc);
 
   CircleVector circles;
-  HoughCircles(data_proc, circles, CV_HOUGH_GRADIENT,
-               2, // accumulator ratio (to original image resolution)
-               data_proc.rows / 2, //minDist between centers of circles
-               10, //param1 (Canny threshold)
-               25, //param2 (accumulator threshold)
-               circle_data.radius / radius_factor, //minRadius
-               circle_data.radius * radius_factor); // maxRadius
+  if (parameters().Get(Parameters::CIRCLE_DETECTOR) > 0.5) {
+    RadialSymmetryCircles(data_proc, circle_data.radius, &circles);
+  } else {
+    HoughCircles(data_proc, circles, CV_HOUGH_GRADIENT,
+                 2, // accumulator ratio (to original image resolution)
+                 data_proc.rows / 2, //minDist between centers of circles
+                 10, //param1 (Canny threshold)
+                 25, //param2 (accumulator threshold)
+                 circle_data.radius / kRadiusFactor, //minRadius
+                 circle_data.radius * kRadiusFactor); // maxRadius
+  }
 
 
   /* (Motion) mask is ignored. */
@@ -127,6 +180,114 @@ bool CircleTracker::UpdateData(CircleData &circle_data, const cv::Mat &data,
   return true;
 }
 
+/** Find centers of bright circular blobs by gradient voting
+ *
+ * Each significant gradient votes for the pixel it points to at distance n
+ * for several n from the radius band. Unlike Hough transform the cost
+ * depends only on ROI size and number of radii, not on edge density.
+ *
+ * @param[in]   data     blurred back projection
+ * @param[out]  circles  strongest candidates (radius interpolated)
+ */
+void CircleTracker::RadialSymmetryCircles(const cv::Mat &data,
+                                          const double radius,
+                                          CircleVector *circles) const {
+  assert(data.type() == CV_8UC1);
+  MatPool::Site site("tracker.symmetry");
+
+  cv::Mat gx, gy, magnitude;
+  cv::Sobel(data, gx, CV_32F, 1, 0);
+  cv::Sobel(data, gy, CV_32F, 0, 1);
+  cv::magnitude(gx, gy, magnitude);
+
+  double max_magnitude;
+  cv::minMaxLoc(magnitude, nullptr, &max_magnitude);
+  if (max_magnitude <= 0) {
+    return;
+  }
+
+  /* Unit gradients (gradient points to brighter, i.e. the center) */
+  const double min_magnitude = kSymmetryGradientThreshold * max_magnitude;
+  cv::Mat voting = magnitude >= min_magnitude;
+  cv::Mat norm = cv::max(magnitude, min_magnitude);
+  cv::divide(gx, norm, gx);
+  cv::divide(gy, norm, gy);
+
+  vector<cv::Point> voters;
+  cv::findNonZero(voting, voters);
+
+  const double min_radius = radius / kRadiusFactor;
+  const double step = (radius * kRadiusFactor - min_radius) /
+      (kSymmetryRadii - 1);
+
+  cv::Mat orientation(data.size(), CV_32F);
+  cv::Mat projection(data.size(), CV_32F);
+  cv::Mat symmetry = cv::Mat::zeros(data.size(), CV_32F);
+  vector<cv::Mat> responses(kSymmetryRadii);
+  MatPool::Use(&orientation);
+  MatPool::Use(&projection);
+
+  for (int i = 0; i < kSymmetryRadii; ++i) {
+    const double n = min_radius + i * step;
+    orientation.setTo(0);
+    projection.setTo(0);
+
+    for (auto &p : voters) {
+      const int x = p.x + cvRound(gx.at<float>(p) * n);
+      const int y = p.y + cvRound(gy.at<float>(p) * n);
+      if (x < 0 || y < 0 || x >= data.cols || y >= data.rows) {
+        continue;
+      }
+      orientation.at<float>(y, x) += 1;
+      projection.at<float>(y, x) += magnitude.at<float>(p);
+    }
+
+    /* F_n = M_n / k_n * (min(O_n, k_n) / k_n)^2 */
+    cv::min(orientation, kSymmetryVotes, orientation);
+    cv::multiply(orientation, orientation, orientation,
+                 1 / (kSymmetryVotes * kSymmetryVotes));
+    cv::multiply(projection, orientation, projection, 1 / kSymmetryVotes);
+    cv::GaussianBlur(projection, responses[i], cv::Size(), 0.25 * n);
+
+    symmetry += responses[i];
+  }
+
+  for (int candidate = 0; candidate < kSymmetryCandidates; ++candidate) {
+    double best;
+    cv::Point center;
+    cv::minMaxLoc(symmetry, nullptr, &best, nullptr, &center);
+    if (best <= 0) {
+      break;
+    }
+
+    /* Radius with the strongest response, parabolic interpolation */
+    int best_i = 0;
+    for (int i = 1; i < kSymmetryRadii; ++i) {
+      if (responses[i].at<float>(center) >
+          responses[best_i].at<float>(center)) {
+        best_i = i;
+      }
+    }
+
+    double offset = 0;
+    if (best_i > 0 && best_i < kSymmetryRadii - 1) {
+      const double a = responses[best_i - 1].at<float>(center);
+      const double b = responses[best_i].at<float>(center);
+      const double c = responses[best_i + 1].at<float>(center);
+      const double denominator = a - 2 * b + c;
+      if (denominator < 0) {
+        offset = 0.5 * (a - c) / denominator;
+      }
+    }
+
+    const double circle_radius = min_radius + (best_i + offset) * step;
+    circles->push_back(Circle(center.x, center.y, circle_radius));
+
+    /* Suppress the found center */
+    cv::circle(symmetry, center, cvRound(min_radius), cv::Scalar(0), -1);
+  }
+}
+
 /**
  * @param[in]   data      image to preprocess
  * @param[in]   circle_data
@@ -137,7 +298,9 @@ bool CircleTracker::UpdateData(CircleData &circle_data, const cv::Mat &data,
 cv::Mat CircleTracker::PreprocessImage(const cv::Mat &data,
                                        const CircleData &circle_data,
                                        const double threshold) const {
+  MatPool::Site site("tracker.preprocess");
   cv::Mat hsv;
+  MatPool::Use(&hsv);
 
   cvtColor(data, hsv, cv::COLOR_BGR2HSV);
   cv::Mat hsv_components[3];
@@ -153,6 +316,7 @@ cv::Mat CircleTracker::PreprocessImage(const cv::Mat &data,
   /* Caclulate backprojection */
   const float *prange = circle_data.hrange;
   cv::Mat backproj;
+  MatPool::Use(&backproj);
   cv::calcBackProject(&hsv_components[0], 1,
                   0, /* channels */
                   circle_data.histogram,
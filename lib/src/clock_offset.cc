@@ -0,0 +1,28 @@
+#include "dove_eye/clock_offset.h"
+
+#include <algorithm>
+
+namespace dove_eye {
+
+void ClockOffset::AddSample(const Frame::Timestamp t0,
+                            const Frame::Timestamp t1,
+                            const Frame::Timestamp t2,
+                            const Frame::Timestamp t3) {
+  Sample sample;
+  sample.offset = ((t1 - t0) + (t2 - t3)) / 2;
+  sample.delay = std::max(0.0, (t3 - t0) - (t2 - t1));
+
+  samples_.push_back(sample);
+  while (samples_.size() > window_) {
+    samples_.pop_front();
+  }
+
+  auto best = std::min_element(samples_.begin(), samples_.end(),
+                               [](const Sample &lhs, const Sample &rhs) {
+                                 return lhs.delay < rhs.delay;
+                               });
+  offset_ = best->offset;
+  delay_ = best->delay;
+}
+
+} // namespace dove_eye
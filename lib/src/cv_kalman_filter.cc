@@ -12,8 +12,24 @@ CvKalmanFilter::CvKalmanFilter(const CvKalmanFilter &other)
       prediction_(other.prediction_.clone()),
       prediction_valid_(other.prediction_valid_) {
 
-  /* This should force creation of new (unshared) state matrices */
-  kalman_filter_ = cv::KalmanFilter(4, 2, 0);
+  /* Copied cv::KalmanFilter shares matrices with the original, own them */
+  auto &kf = kalman_filter_;
+  kf.statePre = kf.statePre.clone();
+  kf.statePost = kf.statePost.clone();
+  kf.transitionMatrix = kf.transitionMatrix.clone();
+  kf.controlMatrix = kf.controlMatrix.clone();
+  kf.measurementMatrix = kf.measurementMatrix.clone();
+  kf.processNoiseCov = kf.processNoiseCov.clone();
+  kf.measurementNoiseCov = kf.measurementNoiseCov.clone();
+  kf.errorCovPre = kf.errorCovPre.clone();
+  kf.gain = kf.gain.clone();
+  kf.errorCovPost = kf.errorCovPost.clone();
+  /* Temporaries needn't be copied but they mustn't be shared */
+  kf.temp1 = cv::Mat();
+  kf.temp2 = cv::Mat();
+  kf.temp3 = cv::Mat();
+  kf.temp4 = cv::Mat();
+  kf.temp5 = cv::Mat();
 }
 
 void CvKalmanFilter::Init(const double process_var, const double observation_var) {
@@ -48,6 +64,16 @@ Point2 CvKalmanFilter::PredictChange(const double time) {
                 prediction_.at<MatType>(3, 0));
 }
 
+Point2 CvKalmanFilter::Extrapolate(const double time) {
+  const auto result = Predict(time);
+
+  /* cv::KalmanFilter::predict already moved posterior state to the prediction,
+   * next prediction will continue from it */
+  prediction_valid_ = false;
+
+  return result;
+}
+
 Point2 CvKalmanFilter::Update(const double time, const Point2 observation) {
   cv::Mat_<MatType> mat_observation(2, 1);
   mat_observation(0) = observation.x;
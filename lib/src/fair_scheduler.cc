@@ -0,0 +1,105 @@
+#include "dove_eye/fair_scheduler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <thread>
+
+#include "dove_eye/metrics.h"
+
+namespace dove_eye {
+
+namespace {
+
+/** Credit (virtual time in seconds) a client keeps when it stops waiting
+ *
+ * Clients don't wait between work units, this gap mustn't count as idling.
+ */
+const double kIdleCredit = 0.05;
+
+} // namespace
+
+FairScheduler::FairScheduler(const size_t slots)
+    : slots_(slots ? slots :
+             std::max(1u, std::thread::hardware_concurrency())),
+      free_slots_(slots_),
+      virtual_time_(0) {
+}
+
+FairScheduler::ClientId FairScheduler::AddClient(const std::string &name,
+                                                 const double weight) {
+  assert(weight > 0);
+
+  Lock lock(mtx_);
+  Client client;
+  client.name = name;
+  client.weight = weight;
+  client.virtual_time = virtual_time_;
+  client.waiting = false;
+  clients_.push_back(client);
+  return clients_.size() - 1;
+}
+
+void FairScheduler::Acquire(const ClientId id) {
+  Lock lock(mtx_);
+  assert(id < clients_.size());
+  auto &client = clients_[id];
+
+  client.requested = Clock::now();
+  client.virtual_time = std::max(client.virtual_time,
+                                 virtual_time_ - kIdleCredit);
+  client.waiting = true;
+
+  cv_.wait(lock, [&] { return free_slots_ > 0 && IsNext(id); });
+
+  client.waiting = false;
+  --free_slots_;
+  virtual_time_ = std::max(virtual_time_, client.virtual_time);
+  client.started = Clock::now();
+
+  /* Others may be eligible for remaining slots now */
+  if (free_slots_ > 0) {
+    cv_.notify_all();
+  }
+}
+
+void FairScheduler::Release(const ClientId id) {
+  const auto finished = Clock::now();
+  std::string name;
+  double busy, wait;
+  {
+    Lock lock(mtx_);
+    assert(id < clients_.size());
+    auto &client = clients_[id];
+
+    busy = std::chrono::duration<double>(finished - client.started).count();
+    wait = std::chrono::duration<double>(
+        client.started - client.requested).count();
+    client.virtual_time += busy / client.weight;
+    name = client.name;
+
+    ++free_slots_;
+  }
+  cv_.notify_all();
+
+  auto &metrics = Metrics::Global();
+  metrics.Add("scheduler." + name + ".busy", busy);
+  metrics.Add("scheduler." + name + ".wait", wait);
+}
+
+/** Client has the least virtual time among waiting ones (ties by order) */
+bool FairScheduler::IsNext(const ClientId id) const {
+  const double virtual_time = clients_[id].virtual_time;
+  for (ClientId other = 0; other < clients_.size(); ++other) {
+    if (other == id || !clients_[other].waiting) {
+      continue;
+    }
+    const double other_time = clients_[other].virtual_time;
+    if (other_time < virtual_time ||
+        (other_time == virtual_time && other < id)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace dove_eye
@@ -12,14 +12,20 @@ namespace dove_eye {
 /* Provider */
 FileVideoProvider::FileVideoProvider(const std::string &filename)
     : VideoProvider(),
-      filename_(filename) {
+      filename_(filename),
+      start_time_(0) {
 }
 
 FrameIterator FileVideoProvider::begin() {
   typedef CvFrameIterator<frame_iterator::FpsPolicy,
                           frame_iterator::NonblockingPolicy> CvIterator;
 
-  return FrameIterator(this, new CvIterator(filename_));
+  auto iterator = new CvIterator(filename_);
+  if (start_time_ > 0) {
+    iterator->Seek(start_time_);
+  }
+
+  return FrameIterator(this, iterator);
 }
 
 FrameIterator FileVideoProvider::end() {
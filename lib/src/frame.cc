@@ -1,10 +1,13 @@
 #include "dove_eye/frame.h"
 
+#include "dove_eye/mat_pool.h"
+
 namespace dove_eye {
 
 Frame Frame::Clone() const {
   Frame result(*this);
-  result.data = data.clone();
+  MatPool::Site site("frame.clone");
+  result.data = MatPool::Clone(data);
   return result;
 }
 
@@ -0,0 +1,52 @@
+#include "dove_eye/frame_store.h"
+
+#include <cassert>
+#include <utility>
+
+#include "dove_eye/mat_pool.h"
+
+namespace dove_eye {
+
+size_t FrameStore::Load(Aggregator *aggregator, const size_t max_framesets) {
+  assert(aggregator);
+  assert(aggregator->Arity() == arity_);
+
+  MatPool::Site site("frame_store");
+  size_t loaded = 0;
+  for (auto frameset : *aggregator) {
+    if (max_framesets && loaded >= max_framesets) {
+      break;
+    }
+    if (frameset.ValidCount() == 0) {
+      continue;
+    }
+
+    /* Providers may reuse their buffers, make own copy of the data */
+    Frameset stored(arity_, frameset.sequence_no);
+    for (CameraIndex cam = 0; cam < arity_; ++cam) {
+      if (!frameset.IsValid(cam)) {
+        continue;
+      }
+      stored[cam] = frameset[cam].Clone();
+      stored.SetValid(cam, true);
+    }
+
+    Add(std::move(stored));
+    ++loaded;
+  }
+
+  return loaded;
+}
+
+void FrameStore::Add(Frameset &&frameset) {
+  assert(frameset.Arity() == arity_);
+
+  for (CameraIndex cam = 0; cam < arity_; ++cam) {
+    if (frameset.IsValid(cam)) {
+      bytes_ += frameset[cam].data.total() * frameset[cam].data.elemSize();
+    }
+  }
+  framesets_.push_back(std::move(frameset));
+}
+
+} // namespace dove_eye
@@ -1,5 +1,6 @@
 #include "dove_eye/histogram_tracker.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include <opencv2/opencv.hpp>
@@ -7,6 +8,8 @@
 #include "config.h"
 #include "dove_eye/cv_logging.h"
 #include "dove_eye/logging.h"
+#include "dove_eye/mat_pool.h"
+#include "dove_eye/model_storage.h"
 
 using cv::calcBackProject;
 using cv::calcHist;
@@ -16,6 +19,12 @@ using cv::normalize;
 using cv::Scalar;
 using std::vector;
 
+namespace {
+
+const char kModelTag[] = "histogram";
+
+} // namespace
+
 namespace dove_eye {
 
 bool HistogramTracker::InitTrackerData(const cv::Mat &data, const Mark &mark) {
@@ -73,17 +82,52 @@ bool HistogramTracker::InitTrackerData(const cv::Mat &data, const Mark &mark) {
   return true;
 }
 
-/** Wrapper for OpenCV function calcBackProject
+void HistogramTracker::SaveTrackerData(ModelWriter *writer) const {
+  writer->Write(kModelTag);
+  writer->Write(data_.srange[0]);
+  writer->Write(data_.srange[1]);
+  writer->Write(data_.vrange[0]);
+  writer->Write(data_.vrange[1]);
+  writer->Write(static_cast<uint32_t>(data_.size.width));
+  writer->Write(static_cast<uint32_t>(data_.size.height));
+  writer->Write(data_.histogram);
+}
+
+bool HistogramTracker::LoadTrackerData(ModelReader *reader) {
+  if (!reader->Expect(kModelTag)) {
+    return false;
+  }
+
+  /* HistogramData is not assignable (const member), read into temporaries */
+  double srange[2], vrange[2];
+  uint32_t width, height;
+  cv::Mat histogram;
+  if (!reader->Read(&srange[0]) || !reader->Read(&srange[1]) ||
+      !reader->Read(&vrange[0]) || !reader->Read(&vrange[1]) ||
+      !reader->Read(&width) || !reader->Read(&height) ||
+      !reader->Read(&histogram) ||
+      static_cast<int>(histogram.total()) != data_.histogram_size) {
+    return false;
+  }
+
+  std::copy(srange, srange + 2, data_.srange);
+  std::copy(vrange, vrange + 2, data_.vrange);
+  data_.size = cv::Size(width, height);
+  data_.histogram = histogram;
+  return true;
+}
+
+/**
+ * @see SearchingTracker::Search() for OpenCV function calcBackProject
  * @see SearchingTracker::Search()
  */
 bool HistogramTracker::Search(
       const cv::Mat &data,
-      TrackerData &tracker_data,
+      HistogramData &hist_data,
       const cv::Rect *roi,
       const cv::Mat *mask,
       const double threshold,
       Mark *result) const {
-  const HistogramData &hist_data = static_cast<const HistogramData &>(tracker_data);
 
   DEBUG("%s([%i, %i], [%i, %i], %p[%i, %i]@[%i, %i], %p, %f, res)",
         __func__,
@@ -178,7 +222,9 @@ bool HistogramTracker::Search(
 cv::Mat HistogramTracker::PreprocessImage(const cv::Mat &data,
                                           const HistogramData &hist_data,
                                           cv::Mat *mask) const {
+  MatPool::Site site("tracker.preprocess");
   cv::Mat hsv;
+  MatPool::Use(&hsv);
 
   cvtColor(data, hsv, cv::COLOR_BGR2HSV);
 
@@ -0,0 +1,544 @@
+#include "dove_eye/history_store.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dove_eye/logging.h"
+
+using dove_eye::HistoryChunkHeader;
+using dove_eye::HistorySummary;
+using dove_eye::Location;
+
+namespace {
+
+/** Chunk is closed after this time (seconds) even when not full */
+const double kMaxChunkSpan = 60;
+
+static_assert(sizeof(HistoryChunkHeader) % 8 == 0,
+              "Columns must be aligned");
+
+inline size_t Align(const size_t size) {
+  return (size + 7) & ~static_cast<size_t>(7);
+}
+
+/** Offsets of columns within chunk (see history_store.h) */
+struct ColumnLayout {
+  size_t time;
+  size_t stream_time;
+  size_t sequence_no;
+  size_t posit_valid;
+  size_t states;
+  size_t location_valid;
+  size_t posits;
+  size_t location;
+  /** Size of whole chunk */
+  size_t size;
+
+  ColumnLayout(const size_t count, const size_t arity) {
+    size_t offset = sizeof(HistoryChunkHeader);
+    time = offset;
+    offset += Align(count * sizeof(double));
+    stream_time = offset;
+    offset += Align(count * sizeof(double));
+    sequence_no = offset;
+    offset += Align(count * sizeof(uint64_t));
+    posit_valid = offset;
+    offset += Align(count * sizeof(uint32_t));
+    states = offset;
+    offset += Align(arity * count * sizeof(uint8_t));
+    location_valid = offset;
+    offset += Align(count * sizeof(uint8_t));
+    posits = offset;
+    offset += Align(arity * 2 * count * sizeof(double));
+    location = offset;
+    offset += Align(3 * count * sizeof(double));
+    size = offset;
+  }
+};
+
+template<typename T>
+inline T *Column(uint8_t *chunk, const size_t offset) {
+  return reinterpret_cast<T *>(chunk + offset);
+}
+
+template<typename T>
+inline const T *Column(const uint8_t *chunk, const size_t offset) {
+  return reinterpret_cast<const T *>(chunk + offset);
+}
+
+/** Seconds since Unix epoch */
+double WallNow() {
+  std::chrono::duration<double> duration(
+      std::chrono::system_clock::now().time_since_epoch());
+  return duration.count();
+}
+
+/** Add locations to summary, its mean holds sum until finished */
+void Merge(HistorySummary *summary, const size_t count, const Location &sum,
+           const Location &min, const Location &max) {
+  if (count == 0) {
+    return;
+  }
+
+  if (summary->locations == 0) {
+    summary->min = min;
+    summary->max = max;
+  } else {
+    summary->min.x = std::min(summary->min.x, min.x);
+    summary->min.y = std::min(summary->min.y, min.y);
+    summary->min.z = std::min(summary->min.z, min.z);
+    summary->max.x = std::max(summary->max.x, max.x);
+    summary->max.y = std::max(summary->max.y, max.y);
+    summary->max.z = std::max(summary->max.z, max.z);
+  }
+  summary->locations += count;
+  summary->mean += sum;
+}
+
+} // namespace
+
+namespace dove_eye {
+
+bool HistoryWriter::Open(const std::string &filename, const CameraIndex arity,
+                         const uint32_t chunk_rows) {
+  assert(arity <= Positset::kMaxArity);
+  assert(chunk_rows > 0);
+  Close();
+
+  /* Continue existing history */
+  size_t valid_size = 0;
+  last_time_ = 0;
+  std::ifstream probe(filename, std::ios::binary);
+  if (probe && probe.peek() != std::ifstream::traits_type::eof()) {
+    HistoryReader reader;
+    if (!reader.Open(filename)) {
+      return false;
+    }
+    if (reader.Arity() != arity) {
+      ERROR("History %s is for %i camera(s)", filename.c_str(),
+            reader.Arity());
+      return false;
+    }
+
+    valid_size = reader.valid_size();
+    if (!reader.Empty()) {
+      last_time_ = reader.end_time();
+    }
+  }
+  probe.close();
+
+  /* Cut incomplete chunk of crashed writer */
+  if (valid_size > 0 && truncate(filename.c_str(), valid_size) != 0) {
+    ERROR("truncate(%s): %s", filename.c_str(), strerror(errno));
+    return false;
+  }
+
+  output_.open(filename, std::ios::binary | std::ios::app);
+  if (!output_) {
+    ERROR("Cannot open history %s", filename.c_str());
+    return false;
+  }
+
+  if (valid_size == 0) {
+    HistoryFileHeader header;
+    header.magic = kHistoryMagic;
+    header.version = kHistoryVersion;
+    header.arity = arity;
+    header.reserved = 0;
+    output_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    output_.flush();
+  }
+
+  arity_ = arity;
+  chunk_rows_ = chunk_rows;
+  wall_offset_valid_ = false;
+  rows_.reserve(chunk_rows_);
+
+  return output_.good();
+}
+
+void HistoryWriter::Append(HistoryRecord record) {
+  assert(IsOpen());
+  assert(record.positset.Arity() == arity_);
+  assert(record.states.size() == arity_);
+
+  /* Session appended to history continues after it (e.g. fast replay) */
+  if (!wall_offset_valid_) {
+    wall_offset_ = std::max(WallNow(), last_time_) - record.stream_time;
+    wall_offset_valid_ = true;
+  }
+
+  record.time = record.stream_time + wall_offset_;
+  if (record.time < last_time_) {
+    DEBUG("History record %f older than %f dropped", record.time, last_time_);
+    return;
+  }
+  last_time_ = record.time;
+
+  rows_.push_back(std::move(record));
+  if (rows_.size() >= chunk_rows_ ||
+      rows_.back().time - rows_.front().time >= kMaxChunkSpan) {
+    Flush();
+  }
+}
+
+bool HistoryWriter::Flush() {
+  if (!IsOpen() || rows_.empty()) {
+    return true;
+  }
+
+  const size_t count = rows_.size();
+  const ColumnLayout layout(count, arity_);
+  std::vector<uint8_t> buffer(layout.size, 0);
+  auto chunk = buffer.data();
+
+  auto header = reinterpret_cast<HistoryChunkHeader *>(chunk);
+  header->magic = kHistoryChunkMagic;
+  header->count = count;
+  header->size = layout.size;
+  header->first_time = rows_.front().time;
+  header->last_time = rows_.back().time;
+  header->location_count = 0;
+  for (int i = 0; i < 3; ++i) {
+    header->location_sum[i] = 0;
+    header->location_min[i] = std::numeric_limits<double>::infinity();
+    header->location_max[i] = -std::numeric_limits<double>::infinity();
+  }
+
+  auto time = Column<double>(chunk, layout.time);
+  auto stream_time = Column<double>(chunk, layout.stream_time);
+  auto sequence_no = Column<uint64_t>(chunk, layout.sequence_no);
+  auto posit_valid = Column<uint32_t>(chunk, layout.posit_valid);
+  auto states = Column<uint8_t>(chunk, layout.states);
+  auto location_valid = Column<uint8_t>(chunk, layout.location_valid);
+  auto posits = Column<double>(chunk, layout.posits);
+  auto location = Column<double>(chunk, layout.location);
+
+  for (size_t row = 0; row < count; ++row) {
+    const auto &record = rows_[row];
+    time[row] = record.time;
+    stream_time[row] = record.stream_time;
+    sequence_no[row] = record.positset.sequence_no;
+
+    uint32_t valid_mask = 0;
+    for (CameraIndex cam = 0; cam < arity_; ++cam) {
+      if (record.positset.IsValid(cam)) {
+        valid_mask |= 1u << cam;
+      }
+      states[cam * count + row] = record.states[cam];
+      posits[(2 * cam) * count + row] = record.positset[cam].x;
+      posits[(2 * cam + 1) * count + row] = record.positset[cam].y;
+    }
+    posit_valid[row] = valid_mask;
+
+    location_valid[row] = record.location_valid;
+    const double coords[3] = {
+      record.location.x, record.location.y, record.location.z
+    };
+    for (int i = 0; i < 3; ++i) {
+      location[i * count + row] = coords[i];
+    }
+
+    if (record.location_valid) {
+      header->location_count += 1;
+      for (int i = 0; i < 3; ++i) {
+        header->location_sum[i] += coords[i];
+        header->location_min[i] = std::min(header->location_min[i], coords[i]);
+        header->location_max[i] = std::max(header->location_max[i], coords[i]);
+      }
+    }
+  }
+
+  output_.write(reinterpret_cast<const char *>(chunk), buffer.size());
+  output_.flush();
+  rows_.clear();
+
+  if (!output_) {
+    ERROR("Cannot write history");
+    return false;
+  }
+  return true;
+}
+
+void HistoryWriter::Close() {
+  if (!IsOpen()) {
+    return;
+  }
+
+  Flush();
+  output_.close();
+  rows_.clear();
+}
+
+
+bool HistoryReader::Open(const std::string &filename) {
+  Close();
+
+  fd_ = open(filename.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    ERROR("open(%s): %s", filename.c_str(), strerror(errno));
+    return false;
+  }
+
+  if (!Refresh()) {
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+void HistoryReader::Close() {
+  if (address_) {
+    munmap(address_, size_);
+    address_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+
+  size_ = 0;
+  arity_ = 0;
+  index_.clear();
+  indexed_size_ = 0;
+}
+
+bool HistoryReader::Refresh() {
+  assert(fd_ >= 0);
+
+  struct stat st;
+  if (fstat(fd_, &st) != 0) {
+    ERROR("fstat: %s", strerror(errno));
+    return false;
+  }
+
+  const size_t size = st.st_size;
+  if (size > size_ && !Map(size)) {
+    return false;
+  }
+
+  if (indexed_size_ == 0) {
+    if (size_ < sizeof(HistoryFileHeader)) {
+      ERROR("Truncated history file");
+      return false;
+    }
+
+    auto &header = *static_cast<const HistoryFileHeader *>(address_);
+    if (header.magic != kHistoryMagic || header.version != kHistoryVersion ||
+        header.arity > static_cast<uint32_t>(Positset::kMaxArity)) {
+      ERROR("Invalid history file (magic %x, version %u)", header.magic,
+            header.version);
+      return false;
+    }
+
+    arity_ = header.arity;
+    indexed_size_ = sizeof(HistoryFileHeader);
+  }
+
+  /* Index complete chunks */
+  auto base = static_cast<const uint8_t *>(address_);
+  while (indexed_size_ + sizeof(HistoryChunkHeader) <= size_) {
+    auto &chunk = *reinterpret_cast<const HistoryChunkHeader *>(
+        base + indexed_size_);
+    if (chunk.magic != kHistoryChunkMagic || chunk.count == 0 ||
+        chunk.size != ColumnLayout(chunk.count, arity_).size ||
+        indexed_size_ + chunk.size > size_) {
+      break;
+    }
+
+    ChunkEntry entry;
+    entry.offset = indexed_size_;
+    entry.first_time = chunk.first_time;
+    entry.last_time = chunk.last_time;
+    index_.push_back(entry);
+
+    indexed_size_ += chunk.size;
+  }
+
+  return true;
+}
+
+size_t HistoryReader::RecordCount() const {
+  size_t result = 0;
+  for (auto &entry : index_) {
+    result += Chunk(entry).count;
+  }
+  return result;
+}
+
+double HistoryReader::start_time() const {
+  assert(!Empty());
+  return index_.front().first_time;
+}
+
+double HistoryReader::end_time() const {
+  assert(!Empty());
+  return index_.back().last_time;
+}
+
+size_t HistoryReader::Query(const double start, const double end,
+                            RecordsVector *result,
+                            const size_t max_records) const {
+  assert(result);
+
+  size_t found = 0;
+  for (size_t c = FindChunk(start);
+       c < index_.size() && index_[c].first_time <= end; ++c) {
+    const auto &entry = index_[c];
+    const auto &chunk = Chunk(entry);
+    const ColumnLayout layout(chunk.count, arity_);
+    auto time = Column<double>(
+        static_cast<const uint8_t *>(address_) + entry.offset, layout.time);
+
+    size_t row = std::lower_bound(time, time + chunk.count, start) - time;
+    for (; row < chunk.count && time[row] <= end; ++row) {
+      result->push_back(ReadRow(entry, row));
+      if (++found == max_records) {
+        return found;
+      }
+    }
+  }
+
+  return found;
+}
+
+void HistoryReader::Summarize(const double start, const double end,
+                              const size_t buckets,
+                              SummariesVector *result) const {
+  assert(result);
+  result->clear();
+  if (buckets == 0 || end <= start) {
+    return;
+  }
+
+  const double width = (end - start) / buckets;
+  for (size_t b = 0; b < buckets; ++b) {
+    result->push_back(HistorySummary(start + b * width,
+                                     start + (b + 1) * width));
+  }
+
+  auto bucket_of = [&](const double time) {
+    return std::min(static_cast<size_t>((time - start) / width), buckets - 1);
+  };
+
+  auto base = static_cast<const uint8_t *>(address_);
+  for (size_t c = FindChunk(start);
+       c < index_.size() && index_[c].first_time < end; ++c) {
+    const auto &entry = index_[c];
+    const auto &chunk = Chunk(entry);
+
+    /* Whole chunk in single bucket, use its summary */
+    if (entry.first_time >= start && entry.last_time < end &&
+        bucket_of(entry.first_time) == bucket_of(entry.last_time)) {
+      auto &summary = (*result)[bucket_of(entry.first_time)];
+      summary.records += chunk.count;
+      Merge(&summary, chunk.location_count,
+            Location(chunk.location_sum[0], chunk.location_sum[1],
+                     chunk.location_sum[2]),
+            Location(chunk.location_min[0], chunk.location_min[1],
+                     chunk.location_min[2]),
+            Location(chunk.location_max[0], chunk.location_max[1],
+                     chunk.location_max[2]));
+      continue;
+    }
+
+    const size_t count = chunk.count;
+    const ColumnLayout layout(count, arity_);
+    auto time = Column<double>(base + entry.offset, layout.time);
+    auto location_valid = Column<uint8_t>(base + entry.offset,
+                                          layout.location_valid);
+    auto location = Column<double>(base + entry.offset, layout.location);
+
+    size_t row = std::lower_bound(time, time + count, start) - time;
+    for (; row < count && time[row] < end; ++row) {
+      auto &summary = (*result)[bucket_of(time[row])];
+      summary.records += 1;
+      if (location_valid[row]) {
+        const Location point(location[row], location[count + row],
+                             location[2 * count + row]);
+        Merge(&summary, 1, point, point, point);
+      }
+    }
+  }
+
+  for (auto &summary : *result) {
+    if (summary.locations > 0) {
+      summary.mean *= 1.0 / summary.locations;
+    }
+  }
+}
+
+bool HistoryReader::Map(const size_t size) {
+  if (address_) {
+    munmap(address_, size_);
+    address_ = nullptr;
+    size_ = 0;
+  }
+
+  void *address = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd_, 0);
+  if (address == MAP_FAILED) {
+    ERROR("mmap: %s", strerror(errno));
+    return false;
+  }
+
+  address_ = address;
+  size_ = size;
+  return true;
+}
+
+const HistoryChunkHeader &HistoryReader::Chunk(const ChunkEntry &entry) const {
+  return *reinterpret_cast<const HistoryChunkHeader *>(
+      static_cast<const uint8_t *>(address_) + entry.offset);
+}
+
+size_t HistoryReader::FindChunk(const double time) const {
+  auto it = std::lower_bound(index_.begin(), index_.end(), time,
+                             [](const ChunkEntry &entry, const double time) {
+                               return entry.last_time < time;
+                             });
+  return it - index_.begin();
+}
+
+HistoryRecord HistoryReader::ReadRow(const ChunkEntry &entry,
+                                     const size_t row) const {
+  const auto &chunk = Chunk(entry);
+  const size_t count = chunk.count;
+  assert(row < count);
+
+  const ColumnLayout layout(count, arity_);
+  auto base = static_cast<const uint8_t *>(address_) + entry.offset;
+  auto posit_valid = Column<uint32_t>(base, layout.posit_valid)[row];
+  auto states = Column<uint8_t>(base, layout.states);
+  auto posits = Column<double>(base, layout.posits);
+  auto location = Column<double>(base, layout.location);
+
+  HistoryRecord record(arity_);
+  record.time = Column<double>(base, layout.time)[row];
+  record.stream_time = Column<double>(base, layout.stream_time)[row];
+  record.positset.sequence_no = Column<uint64_t>(base, layout.sequence_no)[row];
+
+  for (CameraIndex cam = 0; cam < arity_; ++cam) {
+    record.positset[cam] = Posit(posits[(2 * cam) * count + row],
+                                 posits[(2 * cam + 1) * count + row]);
+    record.positset.SetValid(cam, posit_valid & (1u << cam));
+    record.states[cam] = states[cam * count + row];
+  }
+
+  record.location_valid = Column<uint8_t>(base, layout.location_valid)[row];
+  record.location = Location(location[row], location[count + row],
+                             location[2 * count + row]);
+
+  return record;
+}
+
+} // namespace dove_eye
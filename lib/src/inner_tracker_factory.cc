@@ -0,0 +1,22 @@
+#include "dove_eye/inner_tracker_factory.h"
+
+#include "dove_eye/circle_tracker.h"
+#include "dove_eye/histogram_tracker.h"
+#include "dove_eye/template_tracker.h"
+
+namespace dove_eye {
+
+InnerTracker *CreateInnerTracker(const std::string &name,
+                                 const Parameters &parameters) {
+  if (name == "circle") {
+    return new CircleTracker(parameters);
+  } else if (name == "histogram") {
+    return new HistogramTracker(parameters);
+  } else if (name == "template") {
+    return new TemplateTracker(parameters);
+  }
+
+  return nullptr;
+}
+
+} // namespace dove_eye
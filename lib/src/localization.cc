@@ -1,23 +1,91 @@
 #include "dove_eye/localization.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include <opencv2/opencv.hpp>
 
 #include "dove_eye/logging.h"
+#include "dove_eye/metrics.h"
 #include "dove_eye/types.h"
 
 using cv::triangulatePoints;
 
+namespace {
+
+/** Lower bound of pair score so that even degenerate pair has some weight */
+const double kMinPairScore = 1e-3;
+
+/** Maximal number of pair hypotheses evaluated by consensus */
+const size_t kMaxHypotheses = 16;
+
+} // namespace
+
 namespace dove_eye {
 
-bool Localization::Locate(const Positset &positset, Location *result) {
-  assert(positset.Arity() == Arity());
+void Localization::calibration_data(const CalibrationData *value) {
+  calibration_data_ = value;
+
+  if (calibration_data_) {
+    for (CameraIndex cam = 0; cam < arity_; ++cam) {
+      projections_[cam] = calibration_data_->ProjectionMatrix(cam);
+    }
+  }
+
+  CalculatePairScores();
+}
+
+double Localization::CameraScore(const CameraIndex cam) const {
+  assert(cam < Arity());
+
+  double result = 0;
+  for (auto pair : pairs_) {
+    if (pair.cam1 == cam || pair.cam2 == cam) {
+      result += pair_scores_[pair.index];
+    }
+  }
+  return result;
+}
+
+bool Localization::Locate(const Positset &input_positset, Location *result) {
+  assert(input_positset.Arity() == Arity());
   assert(result);
 
+  /*
+   * Predicted posits (of coasted cameras) only stand in when there are not
+   * enough observations, they never make an observation an outlier nor are
+   * outliers themselves.
+   */
+  Positset observations(input_positset);
+  for (CameraIndex cam = 0; cam < arity_; ++cam) {
+    if (input_positset.IsPredicted(cam)) {
+      observations.SetValid(cam, false);
+    }
+  }
+
+  Positset positset(input_positset);
+  if (observations.ValidCount() >= PositsRequired()) {
+    positset = observations;
+    FindConsensus(observations, &positset);
+  } else {
+    outliers_.assign(arity_, false);
+  }
+
+  const size_t max_pairs = parameters_.Get(Parameters::LOCALIZATION_MAX_PAIRS);
+
   //TODO verify it's initialized to zeroes
   Location location;
   size_t used_pairs = 0;
+  double weight_sum = 0;
 
-  for (auto pair : pairs_) {
+  /*
+   * Use only the best conditioned pairs, so that the work is bounded
+   * regardless of number of cameras.
+   */
+  for (auto pair : ranked_pairs_) {
+    if (used_pairs >= max_pairs) {
+      break;
+    }
     if (!positset.IsValid(pair.cam1) || !positset.IsValid(pair.cam2)) {
       continue;
     }
@@ -25,18 +93,170 @@ bool Localization::Locate(const Positset &positset, Location *result) {
     Location pair_location = PairLocate(positset, pair);
 
     /*
-     * Naive method that estimates real position as a centroid of individual
-     * positions.
+     * Estimate real position as a weighted centroid of individual positions.
      */
-    location += pair_location;
+    const double weight = pair_scores_[pair.index];
+    location += pair_location * weight;
+    weight_sum += weight;
     ++used_pairs;
   }
 
   if (!used_pairs) {
+    Metrics::Global().Add(metrics_prefix_ + "localization.failures");
+    return false;
+  }
+
+  Metrics::Global().Add(metrics_prefix_ + "localization.locations");
+  *result = location * (1.0 / weight_sum);
+  return true;
+}
+
+/** Exclude posits that are inconsistent with the majority of views
+ *
+ * Each hypothesis is a point triangulated from a minimal set (a camera pair),
+ * its support are views that reproject it within the inlier threshold.
+ * Hypotheses are drawn deterministically from the best conditioned pairs,
+ * which for typical arities means all of them.
+ */
+void Localization::FindConsensus(const Positset &positset, Positset *inliers) {
+  assert(inliers);
+
+  outliers_.assign(arity_, false);
+
+  /* With two views any hypothesis is supported by both */
+  if (!calibration_data_ || positset.ValidCount() < 3) {
+    return;
+  }
+
+  const double threshold = parameters_.Get(Parameters::LOCALIZATION_INLIER_THR);
+
+  size_t hypotheses = 0;
+  CameraIndex best_support = 0;
+  double best_error = 0;
+  bool best_inliers[Positset::kMaxArity] = {};
+
+  for (auto pair : ranked_pairs_) {
+    if (hypotheses >= kMaxHypotheses) {
+      break;
+    }
+    if (!positset.IsValid(pair.cam1) || !positset.IsValid(pair.cam2)) {
+      continue;
+    }
+    ++hypotheses;
+
+    cv::Vec3d point;
+    if (!FastPairLocate(positset, pair, &point)) {
+      continue;
+    }
+
+    CameraIndex support = 0;
+    double total_error = 0;
+    bool current_inliers[Positset::kMaxArity] = {};
+
+    for (CameraIndex cam = 0; cam < arity_; ++cam) {
+      if (!positset.IsValid(cam)) {
+        continue;
+      }
+
+      double error;
+      if (ReprojectionError(point, cam, positset[cam], &error) &&
+          error <= threshold) {
+        current_inliers[cam] = true;
+        total_error += error;
+        ++support;
+      }
+    }
+
+    if (support > best_support ||
+        (support == best_support && total_error < best_error)) {
+      best_support = support;
+      best_error = total_error;
+      std::copy(current_inliers, current_inliers + arity_, best_inliers);
+    }
+  }
+
+  /* No pair is self-consistent, we can't tell which view is wrong */
+  if (best_support < 2) {
+    return;
+  }
+
+  for (CameraIndex cam = 0; cam < arity_; ++cam) {
+    if (positset.IsValid(cam) && !best_inliers[cam]) {
+      DEBUG("Camera %i is an outlier", cam);
+      Metrics::Global().Add(metrics_prefix_ + "localization.outliers");
+      outliers_[cam] = true;
+      inliers->SetValid(cam, false);
+    }
+  }
+}
+
+/** Linear (DLT) triangulation on fixed size matrices
+ *
+ * Unlike PairLocate it does not allocate, so that it can be used for
+ * evaluating many hypotheses.
+ *
+ * @return  false when the point is not in front of both cameras
+ */
+bool Localization::FastPairLocate(const Positset &positset,
+                                  const CameraPair pair,
+                                  cv::Vec3d *result) const {
+  assert(result);
+
+  const CameraIndex cams[2] = { pair.cam1, pair.cam2 };
+
+  /* Solve inhomogeneous system A * X = b in the least squares sense */
+  cv::Matx<double, 4, 3> a;
+  cv::Vec4d b;
+  for (int i = 0; i < 2; ++i) {
+    const auto &p = projections_[cams[i]];
+    const Posit &posit = positset[cams[i]];
+
+    for (int col = 0; col < 3; ++col) {
+      a(2 * i, col) = posit.x * p(2, col) - p(0, col);
+      a(2 * i + 1, col) = posit.y * p(2, col) - p(1, col);
+    }
+    b[2 * i] = p(0, 3) - posit.x * p(2, 3);
+    b[2 * i + 1] = p(1, 3) - posit.y * p(2, 3);
+  }
+
+  const cv::Matx33d normal = a.t() * a;
+  const cv::Vec3d rhs = a.t() * b;
+  if (std::abs(cv::determinant(normal)) < 1e-12) {
     return false;
   }
+  *result = normal.solve(rhs, cv::DECOMP_CHOLESKY);
+
+  for (int i = 0; i < 2; ++i) {
+    const auto &p = projections_[cams[i]];
+    const double depth = p(2, 0) * (*result)[0] + p(2, 1) * (*result)[1] +
+        p(2, 2) * (*result)[2] + p(2, 3);
+    if (depth <= 0) {
+      return false;
+    }
+  }
 
-  *result = location * (1.0 / used_pairs);
+  return true;
+}
+
+/** Reprojection error of a world point
+ *
+ * @return  false when the point is behind the camera
+ */
+bool Localization::ReprojectionError(const cv::Vec3d &point,
+                                     const CameraIndex cam,
+                                     const Posit &posit,
+                                     double *error) const {
+  assert(error);
+
+  const auto projected = projections_[cam] * cv::Vec4d(point[0], point[1],
+                                                       point[2], 1);
+  if (projected[2] <= 0) {
+    return false;
+  }
+
+  const double dx = projected[0] / projected[2] - posit.x;
+  const double dy = projected[1] / projected[2] - posit.y;
+  *error = std::sqrt(dx * dx + dy * dy);
   return true;
 }
 
@@ -68,4 +288,76 @@ Location Localization::PairLocate(const Positset &positset,
   return result;
 }
 
+/** Estimate how well each camera pair is conditioned for triangulation
+ *
+ * The score is sine of the angle between rays of both cameras in a reference
+ * point of the working volume, i.e. small baseline or (almost) parallel rays
+ * give low score. The reference point is the point where optical axes of
+ * cameras get closest.
+ */
+void Localization::CalculatePairScores() {
+  pair_scores_.assign(pairs_.size(), 1);
+  ranked_pairs_ = pairs_;
+
+  if (!calibration_data_) {
+    return;
+  }
+
+  std::vector<cv::Vec3d> centers(arity_);
+  std::vector<cv::Vec3d> axes(arity_);
+  for (CameraIndex cam = 0; cam < arity_; ++cam) {
+    /* Invert world-to-camera transformation */
+    cv::Matx33d R = calibration_data_->CameraRotation(cam);
+    cv::Vec3d t = calibration_data_->CameraTranslation(cam);
+
+    centers[cam] = -(R.t() * t);
+    axes[cam] = R.t() * cv::Vec3d(0, 0, 1);
+  }
+
+  for (auto pair : pairs_) {
+    const auto &c1 = centers[pair.cam1];
+    const auto &c2 = centers[pair.cam2];
+    const auto &a1 = axes[pair.cam1];
+    const auto &a2 = axes[pair.cam2];
+
+    const auto w0 = c1 - c2;
+    const double baseline = cv::norm(w0);
+    const double b = a1.dot(a2);
+    const double d = a1.dot(w0);
+    const double e = a2.dot(w0);
+    const double denominator = 1 - b * b;
+
+    cv::Vec3d reference;
+    double s = -1;
+    double u = -1;
+    if (denominator > 1e-9) {
+      s = (b * e - d) / denominator;
+      u = (e - b * d) / denominator;
+    }
+
+    if (s > 0 && u > 0) {
+      reference = 0.5 * ((c1 + s * a1) + (c2 + u * a2));
+    } else {
+      /* Parallel or diverging axes, look in front of cameras */
+      auto direction = a1 + a2;
+      direction *= 1 / std::max(cv::norm(direction), 1e-9);
+      reference = 0.5 * (c1 + c2) + direction * baseline;
+    }
+
+    const auto ray1 = reference - c1;
+    const auto ray2 = reference - c2;
+    const double norms = cv::norm(ray1) * cv::norm(ray2);
+    const double sine = (norms > 0) ? cv::norm(ray1.cross(ray2)) / norms : 0;
+
+    pair_scores_[pair.index] = std::max(kMinPairScore, sine);
+    DEBUG("Pair %i, %i score %f", pair.cam1, pair.cam2,
+          pair_scores_[pair.index]);
+  }
+
+  std::stable_sort(ranked_pairs_.begin(), ranked_pairs_.end(),
+                   [this](const CameraPair &lhs, const CameraPair &rhs) {
+                     return pair_scores_[lhs.index] > pair_scores_[rhs.index];
+                   });
+}
+
 } // namespace dove_eye
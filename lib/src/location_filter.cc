@@ -0,0 +1,119 @@
+#include "dove_eye/location_filter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace dove_eye {
+
+void LocationFilter::Init(const double process_var,
+                          const double observation_var) {
+  process_var_ = process_var;
+  observation_var_ = observation_var;
+  initialized_ = false;
+}
+
+Location LocationFilter::Predict(const Frame::Timestamp time) const {
+  assert(initialized_);
+
+  StateMat state;
+  PredictState(time, &state, nullptr);
+  return Location(state(0), state(1), state(2));
+}
+
+double LocationFilter::PredictDeviation(const Frame::Timestamp time) const {
+  assert(initialized_);
+
+  StateMat state;
+  CovarianceMat covariance;
+  PredictState(time, &state, &covariance);
+
+  /* Be pessimistic and take the worst axis */
+  auto variance = std::max(covariance(0, 0),
+                           std::max(covariance(1, 1), covariance(2, 2)));
+  return std::sqrt(variance);
+}
+
+Location LocationFilter::Update(const Frame::Timestamp time,
+                                const Location observation) {
+  if (!initialized_) {
+    return Reset(time, observation);
+  }
+
+  StateMat state;
+  CovarianceMat covariance;
+  PredictState(time, &state, &covariance);
+
+  /*
+   * Observation matrix H = [I 0] only picks the position, therefore the
+   * products with H are just submatrices.
+   */
+  cv::Matx31d innovation(observation.x - state(0),
+                         observation.y - state(1),
+                         observation.z - state(2));
+
+  cv::Matx33d innovation_cov = covariance.get_minor<3, 3>(0, 0) +
+      cv::Matx33d::eye() * observation_var_;
+  cv::Matx<double, 6, 3> gain = covariance.get_minor<6, 3>(0, 0) *
+      innovation_cov.inv();
+
+  cv::Matx<double, 3, 6> observed_cov = covariance.get_minor<3, 6>(0, 0);
+
+  state_ = state + gain * innovation;
+  covariance_ = covariance - gain * observed_cov;
+  time_ = std::max(time, time_);
+
+  return Location(state_(0), state_(1), state_(2));
+}
+
+Location LocationFilter::Reset(const Frame::Timestamp time,
+                               const Location observation) {
+  state_ = StateMat(observation.x, observation.y, observation.z, 0, 0, 0);
+
+  covariance_ = CovarianceMat::zeros();
+  for (int i = 0; i < 3; ++i) {
+    covariance_(i, i) = observation_var_;
+    /* Unknown velocity */
+    covariance_(i + 3, i + 3) = 1;
+  }
+
+  time_ = time;
+  initialized_ = true;
+
+  return observation;
+}
+
+void LocationFilter::PredictState(const Frame::Timestamp time,
+                                  StateMat *state,
+                                  CovarianceMat *covariance) const {
+  assert(state);
+
+  /* Observations may come slightly out of order, never predict backwards */
+  const double dt = std::max(0.0, time - time_);
+
+  CovarianceMat transition = CovarianceMat::eye();
+  for (int i = 0; i < 3; ++i) {
+    transition(i, i + 3) = dt;
+  }
+
+  *state = transition * state_;
+
+  if (!covariance) {
+    return;
+  }
+
+  /* Discretized white noise acceleration model */
+  const double dt2 = dt * dt;
+  const double dt3 = dt2 * dt;
+  CovarianceMat process_noise = CovarianceMat::zeros();
+  for (int i = 0; i < 3; ++i) {
+    process_noise(i, i) = process_var_ * dt3 / 3;
+    process_noise(i, i + 3) = process_var_ * dt2 / 2;
+    process_noise(i + 3, i) = process_var_ * dt2 / 2;
+    process_noise(i + 3, i + 3) = process_var_ * dt;
+  }
+
+  *covariance = transition * covariance_ * transition.t() + process_noise;
+}
+
+} // namespace dove_eye
@@ -0,0 +1,161 @@
+#include "dove_eye/mat_pool.h"
+
+#include <cassert>
+#include <string>
+
+#include "config.h"
+
+namespace {
+
+typedef std::lock_guard<std::mutex> Lock;
+
+/** Keeps data aligned (as cv::fastMalloc does) */
+const size_t kHeaderSize = 64;
+
+/** Smaller buffers are not cached, malloc handles them well */
+const size_t kMinPooledSize = 16 * 1024;
+
+/** Capacity granularity of large buffers (pooled) */
+const size_t kLargeGranularity = 4096;
+
+/** Capacity granularity of small buffers */
+const size_t kSmallGranularity = 16;
+
+/** Cached buffers of one size class (e.g. frames of all cameras) */
+const size_t kMaxCachedPerClass = 16;
+
+const size_t kMaxCachedBytes = 256 * 1024 * 1024;
+
+const char kDefaultSite[] = "other";
+
+thread_local const char *current_site = nullptr;
+
+} // namespace
+
+namespace dove_eye {
+
+MatPool::Site::Site(const char *name)
+    : previous_(current_site) {
+  current_site = name;
+}
+
+MatPool::Site::~Site() {
+  current_site = previous_;
+}
+
+const char *MatPool::Site::Current() {
+  return current_site ? current_site : kDefaultSite;
+}
+
+MatPool *MatPool::Global() {
+#ifdef CONFIG_MAT_POOL
+  /* Never destroyed, pooled matrices may outlive static destruction */
+  static MatPool *pool = [] {
+    auto result = new MatPool();
+    Metrics::Global().Register([result](Metrics *metrics) {
+      result->Publish(metrics);
+    });
+    return result;
+  }();
+  return pool;
+#else
+  return nullptr;
+#endif
+}
+
+void MatPool::allocate(int dims, const int *sizes, int type, int *&refcount,
+                       uchar *&datastart, uchar *&data, size_t *step) {
+  size_t total = CV_ELEM_SIZE(type);
+  for (int i = dims - 1; i >= 0; --i) {
+    step[i] = total;
+    total *= sizes[i];
+  }
+
+  const size_t capacity = SizeClass(total);
+  Header *header = nullptr;
+  {
+    Lock lock(mtx_);
+    auto &stats = site_stats_[Site::Current()];
+    stats.allocations += 1;
+    stats.bytes += total;
+
+    auto it = cache_.find(capacity);
+    if (it != cache_.end() && !it->second.empty()) {
+      header = it->second.back();
+      it->second.pop_back();
+      cached_bytes_ -= capacity;
+      stats.reused += 1;
+    }
+    live_bytes_ += capacity;
+  }
+
+  if (!header) {
+    static_assert(sizeof(Header) <= kHeaderSize, "Header doesn't fit");
+    header = static_cast<Header *>(cv::fastMalloc(kHeaderSize + capacity));
+    header->capacity = capacity;
+  }
+
+  header->refcount = 1;
+  refcount = &header->refcount;
+  datastart = data = reinterpret_cast<uchar *>(header) + kHeaderSize;
+}
+
+void MatPool::deallocate(int *refcount, uchar *datastart, uchar *data) {
+  if (!datastart) {
+    return;
+  }
+
+  auto header = reinterpret_cast<Header *>(datastart - kHeaderSize);
+  assert(refcount == &header->refcount);
+  const size_t capacity = header->capacity;
+  {
+    Lock lock(mtx_);
+    live_bytes_ -= capacity;
+
+    if (capacity >= kMinPooledSize &&
+        cached_bytes_ + capacity <= kMaxCachedBytes) {
+      auto &buffers = cache_[capacity];
+      if (buffers.size() < kMaxCachedPerClass) {
+        buffers.push_back(header);
+        cached_bytes_ += capacity;
+        return;
+      }
+    }
+  }
+
+  cv::fastFree(header);
+}
+
+void MatPool::Publish(Metrics *metrics) const {
+  /* Same name may have several pointers (literals in different units) */
+  std::map<std::string, SiteStats> sites;
+  size_t cached_bytes, live_bytes;
+  {
+    Lock lock(mtx_);
+    for (auto &site : site_stats_) {
+      auto &stats = sites[site.first];
+      stats.allocations += site.second.allocations;
+      stats.reused += site.second.reused;
+      stats.bytes += site.second.bytes;
+    }
+    cached_bytes = cached_bytes_;
+    live_bytes = live_bytes_;
+  }
+
+  for (auto &site : sites) {
+    const std::string prefix = "mat_pool." + site.first;
+    metrics->Set(prefix + ".allocations", site.second.allocations);
+    metrics->Set(prefix + ".reused", site.second.reused);
+    metrics->Set(prefix + ".bytes", site.second.bytes);
+  }
+  metrics->Set("mat_pool.cached_bytes", cached_bytes);
+  metrics->Set("mat_pool.live_bytes", live_bytes);
+}
+
+size_t MatPool::SizeClass(const size_t size) {
+  const size_t granularity = (size >= kMinPooledSize) ?
+      kLargeGranularity : kSmallGranularity;
+  return (size + granularity - 1) / granularity * granularity;
+}
+
+} // namespace dove_eye
@@ -0,0 +1,53 @@
+#include "dove_eye/metrics.h"
+
+namespace dove_eye {
+
+typedef std::lock_guard<std::mutex> Lock;
+
+Metrics &Metrics::Global() {
+  /* Function-local so that it can be used during static initialization */
+  static Metrics metrics;
+  return metrics;
+}
+
+void Metrics::Add(const std::string &name, const double delta) {
+  Lock lock(values_mtx_);
+  values_[name] += delta;
+}
+
+void Metrics::Set(const std::string &name, const double value) {
+  Lock lock(values_mtx_);
+  values_[name] = value;
+}
+
+double Metrics::Get(const std::string &name) const {
+  Lock lock(values_mtx_);
+  auto it = values_.find(name);
+  return (it == values_.end()) ? 0 : it->second;
+}
+
+void Metrics::Register(const Source &source) {
+  Lock lock(sources_mtx_);
+  sources_.push_back(source);
+}
+
+Metrics::Values Metrics::Snapshot() {
+  SourcesVector sources;
+  {
+    Lock lock(sources_mtx_);
+    sources = sources_;
+  }
+  for (auto &source : sources) {
+    source(this);
+  }
+
+  Lock lock(values_mtx_);
+  return Values(values_.begin(), values_.end());
+}
+
+void Metrics::Reset() {
+  Lock lock(values_mtx_);
+  values_.clear();
+}
+
+} // namespace dove_eye
@@ -0,0 +1,208 @@
+#include "dove_eye/mjpeg_capture.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "dove_eye/frame_iterator/clock_policy.h"
+#include "dove_eye/logging.h"
+
+using dove_eye::frame_iterator::ClockPolicy;
+
+namespace dove_eye {
+
+bool MjpegCapture::Open(const int device, const int width, const int height,
+                        const double fps) {
+  assert(!IsOpen());
+
+  const std::string path = "/dev/video" + std::to_string(device);
+  fd_ = open(path.c_str(), O_RDWR | O_NONBLOCK);
+  if (fd_ < 0) {
+    ERROR("Cannot open %s: %s", path.c_str(), strerror(errno));
+    return false;
+  }
+
+  v4l2_capability capability;
+  memset(&capability, 0, sizeof(capability));
+  if (!Ioctl(VIDIOC_QUERYCAP, &capability) ||
+      !(capability.capabilities & V4L2_CAP_VIDEO_CAPTURE) ||
+      !(capability.capabilities & V4L2_CAP_STREAMING)) {
+    ERROR("%s is not a streaming capture device", path.c_str());
+    Close();
+    return false;
+  }
+
+  v4l2_format format;
+  memset(&format, 0, sizeof(format));
+  format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  Ioctl(VIDIOC_G_FMT, &format);
+  if (width > 0 && height > 0) {
+    format.fmt.pix.width = width;
+    format.fmt.pix.height = height;
+  }
+  format.fmt.pix.pixelformat = V4L2_PIX_FMT_MJPEG;
+  format.fmt.pix.field = V4L2_FIELD_ANY;
+  if (!Ioctl(VIDIOC_S_FMT, &format) ||
+      format.fmt.pix.pixelformat != V4L2_PIX_FMT_MJPEG) {
+    ERROR("%s doesn't provide MJPEG", path.c_str());
+    Close();
+    return false;
+  }
+  width_ = format.fmt.pix.width;
+  height_ = format.fmt.pix.height;
+
+  if (fps > 0) {
+    v4l2_streamparm parameters;
+    memset(&parameters, 0, sizeof(parameters));
+    parameters.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    parameters.parm.capture.timeperframe.numerator = 1000;
+    parameters.parm.capture.timeperframe.denominator = fps * 1000;
+    /* Not fatal, some drivers have fixed rate */
+    Ioctl(VIDIOC_S_PARM, &parameters);
+  }
+
+  v4l2_requestbuffers request;
+  memset(&request, 0, sizeof(request));
+  request.count = kBufferCount;
+  request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  request.memory = V4L2_MEMORY_MMAP;
+  if (!Ioctl(VIDIOC_REQBUFS, &request) || request.count == 0) {
+    ERROR("Cannot allocate buffers of %s", path.c_str());
+    Close();
+    return false;
+  }
+
+  for (uint32_t i = 0; i < request.count; ++i) {
+    v4l2_buffer buffer;
+    memset(&buffer, 0, sizeof(buffer));
+    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffer.memory = V4L2_MEMORY_MMAP;
+    buffer.index = i;
+    if (!Ioctl(VIDIOC_QUERYBUF, &buffer)) {
+      Close();
+      return false;
+    }
+
+    void *address = mmap(nullptr, buffer.length, PROT_READ, MAP_SHARED, fd_,
+                         buffer.m.offset);
+    if (address == MAP_FAILED) {
+      ERROR("Cannot map buffer of %s: %s", path.c_str(), strerror(errno));
+      Close();
+      return false;
+    }
+    buffers_.push_back(Buffer{address, buffer.length});
+
+    if (!Ioctl(VIDIOC_QBUF, &buffer)) {
+      Close();
+      return false;
+    }
+  }
+
+  int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  if (!Ioctl(VIDIOC_STREAMON, &type)) {
+    ERROR("Cannot start streaming of %s", path.c_str());
+    Close();
+    return false;
+  }
+
+  DEBUG("%s: MJPEG %dx%d", path.c_str(), width_, height_);
+  return true;
+}
+
+void MjpegCapture::Close() {
+  if (!IsOpen()) {
+    return;
+  }
+
+  int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  Ioctl(VIDIOC_STREAMOFF, &type);
+
+  for (auto &buffer : buffers_) {
+    munmap(buffer.address, buffer.length);
+  }
+  buffers_.clear();
+
+  close(fd_);
+  fd_ = -1;
+}
+
+MjpegCapture::GrabResult MjpegCapture::Grab(std::vector<uint8_t> *data,
+                                            int64_t *timestamp,
+                                            const bool block) {
+  assert(data);
+  assert(timestamp);
+  assert(IsOpen());
+
+  while (true) {
+    if (block) {
+      pollfd fds;
+      fds.fd = fd_;
+      fds.events = POLLIN;
+      const int ready = poll(&fds, 1, kGrabTimeout);
+      if (ready < 0 && errno == EINTR) {
+        continue;
+      } else if (ready <= 0) {
+        ERROR("No frame from V4L2 device");
+        return kError;
+      }
+    }
+
+    v4l2_buffer buffer;
+    memset(&buffer, 0, sizeof(buffer));
+    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffer.memory = V4L2_MEMORY_MMAP;
+    if (!Ioctl(VIDIOC_DQBUF, &buffer)) {
+      if (errno == EAGAIN) {
+        if (block) {
+          continue;
+        }
+        return kNoFrame;
+      }
+      return kError;
+    }
+
+    if ((buffer.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) ==
+        V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+      *timestamp = ClockPolicy::FromSteady(
+          static_cast<int64_t>(buffer.timestamp.tv_sec) * 1000000000 +
+          static_cast<int64_t>(buffer.timestamp.tv_usec) * 1000);
+    } else {
+      *timestamp = ClockPolicy::NowNanoseconds();
+    }
+
+    const bool corrupted = buffer.flags & V4L2_BUF_FLAG_ERROR;
+    if (!corrupted) {
+      auto begin = static_cast<const uint8_t *>(buffers_[buffer.index].address);
+      data->assign(begin, begin + buffer.bytesused);
+    }
+
+    if (!Ioctl(VIDIOC_QBUF, &buffer)) {
+      return kError;
+    }
+
+    if (!corrupted) {
+      return kFrame;
+    }
+    if (!block) {
+      return kNoFrame;
+    }
+  }
+}
+
+bool MjpegCapture::Ioctl(const unsigned long request, void *arg) const {
+  int result;
+  do {
+    result = ioctl(fd_, request, arg);
+  } while (result < 0 && errno == EINTR);
+  return result >= 0;
+}
+
+} // namespace dove_eye
@@ -0,0 +1,145 @@
+#include "dove_eye/mjpeg_decoder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <csetjmp>
+#include <cstdio>
+
+#include <jpeglib.h>
+
+#include "dove_eye/logging.h"
+
+namespace {
+
+/** Rows passed to libjpeg at once */
+const int kRowBatch = 16;
+
+#ifdef JCS_EXTENSIONS
+const J_COLOR_SPACE kColorSpace = JCS_EXT_BGR;
+#else
+const J_COLOR_SPACE kColorSpace = JCS_RGB;
+#endif
+
+struct ErrorManager {
+  jpeg_error_mgr pub;
+  jmp_buf jump;
+};
+
+void ErrorExit(j_common_ptr cinfo) {
+  auto error = reinterpret_cast<ErrorManager *>(cinfo->err);
+  char message[JMSG_LENGTH_MAX];
+  (*cinfo->err->format_message)(cinfo, message);
+  DEBUG("JPEG error: %s", message);
+  std::longjmp(error->jump, 1);
+}
+
+void OutputMessage(j_common_ptr cinfo) {
+  /* Warnings about slightly corrupted frames are common, ignore them */
+}
+
+/** Standard Huffman tables (JPEG Annex K) as set up by libjpeg compressor */
+struct StandardTables {
+  JHUFF_TBL dc[2];
+  JHUFF_TBL ac[2];
+
+  StandardTables() {
+    jpeg_compress_struct cinfo;
+    jpeg_error_mgr error;
+    cinfo.err = jpeg_std_error(&error);
+    jpeg_create_compress(&cinfo);
+
+    cinfo.in_color_space = JCS_YCbCr;
+    cinfo.input_components = 3;
+    jpeg_set_defaults(&cinfo);
+
+    for (int i = 0; i < 2; ++i) {
+      dc[i] = *cinfo.dc_huff_tbl_ptrs[i];
+      ac[i] = *cinfo.ac_huff_tbl_ptrs[i];
+    }
+
+    jpeg_destroy_compress(&cinfo);
+  }
+};
+
+/** Fill Huffman tables missing in the frame (typical for UVC cameras) */
+void UseStandardTables(j_decompress_ptr cinfo) {
+  static const StandardTables tables;
+
+  for (int i = 0; i < 2; ++i) {
+    if (!cinfo->dc_huff_tbl_ptrs[i]) {
+      cinfo->dc_huff_tbl_ptrs[i] =
+          jpeg_alloc_huff_table(reinterpret_cast<j_common_ptr>(cinfo));
+      *cinfo->dc_huff_tbl_ptrs[i] = tables.dc[i];
+    }
+    if (!cinfo->ac_huff_tbl_ptrs[i]) {
+      cinfo->ac_huff_tbl_ptrs[i] =
+          jpeg_alloc_huff_table(reinterpret_cast<j_common_ptr>(cinfo));
+      *cinfo->ac_huff_tbl_ptrs[i] = tables.ac[i];
+    }
+  }
+}
+
+} // namespace
+
+namespace dove_eye {
+
+bool MjpegDecoder::Decode(const uint8_t *data, const size_t size,
+                          const Options &options, cv::Mat *result) {
+  assert(result);
+  assert(options.scale_denom == 1 || options.scale_denom == 2 ||
+         options.scale_denom == 4 || options.scale_denom == 8);
+
+  jpeg_decompress_struct cinfo;
+  ErrorManager error;
+  cinfo.err = jpeg_std_error(&error.pub);
+  error.pub.error_exit = ErrorExit;
+  error.pub.output_message = OutputMessage;
+
+  /* No C++ objects with destructors may be created below */
+  if (setjmp(error.jump)) {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+  }
+
+  jpeg_create_decompress(&cinfo);
+  jpeg_mem_src(&cinfo, const_cast<uint8_t *>(data), size);
+  jpeg_read_header(&cinfo, TRUE);
+  UseStandardTables(&cinfo);
+
+  cinfo.scale_num = 1;
+  cinfo.scale_denom = options.scale_denom;
+  if (options.fast) {
+    cinfo.dct_method = JDCT_IFAST;
+    cinfo.do_fancy_upsampling = FALSE;
+  }
+
+  const bool grayscale = options.grayscale || cinfo.num_components == 1;
+  cinfo.out_color_space = grayscale ? JCS_GRAYSCALE : kColorSpace;
+
+  jpeg_start_decompress(&cinfo);
+  result->create(cinfo.output_height, cinfo.output_width,
+                 grayscale ? CV_8UC1 : CV_8UC3);
+
+  JSAMPROW rows[kRowBatch];
+  while (cinfo.output_scanline < cinfo.output_height) {
+    const int count = std::min<int>(kRowBatch,
+        cinfo.output_height - cinfo.output_scanline);
+    for (int i = 0; i < count; ++i) {
+      rows[i] = result->ptr(cinfo.output_scanline + i);
+    }
+    jpeg_read_scanlines(&cinfo, rows, count);
+  }
+
+  jpeg_finish_decompress(&cinfo);
+  jpeg_destroy_decompress(&cinfo);
+
+#ifndef JCS_EXTENSIONS
+  if (!grayscale) {
+    cv::cvtColor(*result, *result, CV_RGB2BGR);
+  }
+#endif
+
+  return true;
+}
+
+} // namespace dove_eye
@@ -0,0 +1,85 @@
+#include "dove_eye/mjpeg_frame_iterator.h"
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "dove_eye/frame_iterator/clock_policy.h"
+#include "dove_eye/logging.h"
+#include "dove_eye/mat_pool.h"
+
+using dove_eye::frame_iterator::ClockPolicy;
+
+namespace dove_eye {
+
+MjpegFrameIterator::MjpegFrameIterator(const int device, const int width,
+                                       const int height, const double fps,
+                                       const MjpegDecoder::Options &options,
+                                       WorkerPool *pool)
+    : options_(options),
+      pool_(pool),
+      capture_error_(false),
+      valid_(false) {
+  assert(pool_);
+
+  valid_ = capture_.Open(device, width, height, fps);
+  if (valid_) {
+    MoveNext();
+  }
+}
+
+void MjpegFrameIterator::MoveNext() {
+  while (valid_) {
+    if (in_flight_.empty() && (capture_error_ || !Submit(true))) {
+      valid_ = false;
+      return;
+    }
+
+    /* Start decoding of frames already waiting in the driver */
+    while (!capture_error_ && in_flight_.size() < kMaxInFlight &&
+           Submit(false)) {
+    }
+
+    frame_ = in_flight_.front().get();
+    in_flight_.pop_front();
+
+    if (!frame_.data.empty()) {
+      return;
+    }
+    DEBUG("Skipping corrupted MJPEG frame");
+  }
+}
+
+bool MjpegFrameIterator::Submit(const bool block) {
+  auto data = std::make_shared<std::vector<uint8_t>>();
+  int64_t timestamp;
+
+  switch (capture_.Grab(data.get(), &timestamp, block)) {
+    case MjpegCapture::kFrame:
+      break;
+    case MjpegCapture::kNoFrame:
+      return false;
+    case MjpegCapture::kError:
+      capture_error_ = true;
+      return false;
+  }
+
+  const auto options = options_;
+  in_flight_.push_back(pool_->Submit([data, timestamp, options]() {
+    Frame frame;
+    frame.timestamp = ClockPolicy::ToSeconds(timestamp);
+
+    MatPool::Site site("mjpeg.decode");
+    MatPool::Use(&frame.data);
+    if (!MjpegDecoder::Decode(data->data(), data->size(), options,
+                              &frame.data)) {
+      frame.data = cv::Mat();
+    }
+    return frame;
+  }));
+
+  return true;
+}
+
+} // namespace dove_eye
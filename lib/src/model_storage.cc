@@ -0,0 +1,174 @@
+#include "dove_eye/model_storage.h"
+
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "dove_eye/logging.h"
+#include "dove_eye/tracker.h"
+#include "dove_eye/types.h"
+
+namespace {
+
+/** Sanity limits against corrupted files */
+const uint32_t kMaxStringSize = 1024;
+const uint32_t kMaxMatDimension = 1 << 16;
+
+} // namespace
+
+namespace dove_eye {
+
+/* "DETM" */
+const uint32_t ModelStorage::kMagic = 0x4d544544;
+const uint32_t ModelStorage::kVersion = 1;
+
+/* Writer */
+void ModelWriter::Write(const uint32_t value) {
+  output_.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void ModelWriter::Write(const double value) {
+  output_.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void ModelWriter::Write(const std::string &value) {
+  Write(static_cast<uint32_t>(value.size()));
+  output_.write(value.data(), value.size());
+}
+
+void ModelWriter::Write(const cv::Mat &value) {
+  assert(value.dims <= 2);
+
+  Write(static_cast<uint32_t>(value.rows));
+  Write(static_cast<uint32_t>(value.cols));
+  Write(static_cast<uint32_t>(value.type()));
+
+  const size_t row_size = value.cols * value.elemSize();
+  for (int row = 0; row < value.rows; ++row) {
+    output_.write(reinterpret_cast<const char *>(value.ptr(row)), row_size);
+  }
+}
+
+/* Reader */
+bool ModelReader::Read(uint32_t *value) {
+  assert(value);
+  input_.read(reinterpret_cast<char *>(value), sizeof(*value));
+  return input_.good();
+}
+
+bool ModelReader::Read(double *value) {
+  assert(value);
+  input_.read(reinterpret_cast<char *>(value), sizeof(*value));
+  return input_.good();
+}
+
+bool ModelReader::Read(std::string *value) {
+  assert(value);
+
+  uint32_t size;
+  if (!Read(&size) || size > kMaxStringSize) {
+    return false;
+  }
+
+  std::vector<char> buffer(size);
+  input_.read(buffer.data(), size);
+  value->assign(buffer.begin(), buffer.end());
+  return input_.good();
+}
+
+bool ModelReader::Read(cv::Mat *value) {
+  assert(value);
+
+  uint32_t rows, cols, type;
+  if (!Read(&rows) || !Read(&cols) || !Read(&type)) {
+    return false;
+  }
+  if (rows > kMaxMatDimension || cols > kMaxMatDimension ||
+      CV_MAT_DEPTH(type) > CV_64F) {
+    return false;
+  }
+
+  value->create(rows, cols, type);
+  if (value->total()) {
+    input_.read(reinterpret_cast<char *>(value->data),
+                value->total() * value->elemSize());
+  }
+  return input_.good();
+}
+
+bool ModelReader::Expect(const std::string &value) {
+  std::string actual;
+  return Read(&actual) && actual == value;
+}
+
+/* Storage */
+bool ModelStorage::LoadFromFile(const std::string &filename,
+                                Tracker *tracker) {
+  assert(tracker);
+
+  std::ifstream input(filename, std::ios::binary);
+  if (!input) {
+    ERROR("Cannot open model file %s", filename.c_str());
+    return false;
+  }
+
+  ModelReader reader(input);
+  uint32_t magic, version, arity;
+  if (!reader.Read(&magic) || magic != kMagic ||
+      !reader.Read(&version) || version != kVersion) {
+    ERROR("Invalid model file %s", filename.c_str());
+    return false;
+  }
+
+  if (!reader.Read(&arity) ||
+      arity != static_cast<uint32_t>(tracker->Arity())) {
+    ERROR("Model file %s is for different number of cameras",
+          filename.c_str());
+    return false;
+  }
+
+  for (CameraIndex cam = 0; cam < tracker->Arity(); ++cam) {
+    uint32_t present;
+    if (!reader.Read(&present)) {
+      return false;
+    }
+    if (present && !tracker->LoadModel(cam, &reader)) {
+      ERROR("Invalid model of camera %i in %s", cam, filename.c_str());
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ModelStorage::SaveToFile(const std::string &filename,
+                              const Tracker &tracker) {
+  std::ofstream output(filename, std::ios::binary);
+  if (!output) {
+    ERROR("Cannot open model file %s", filename.c_str());
+    return false;
+  }
+
+  ModelWriter writer(output);
+  writer.Write(kMagic);
+  writer.Write(kVersion);
+  writer.Write(static_cast<uint32_t>(tracker.Arity()));
+
+  for (CameraIndex cam = 0; cam < tracker.Arity(); ++cam) {
+    /* Buffer it, so that unsupported tracker doesn't corrupt the file */
+    std::ostringstream buffer;
+    ModelWriter camera_writer(buffer);
+    const bool present = tracker.HasModel(cam) &&
+        tracker.SaveModel(cam, &camera_writer);
+
+    writer.Write(static_cast<uint32_t>(present));
+    if (present) {
+      output << buffer.str();
+    }
+  }
+
+  return writer.good();
+}
+
+} // namespace dove_eye
@@ -0,0 +1,341 @@
+#include "dove_eye/node_protocol.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "dove_eye/logging.h"
+
+namespace {
+
+/** Upper bound of message size (type and payload) */
+const size_t kMaxMessageSize = 256;
+
+const size_t kLengthSize = 2;
+
+/* Bits of posit flags */
+const uint8_t kPositValid = 1;
+const uint8_t kPositPredicted = 2;
+
+class Encoder {
+ public:
+  explicit Encoder(std::vector<uint8_t> *buffer)
+      : buffer_(buffer) {
+  }
+
+  void Put8(const uint8_t value) {
+    buffer_->push_back(value);
+  }
+
+  void Put32(const uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      buffer_->push_back((value >> shift) & 0xff);
+    }
+  }
+
+  void Put64(const uint64_t value) {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+      buffer_->push_back((value >> shift) & 0xff);
+    }
+  }
+
+  void PutDouble(const double value) {
+    uint64_t bits;
+    static_assert(sizeof(bits) == sizeof(value), "Unsupported double");
+    std::memcpy(&bits, &value, sizeof(bits));
+    Put64(bits);
+  }
+
+ private:
+  std::vector<uint8_t> *buffer_;
+};
+
+class Decoder {
+ public:
+  Decoder(const uint8_t *data, const size_t size)
+      : data_(data),
+        size_(size),
+        position_(0),
+        valid_(true) {
+  }
+
+  inline bool valid() const {
+    return valid_;
+  }
+
+  uint8_t Get8() {
+    return static_cast<uint8_t>(GetBytes(1));
+  }
+
+  uint32_t Get32() {
+    return static_cast<uint32_t>(GetBytes(4));
+  }
+
+  uint64_t Get64() {
+    return GetBytes(8);
+  }
+
+  double GetDouble() {
+    const uint64_t bits = Get64();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+ private:
+  const uint8_t *data_;
+  const size_t size_;
+  size_t position_;
+  bool valid_;
+
+  uint64_t GetBytes(const size_t count) {
+    if (position_ + count > size_) {
+      valid_ = false;
+      return 0;
+    }
+
+    uint64_t result = 0;
+    for (size_t i = 0; i < count; ++i) {
+      result = (result << 8) | data_[position_++];
+    }
+    return result;
+  }
+};
+
+} // namespace
+
+namespace dove_eye {
+namespace node {
+
+Connection *Connection::Connect(const std::string &host, const uint16_t port) {
+  struct addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  struct addrinfo *addresses = nullptr;
+  const auto service = std::to_string(port);
+  if (getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses) != 0) {
+    ERROR("Cannot resolve %s", host.c_str());
+    return nullptr;
+  }
+
+  int fd = -1;
+  for (auto address = addresses; address; address = address->ai_next) {
+    fd = socket(address->ai_family, address->ai_socktype,
+                address->ai_protocol);
+    if (fd < 0) {
+      continue;
+    }
+    if (connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+      break;
+    }
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(addresses);
+
+  if (fd < 0) {
+    ERROR("Cannot connect to %s:%i", host.c_str(), port);
+    return nullptr;
+  }
+
+  /* Messages are tiny and latency matters */
+  const int flag = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+  return new Connection(fd);
+}
+
+void Connection::Close() {
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+  buffer_.clear();
+}
+
+bool Connection::Send(const Message &message) {
+  std::vector<uint8_t> data(kLengthSize);
+  Encoder encoder(&data);
+
+  encoder.Put8(message.type);
+  switch (message.type) {
+    case Message::kHello:
+      encoder.Put32(message.node_id);
+      encoder.Put32(message.first_cam);
+      encoder.Put32(message.camera_count);
+      encoder.Put8(message.media_time);
+      break;
+    case Message::kPosit:
+      encoder.Put32(message.cam);
+      encoder.Put8((message.valid ? kPositValid : 0) |
+                   (message.predicted ? kPositPredicted : 0));
+      encoder.Put64(message.sequence_no);
+      encoder.PutDouble(message.timestamp);
+      encoder.PutDouble(message.x);
+      encoder.PutDouble(message.y);
+      break;
+    case Message::kPong:
+      encoder.PutDouble(message.t0);
+      encoder.PutDouble(message.t1);
+      encoder.PutDouble(message.t2);
+      break;
+    case Message::kPing:
+      encoder.PutDouble(message.t0);
+      break;
+    case Message::kInvalid:
+      assert(false);
+      return false;
+  }
+
+  const size_t length = data.size() - kLengthSize;
+  data[0] = (length >> 8) & 0xff;
+  data[1] = length & 0xff;
+
+  size_t written = 0;
+  while (written < data.size()) {
+    const ssize_t rc = send(fd_, data.data() + written, data.size() - written,
+                            MSG_NOSIGNAL);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ERROR("send: %s", strerror(errno));
+      return false;
+    }
+    written += rc;
+  }
+
+  return true;
+}
+
+bool Connection::Receive() {
+  uint8_t chunk[1024];
+
+  while (true) {
+    const ssize_t rc = recv(fd_, chunk, sizeof(chunk), MSG_DONTWAIT);
+    if (rc > 0) {
+      buffer_.insert(buffer_.end(), chunk, chunk + rc);
+    } else if (rc == 0) {
+      return false;
+    } else if (errno == EINTR) {
+      continue;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return true;
+    } else {
+      ERROR("recv: %s", strerror(errno));
+      return false;
+    }
+  }
+}
+
+bool Connection::Pop(Message *message) {
+  assert(message);
+
+  while (buffer_.size() >= kLengthSize) {
+    const size_t length = (buffer_[0] << 8) | buffer_[1];
+    if (length == 0 || length > kMaxMessageSize) {
+      ERROR("Invalid message length %zu", length);
+      Close();
+      return false;
+    }
+    if (buffer_.size() < kLengthSize + length) {
+      return false;
+    }
+
+    Decoder decoder(buffer_.data() + kLengthSize, length);
+    Message result(static_cast<Message::Type>(decoder.Get8()));
+
+    switch (result.type) {
+      case Message::kHello:
+        result.node_id = decoder.Get32();
+        result.first_cam = decoder.Get32();
+        result.camera_count = decoder.Get32();
+        result.media_time = decoder.Get8();
+        break;
+      case Message::kPosit: {
+        result.cam = decoder.Get32();
+        const uint8_t flags = decoder.Get8();
+        result.valid = flags & kPositValid;
+        result.predicted = flags & kPositPredicted;
+        result.sequence_no = decoder.Get64();
+        result.timestamp = decoder.GetDouble();
+        result.x = decoder.GetDouble();
+        result.y = decoder.GetDouble();
+        break;
+      }
+      case Message::kPong:
+        result.t0 = decoder.GetDouble();
+        result.t1 = decoder.GetDouble();
+        result.t2 = decoder.GetDouble();
+        break;
+      case Message::kPing:
+        result.t0 = decoder.GetDouble();
+        break;
+      default:
+        /* Unknown message (newer protocol), skip it */
+        result.type = Message::kInvalid;
+        break;
+    }
+
+    buffer_.erase(buffer_.begin(), buffer_.begin() + kLengthSize + length);
+
+    if (result.type != Message::kInvalid && decoder.valid()) {
+      *message = result;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+int Listen(const uint16_t port) {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    ERROR("socket: %s", strerror(errno));
+    return -1;
+  }
+
+  const int flag = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+
+  struct sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+
+  if (bind(fd, reinterpret_cast<struct sockaddr *>(&address),
+           sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+    ERROR("Cannot listen on port %i: %s", port, strerror(errno));
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+Connection *Accept(const int listen_fd) {
+  const int fd = accept(listen_fd, nullptr, nullptr);
+  if (fd < 0) {
+    ERROR("accept: %s", strerror(errno));
+    return nullptr;
+  }
+
+  const int flag = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+  return new Connection(fd);
+}
+
+} // namespace node
+} // namespace dove_eye
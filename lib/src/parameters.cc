@@ -27,8 +27,28 @@ const Parameters::Parameter Parameters::parameters[] = {
       SEARCH_KF_PROC_V,       "track.search.kf.proc_v",1e-2,     "px?",    1e-4, 1 ),
   DEFINE_PARAM(
       SEARCH_KF_OBS_V,        "track.search.kf.obs_v",  1,       "px?",    1e-2, 10 ),
+  DEFINE_PARAM(
+      CIRCLE_DETECTOR,        "track.circle.detector",   0,         "",    0, 1 ),
+  DEFINE_PARAM(
+      LOCATION_KF_PROC_V,     "track.location.kf.proc_v", 1,    "m^2/s^3", 1e-4, 100 ),
+  DEFINE_PARAM(
+      LOCATION_KF_OBS_V,      "track.location.kf.obs_v", 1e-4,    "m^2",  1e-6, 1 ),
+  DEFINE_PARAM(
+      LOCATION_TIMEOUT,       "track.location.timeout", 0.5,        "s",    0, 5 ),
+  DEFINE_PARAM(
+      TRACK_BUDGET,           "track.budget",            0,       "ms",    0, 1000 ),
+  DEFINE_PARAM(
+      LOCALIZATION_MAX_PAIRS, "localization.max_pairs",  2,  "pair(s)",    1, 100 ),
+  DEFINE_PARAM(
+      LOCALIZATION_INLIER_THR,"localization.inlier_thr", 10,       "px",  0.1, 100 ),
   DEFINE_PARAM(
       AGGREGATOR_WINDOW,      "aggregator.window",     0.1,        "s",   0, 5 ),
+  DEFINE_PARAM(
+      PLAYBACK_SNAPSHOT_PERIOD,"playback.snapshot_period", 1,      "s",    0, 60 ),
+  DEFINE_PARAM(
+      PLAYBACK_SPEED,         "playback.speed",          0,        "x",    0, 8 ),
+  DEFINE_PARAM(
+      PLAYBACK_DROP_LATE,     "playback.drop_late",      0,        "s",    0, 5 ),
   DEFINE_PARAM_ARRAY(
       CAM_OFFSET,             "aggregator.offset",       0,        "s",   0, 5 ),
   DEFINE_PARAM(
@@ -41,6 +61,12 @@ const Parameters::Parameter Parameters::parameters[] = {
       CALIBRATION_FRAMES,     "calibration.frames",     10, "frame(s)",   10, 100 ),
   DEFINE_PARAM(
       CALIBRATION_SKIP,       "calibration.skip",       15, "frame(s)",    0, 50  ),
+  DEFINE_PARAM(
+      CALIBRATION_BUNDLE,     "calibration.bundle",      1,         "",    0, 2 ),
+  DEFINE_PARAM(
+      CALIBRATION_PATTERN,    "calibration.pattern",     0,         "",    0, 1 ),
+  DEFINE_PARAM(
+      CALIBRATION_MARKER_RATIO,"calibration.marker_ratio", 0.75,    "",  0.1, 0.95 ),
   
   {Parameters::_MAX_KEY, Parameters::_MAX_KEY}
 };
@@ -0,0 +1,67 @@
+#include "dove_eye/posit_aggregator.h"
+
+#include <cassert>
+
+namespace dove_eye {
+
+PositAggregator::PositAggregator(const CameraIndex arity,
+                                 const Parameters &parameters)
+    : arity_(arity),
+      parameters_(parameters),
+      window_start_(0),
+      queues_(arity),
+      positset_(arity) {
+}
+
+bool PositAggregator::Add(const CameraIndex cam, const Posit &posit,
+                          const bool valid, const Frame::Timestamp timestamp,
+                          const bool predicted) {
+  assert(cam < arity_);
+
+  TimedPosit item;
+  item.posit = posit;
+  item.valid = valid;
+  item.predicted = predicted;
+  item.timestamp = timestamp;
+  queues_[cam].push_back(item);
+
+  const auto window_size = parameters_.Get(Parameters::AGGREGATOR_WINDOW);
+
+  /* Move the window forwards? */
+  if (timestamp > window_start_ + window_size) {
+    window_start_ = timestamp - window_size;
+    if (PreparePositset()) {
+      positset_.sequence_no += 1;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool PositAggregator::PreparePositset() {
+  bool positset_created = false;
+  for (CameraIndex cam = 0; cam < arity_; ++cam) {
+    TimedPosit last_posit;
+    bool has_posit = false;
+    while (!queues_[cam].empty() &&
+           queues_[cam].front().timestamp < window_start_) {
+      last_posit = queues_[cam].front();
+      has_posit = true;
+      queues_[cam].pop_front();
+    }
+
+    if (has_posit) {
+      positset_[cam] = last_posit.posit;
+      positset_.SetValid(cam, last_posit.valid);
+      positset_.SetPredicted(cam, last_posit.predicted);
+      positset_created = true;
+    } else {
+      positset_.SetValid(cam, false);
+    }
+  }
+
+  return positset_created;
+}
+
+} // namespace dove_eye
@@ -1,27 +1,36 @@
 #include "dove_eye/searching_tracker.h"
 
+#include <algorithm>
 
+#include "dove_eye/circle_tracker.h"
 #include "dove_eye/cv_logging.h"
+#include "dove_eye/histogram_tracker.h"
 #include "dove_eye/logging.h"
+#include "dove_eye/mat_pool.h"
+#include "dove_eye/model_storage.h"
+#include "dove_eye/template_tracker.h"
 
 namespace dove_eye {
 
-bool SearchingTracker::InitializeTracking(const Frame &frame, const Mark mark,
-                                          Posit *result) {
-  if (!InitTrackerData(frame.data, mark)) {
+template <class DerivedT>
+bool SearchingTracker<DerivedT>::InitializeTracking(const Frame &frame,
+                                                    const Mark mark,
+                                                    Posit *result) {
+  if (!derived().InitTrackerData(frame.data, mark)) {
     return false;
   }
 
   initialized(true);
 
   InitializeKalmanFilter();
-  const auto posit = MarkToPosit(mark);
-  *result = kalman_filter().Reset(frame.timestamp, posit);
+  const auto posit = derived().MarkToPosit(mark);
+  *result = FilterPosit(frame.timestamp, posit);
 
   return true;
 }
 
-bool SearchingTracker::InitializeTracking(
+template <class DerivedT>
+bool SearchingTracker<DerivedT>::InitializeTracking(
     const Frame &frame,
     const Epiline epiline,
     const TrackerData &tracker_data,
@@ -37,37 +46,40 @@ bool SearchingTracker::InitializeTracking(
   const auto thr = parameters().Get(Parameters::SEARCH_THRESHOLD);
 
   Mark match_mark;
+  /* Trackers are copies of the same implementation */
+  const auto &data =
+      static_cast<const typename DerivedT::Data &>(tracker_data);
   // TODO Remove non-const cast! Do it properly when projection is working
-  if (!Search(frame.data, (TrackerData &)tracker_data, nullptr, &epiline_mask, thr,
-              &match_mark)) {
+  if (!derived().Search(frame.data, const_cast<typename DerivedT::Data &>(data),
+                        nullptr, &epiline_mask, thr, &match_mark)) {
     return false;
   }
 
   /* Store template from current frame for future matching */
-  if (!InitTrackerData(frame.data, match_mark)) {
+  if (!derived().InitTrackerData(frame.data, match_mark)) {
     return false;
   }
   initialized(true);
 
   InitializeKalmanFilter();
-  const auto posit = MarkToPosit(match_mark);
-  *result = kalman_filter().Reset(frame.timestamp, posit);
+  const auto posit = derived().MarkToPosit(match_mark);
+  *result = FilterPosit(frame.timestamp, posit);
 
   return true;
 }
 
 
-bool SearchingTracker::Track(const Frame &frame, Posit *result) {
+template <class DerivedT>
+bool SearchingTracker<DerivedT>::Track(const Frame &frame, Posit *result) {
   assert(initialized());
 
   const auto f = parameters().Get(Parameters::SEARCH_FACTOR);
-  const auto thr = parameters().Get(Parameters::SEARCH_THRESHOLD);
   const auto min_speed = parameters().Get(Parameters::SEARCH_MIN_SPEED);
 
   /* Calculate expected position */
   auto expected = kalman_filter().Predict(frame.timestamp);
   auto velocity = kalman_filter().PredictChange(frame.timestamp);
-  const auto roi = DataToRoi(tracker_data(), expected, f);
+  const auto roi = derived().DataToRoi(derived().data(), expected, f);
   bool moving = (cv::norm(velocity) > min_speed);
   // TODO temporarily disable motion detection
   moving = false;
@@ -79,27 +91,73 @@ bool SearchingTracker::Track(const Frame &frame, Posit *result) {
         moving);
 
   /* Filter movement */
-  cv::Mat fg_mask;
-  /* 1: learn, 0: not learn */
-  bg_subtractor()(frame.data.clone(), fg_mask);
+  cv::Mat fg_mask = UpdateForeground(frame);
+  auto fg_mask_ptr = moving ? &fg_mask : nullptr;
 
-  log_mat(reinterpret_cast<size_t>(this) * 1000 + 42, fg_mask);
+  return SearchAndUpdate(frame, roi, fg_mask_ptr, result);
+}
 
-  auto fg_mask_ptr = moving ? &fg_mask : nullptr;
+template <class DerivedT>
+bool SearchingTracker<DerivedT>::Track(const Frame &frame, const Prior prior,
+                                       Posit *result) {
+  assert(initialized());
 
-  /* Search for object */
-  Mark match_mark;
-  if (!Search(frame.data, tracker_data(), &roi, fg_mask_ptr, thr, &match_mark)) {
+  const auto f = parameters().Get(Parameters::SEARCH_FACTOR);
+
+  /*
+   * Size the window so that it covers the object itself and the uncertainty
+   * of the prior. Regular window is the upper bound, otherwise the prior is
+   * not more specific than our own expectation.
+   */
+  const auto object_roi =
+      derived().DataToRoi(derived().data(), prior.center, 1);
+  const double object_radius =
+      std::max(object_roi.width, object_roi.height) / 2.0;
+  if (object_radius <= 0) {
+    return Track(frame, result);
+  }
+
+  const double prior_f = 1 + prior.radius / object_radius;
+  if (prior_f >= f) {
+    return Track(frame, result);
+  }
+
+  /* Keep image-space filter running, prior only replaces its expectation */
+  auto expected = kalman_filter().Predict(frame.timestamp);
+  const auto roi =
+      derived().DataToRoi(derived().data(), prior.center, prior_f);
+
+  DEBUG("%p->%s, prior: [%f, %f]+-%f, expected: [%f, %f]",
+        this, __func__,
+        prior.center.x, prior.center.y, prior.radius,
+        expected.x, expected.y);
+
+  (void)UpdateForeground(frame);
+
+  if (SearchAndUpdate(frame, roi, nullptr, result)) {
+    return true;
+  }
+
+  /* Prior may be wrong (e.g. bad localization), try own expectation */
+  const auto fallback_roi =
+      derived().DataToRoi(derived().data(), expected, f);
+  return SearchAndUpdate(frame, fallback_roi, nullptr, result);
+}
+
+template <class DerivedT>
+bool SearchingTracker<DerivedT>::Coast(const Frame &frame, Posit *result) {
+  /* Nothing to extrapolate from before the first observation */
+  if (!initialized() || !kalman_seeded_) {
     return false;
   }
 
-  /* Use result */
-  const auto posit = MarkToPosit(match_mark);
-  *result = kalman_filter().Update(frame.timestamp, posit);
+  *result = kalman_filter().Extrapolate(frame.timestamp);
   return true;
 }
 
-bool SearchingTracker::ReinitializeTracking(const Frame &frame, Posit *result) {
+template <class DerivedT>
+bool SearchingTracker<DerivedT>::ReinitializeTracking(const Frame &frame,
+                                                      Posit *result) {
   assert(initialized());
 
   const auto thr = parameters().Get(Parameters::SEARCH_THRESHOLD);
@@ -107,26 +165,123 @@ bool SearchingTracker::ReinitializeTracking(const Frame &frame, Posit *result) {
   // FIXME Would be expectation be of any use here?
 
   /* Assume object is moving, i.e. applying foreground mask */
+  MatPool::Site site("tracker.foreground");
   cv::Mat fg_mask;
-  bg_subtractor()(frame.data.clone(), fg_mask, -1);
+  bg_subtractor()(MatPool::Clone(frame.data), fg_mask, -1);
 
   Mark match_mark;
-  if (!Search(frame.data, tracker_data(), nullptr, &fg_mask, thr, &match_mark)) {
+  if (!derived().Search(frame.data, derived().data(), nullptr, &fg_mask, thr,
+                        &match_mark)) {
     /* Fallback without mask */
-    if (!Search(frame.data, tracker_data(), nullptr, nullptr, thr, &match_mark)) {
+    if (!derived().Search(frame.data, derived().data(), nullptr, nullptr, thr,
+                          &match_mark)) {
       return false;
     }
   }
 
-  auto posit = MarkToPosit(match_mark);
-  *result = kalman_filter().Update(frame.timestamp, posit);
+  auto posit = derived().MarkToPosit(match_mark);
+  *result = FilterPosit(frame.timestamp, posit);
   return true;
 }
 
-void SearchingTracker::InitializeKalmanFilter() {
+template <class DerivedT>
+bool SearchingTracker<DerivedT>::ReinitializeTracking(const Frame &frame,
+                                                      const Point2 guess,
+                                                      Posit *result) {
+  assert(initialized());
+
+  const auto f = parameters().Get(Parameters::SEARCH_FACTOR);
+  const auto roi = derived().DataToRoi(derived().data(), guess, f);
+
+  /* Keep learning background even when object is lost */
+  (void)UpdateForeground(frame);
+
+  return SearchAndUpdate(frame, roi, nullptr, result);
+}
+
+template <class DerivedT>
+bool SearchingTracker<DerivedT>::SaveModel(ModelWriter *writer) const {
+  assert(writer);
+  if (!initialized()) {
+    return false;
+  }
+
+  derived().SaveTrackerData(writer);
+  return writer->good();
+}
+
+template <class DerivedT>
+bool SearchingTracker<DerivedT>::LoadModel(ModelReader *reader) {
+  assert(reader);
+  if (!derived().LoadTrackerData(reader)) {
+    return false;
+  }
+
+  initialized(true);
+  InitializeKalmanFilter();
+  return true;
+}
+
+template <class DerivedT>
+void SearchingTracker<DerivedT>::DetachState() {
+  /* Kalman filter is deep-copied by its copy ctor */
+  bg_subtractor_ = cv::BackgroundSubtractorMOG();
+}
+
+template <class DerivedT>
+void SearchingTracker<DerivedT>::InitializeKalmanFilter() {
   const auto process_var = parameters().Get(Parameters::SEARCH_KF_PROC_V);
   const auto observation_var = parameters().Get(Parameters::SEARCH_KF_OBS_V);
 
   kalman_filter().Init(process_var, observation_var);
+  kalman_seeded_ = false;
 }
+
+template <class DerivedT>
+Posit SearchingTracker<DerivedT>::FilterPosit(const double time,
+                                              const Posit posit) {
+  if (!kalman_seeded_) {
+    /* No history (e.g. loaded model), don't pull the posit to the origin */
+    kalman_seeded_ = true;
+    return kalman_filter().Reset(time, posit);
+  }
+
+  return kalman_filter().Update(time, posit);
+}
+
+template <class DerivedT>
+cv::Mat SearchingTracker<DerivedT>::UpdateForeground(const Frame &frame) {
+  MatPool::Site site("tracker.foreground");
+  cv::Mat fg_mask;
+  /* 1: learn, 0: not learn */
+  bg_subtractor()(MatPool::Clone(frame.data), fg_mask);
+
+  log_mat(reinterpret_cast<size_t>(this) * 1000 + 42, fg_mask);
+  return fg_mask;
+}
+
+template <class DerivedT>
+bool SearchingTracker<DerivedT>::SearchAndUpdate(const Frame &frame,
+                                                 const cv::Rect &roi,
+                                                 const cv::Mat *mask,
+                                                 Posit *result) {
+  const auto thr = parameters().Get(Parameters::SEARCH_THRESHOLD);
+
+  /* Search for object */
+  Mark match_mark;
+  if (!derived().Search(frame.data, derived().data(), &roi, mask, thr,
+                        &match_mark)) {
+    return false;
+  }
+
+  /* Use result */
+  const auto posit = derived().MarkToPosit(match_mark);
+  *result = FilterPosit(frame.timestamp, posit);
+  return true;
+}
+
+template class SearchingTracker<CircleTracker>;
+template class SearchingTracker<HistogramTracker>;
+template class SearchingTracker<TemplateTracker>;
+
 } // end namespace dove_eye
@@ -0,0 +1,132 @@
+#include "dove_eye/shm_frame_ring.h"
+
+#include <cassert>
+#include <cstring>
+#include <new>
+
+#include "dove_eye/logging.h"
+
+namespace dove_eye {
+namespace shm {
+
+bool ValidateRing(const ShmSegment &segment) {
+  if (segment.size() < sizeof(FrameRingHeader)) {
+    return false;
+  }
+
+  auto header = static_cast<const FrameRingHeader *>(segment.address());
+  if (header->magic != kFrameRingMagic ||
+      header->version != kFrameRingVersion) {
+    ERROR("%s is not a frame ring", segment.name().c_str());
+    return false;
+  }
+
+  const uint64_t row_size = static_cast<uint64_t>(header->width) *
+      CV_ELEM_SIZE(header->type);
+  const bool consistent = header->slot_count > 0 &&
+      header->step >= row_size &&
+      header->slot_size >= kSlotDataOffset + header->height * header->step &&
+      header->data_offset >= sizeof(FrameRingHeader) &&
+      header->data_offset + header->slot_count * header->slot_size <=
+          segment.size();
+
+  if (!consistent) {
+    ERROR("Frame ring %s has inconsistent layout", segment.name().c_str());
+  }
+  return consistent;
+}
+
+bool FrameRingWriter::Create(const std::string &name, const cv::Size size,
+                             const int type, const uint32_t slot_count,
+                             const double fps) {
+  assert(slot_count > 0);
+  Close();
+
+  const uint64_t step = size.width * CV_ELEM_SIZE(type);
+  const uint64_t slot_size = AlignUp(kSlotDataOffset + size.height * step);
+  const uint64_t data_offset = AlignUp(sizeof(FrameRingHeader));
+
+  if (!segment_.Create(name, data_offset + slot_count * slot_size)) {
+    return false;
+  }
+
+  /* Construct atomics in place, fresh segment is zero filled */
+  header_ = new (segment_.address()) FrameRingHeader();
+  header_->slot_count = slot_count;
+  header_->width = size.width;
+  header_->height = size.height;
+  header_->type = type;
+  header_->step = step;
+  header_->slot_size = slot_size;
+  header_->data_offset = data_offset;
+  header_->fps = fps;
+
+  for (uint32_t i = 0; i < slot_count; ++i) {
+    auto slot = new (SlotAt(header_, i)) FrameSlotHeader();
+    slot->seq.store(kSlotEmpty);
+  }
+
+  header_->version = kFrameRingVersion;
+  /* Magic last, consumers may open the segment anytime */
+  std::atomic_thread_fence(std::memory_order_release);
+  header_->magic = kFrameRingMagic;
+
+  return true;
+}
+
+bool FrameRingWriter::Publish(const cv::Mat &frame,
+                              const uint64_t timestamp_ns) {
+  assert(header_);
+  assert(frame.type() == header_->type);
+  assert(frame.cols == static_cast<int>(header_->width));
+  assert(frame.rows == static_cast<int>(header_->height));
+
+  const uint64_t seq = header_->write_seq.load(std::memory_order_relaxed);
+  auto slot = SlotAt(header_, seq);
+  const uint64_t old_seq = slot->seq.load(std::memory_order_relaxed);
+
+  /* Announce write before checking consumer (pairs with consumer's check) */
+  slot->seq.store(kSlotWriting, std::memory_order_seq_cst);
+  const uint64_t consumed = header_->consumed.load(std::memory_order_seq_cst);
+  const uint64_t hold = header_->hold.load(std::memory_order_relaxed);
+
+  if (old_seq != kSlotEmpty && consumed > 0 &&
+      old_seq < consumed && old_seq + hold >= consumed) {
+    slot->seq.store(old_seq, std::memory_order_release);
+    header_->dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  auto data = SlotData(slot);
+  const size_t row_size = header_->width * CV_ELEM_SIZE(header_->type);
+  for (int row = 0; row < frame.rows; ++row) {
+    std::memcpy(data + row * header_->step, frame.ptr(row), row_size);
+  }
+  slot->timestamp_ns = timestamp_ns;
+
+  slot->seq.store(seq, std::memory_order_release);
+  header_->write_seq.store(seq + 1, std::memory_order_release);
+
+  header_->notify.fetch_add(1, std::memory_order_seq_cst);
+  if (header_->waiters.load(std::memory_order_seq_cst) > 0) {
+    FutexWake(&header_->notify);
+  }
+
+  return true;
+}
+
+void FrameRingWriter::Close() {
+  if (!header_) {
+    return;
+  }
+
+  header_->closed.store(1);
+  header_->notify.fetch_add(1);
+  FutexWake(&header_->notify);
+
+  header_ = nullptr;
+  segment_.Close();
+}
+
+} // namespace shm
+} // namespace dove_eye
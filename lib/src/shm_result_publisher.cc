@@ -0,0 +1,111 @@
+#include "dove_eye/shm_result_publisher.h"
+
+#include <cassert>
+#include <cstring>
+#include <new>
+
+#include "config.h"
+#include "dove_eye/shm_frame_ring.h"
+
+namespace dove_eye {
+namespace shm {
+
+static_assert(CONFIG_MAX_ARITY <= kResultMaxCameras,
+              "Result record cannot hold all cameras");
+
+bool ResultPublisher::Create(const std::string &name,
+                             const uint32_t slot_count) {
+  assert(slot_count > 0);
+
+  const uint64_t slot_offset = AlignUp(sizeof(ResultRingHeader));
+  if (!segment_.Create(name, slot_offset + slot_count * sizeof(ResultSlot))) {
+    header_ = nullptr;
+    return false;
+  }
+
+  /* Fresh segment is zero filled, i.e. all slots are empty */
+  header_ = new (segment_.address()) ResultRingHeader();
+  header_->slot_count = slot_count;
+  header_->record_size = sizeof(ResultRecord);
+  header_->slot_offset = slot_offset;
+  header_->version = kResultRingVersion;
+
+  std::atomic_thread_fence(std::memory_order_release);
+  header_->magic = kResultRingMagic;
+
+  return true;
+}
+
+void ResultPublisher::Publish(const Positset &positset,
+                              const Frame::Timestamp timestamp,
+                              const uint32_t source) {
+  ResultRecord record = ResultRecord();
+  record.sequence_no = positset.sequence_no;
+  record.timestamp = timestamp;
+  record.kind = ResultRecord::kPositset;
+  record.source = source;
+  record.arity = positset.Arity();
+
+  for (CameraIndex cam = 0; cam < positset.Arity(); ++cam) {
+    if (!positset.IsValid(cam)) {
+      continue;
+    }
+    record.valid_mask |= 1u << cam;
+    record.posits[cam][0] = positset[cam].x;
+    record.posits[cam][1] = positset[cam].y;
+  }
+
+  Publish(record);
+}
+
+void ResultPublisher::Publish(const Location &location,
+                              const uint64_t sequence_no,
+                              const Frame::Timestamp timestamp,
+                              const uint32_t source) {
+  ResultRecord record = ResultRecord();
+  record.sequence_no = sequence_no;
+  record.timestamp = timestamp;
+  record.kind = ResultRecord::kLocation;
+  record.source = source;
+  record.location[0] = location.x;
+  record.location[1] = location.y;
+  record.location[2] = location.z;
+
+  Publish(record);
+}
+
+void ResultPublisher::Publish(const ResultRecord &record) {
+  if (!header_) {
+    return;
+  }
+
+  if (shared_) {
+    std::lock_guard<std::mutex> lock(writers_mtx_);
+    Write(record);
+  } else {
+    Write(record);
+  }
+}
+
+void ResultPublisher::Write(const ResultRecord &record) {
+  uint64_t words[kRecordWords];
+  std::memcpy(words, &record, sizeof(record));
+
+  const uint64_t index = header_->write_count.load(std::memory_order_relaxed);
+  auto slot = ResultSlotAt(header_, index);
+  const uint64_t version = slot->version.load(std::memory_order_relaxed);
+
+  /* Seqlock write: odd version while the record is inconsistent */
+  slot->version.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  for (size_t i = 0; i < kRecordWords; ++i) {
+    slot->words[i].store(words[i], std::memory_order_relaxed);
+  }
+
+  slot->version.store(version + 2, std::memory_order_release);
+  header_->write_count.store(index + 1, std::memory_order_release);
+}
+
+} // namespace shm
+} // namespace dove_eye
@@ -0,0 +1,171 @@
+#include "dove_eye/shm_segment.h"
+
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "dove_eye/logging.h"
+
+namespace dove_eye {
+
+bool ShmSegment::Create(const std::string &name, const size_t size) {
+  Close();
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0 && errno == EEXIST) {
+    if (!UnlinkStale(name)) {
+      return false;
+    }
+    fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  }
+  if (fd < 0) {
+    ERROR("shm_open(%s): %s", name.c_str(), strerror(errno));
+    return false;
+  }
+
+  /* Fresh segment, nobody else can hold the lock */
+  if (flock(fd, LOCK_EX | LOCK_NB) != 0 ||
+      ftruncate(fd, size) != 0) {
+    ERROR("Cannot set up shm segment %s: %s", name.c_str(), strerror(errno));
+    close(fd);
+    shm_unlink(name.c_str());
+    return false;
+  }
+
+  if (!Map(fd, size)) {
+    close(fd);
+    shm_unlink(name.c_str());
+    return false;
+  }
+
+  name_ = name;
+  owner_ = true;
+  owner_fd_ = fd;
+  return true;
+}
+
+bool ShmSegment::Open(const std::string &name) {
+  Close();
+
+  const int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    ERROR("shm_open(%s): %s", name.c_str(), strerror(errno));
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ERROR("Invalid shm segment %s", name.c_str());
+    close(fd);
+    return false;
+  }
+
+  const bool result = Map(fd, st.st_size);
+  close(fd);
+
+  if (result) {
+    name_ = name;
+    owner_ = false;
+  }
+  return result;
+}
+
+void ShmSegment::Close() {
+  if (address_) {
+    munmap(address_, size_);
+    address_ = nullptr;
+    size_ = 0;
+  }
+
+  if (owner_) {
+    shm_unlink(name_.c_str());
+    owner_ = false;
+  }
+
+  if (owner_fd_ >= 0) {
+    close(owner_fd_);
+    owner_fd_ = -1;
+  }
+}
+
+bool ShmSegment::UnlinkStale(const std::string &name) {
+  const int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    /* Vanished meanwhile, creation can be retried */
+    return errno == ENOENT;
+  }
+
+  /*
+   * Owner locks the segment right after creating it, an empty segment may
+   * be just being created, though.
+   */
+  struct stat st;
+  bool stale = false;
+  if (flock(fd, LOCK_EX | LOCK_NB) == 0) {
+    stale = (fstat(fd, &st) == 0 && st.st_size > 0);
+  }
+
+  if (stale) {
+    DEBUG("Replacing stale shm segment %s", name.c_str());
+    shm_unlink(name.c_str());
+  } else {
+    ERROR("shm segment %s is used by another process", name.c_str());
+  }
+
+  /* Closing releases our lock */
+  close(fd);
+  return stale;
+}
+
+bool ShmSegment::Map(const int fd, const size_t size) {
+  void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       fd, 0);
+  if (address == MAP_FAILED) {
+    ERROR("mmap: %s", strerror(errno));
+    return false;
+  }
+
+  address_ = address;
+  size_ = size;
+  return true;
+}
+
+uint64_t MonotonicNanoseconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+/*
+ * std::atomic<uint32_t> is lock-free and has the same representation as
+ * uint32_t on Linux, so it can serve as a futex word.
+ * Waits are shared (not FUTEX_PRIVATE_FLAG) as the word lives in shm.
+ */
+bool FutexWait(std::atomic<uint32_t> *word, const uint32_t expected,
+               const double timeout) {
+  struct timespec ts;
+  double seconds;
+  ts.tv_nsec = static_cast<long>(std::modf(timeout, &seconds) * 1e9);
+  ts.tv_sec = static_cast<time_t>(seconds);
+
+  const long rc = syscall(SYS_futex, reinterpret_cast<uint32_t *>(word),
+                          FUTEX_WAIT, expected, &ts, nullptr, 0);
+  return !(rc != 0 && errno == ETIMEDOUT);
+}
+
+void FutexWake(std::atomic<uint32_t> *word) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, INT_MAX,
+          nullptr, nullptr, 0);
+}
+
+} // namespace dove_eye
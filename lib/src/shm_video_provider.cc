@@ -0,0 +1,165 @@
+#include "dove_eye/shm_video_provider.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "dove_eye/frame_iterator/clock_policy.h"
+#include "dove_eye/logging.h"
+#include "dove_eye/mat_pool.h"
+#include "dove_eye/shm_frame_ring.h"
+
+namespace {
+
+/** Granularity of checking for finished producer */
+const double kWaitPeriod = 0.1;
+
+} // namespace
+
+namespace dove_eye {
+
+using frame_iterator::ClockPolicy;
+using shm::FrameRingHeader;
+using shm::FrameSlotHeader;
+
+class ShmFrameIterator : public FrameIteratorImpl {
+ public:
+  ShmFrameIterator(ShmSegment *segment, const uint32_t hold,
+                   const double timeout)
+      : header_(static_cast<FrameRingHeader *>(segment->address())),
+        timeout_(timeout),
+        lapped_(0),
+        valid_(true) {
+    const uint32_t max_hold = std::max(1u, header_->slot_count - 1);
+    const uint32_t actual_hold = hold ? hold : header_->slot_count / 2;
+    header_->hold.store(std::min(std::max(1u, actual_hold), max_hold));
+    header_->consumed.store(0);
+
+    /* Live source, start with the newest frame */
+    const auto written = header_->write_seq.load(std::memory_order_acquire);
+    next_seq_ = written ? written - 1 : 0;
+
+    MoveNext();
+  }
+
+  ~ShmFrameIterator() override {
+    /* Release all held frames */
+    header_->consumed.store(0);
+  }
+
+  /** Frame data is a copy of the slot (from MatPool) */
+  inline Frame GetFrame() const override {
+    return frame_;
+  }
+
+  void MoveNext() override;
+
+  inline bool IsValid() override {
+    return valid_;
+  }
+
+ private:
+  FrameRingHeader *header_;
+  const double timeout_;
+
+  uint64_t next_seq_;
+  uint64_t lapped_;
+  bool valid_;
+  Frame frame_;
+
+  bool WaitForFrame();
+};
+
+void ShmFrameIterator::MoveNext() {
+  while (valid_) {
+    const auto written = header_->write_seq.load(std::memory_order_acquire);
+    if (written <= next_seq_) {
+      valid_ = WaitForFrame();
+      continue;
+    }
+
+    const uint64_t seq = next_seq_;
+    auto slot = shm::SlotAt(header_, seq);
+
+    /* Protect the frame, then check it wasn't overwritten meanwhile */
+    header_->consumed.store(seq + 1, std::memory_order_seq_cst);
+    if (slot->seq.load(std::memory_order_seq_cst) != seq) {
+      /* Lapped by producer, skip to the newest frame */
+      lapped_ += written - 1 - seq;
+      DEBUG("shm consumer lapped, %lu frame(s) lost",
+            static_cast<unsigned long>(lapped_));
+      next_seq_ = std::max(written - 1, seq + 1);
+      continue;
+    }
+
+    /*
+     * Copy while the slot is protected, holders of the frame (queues of
+     * policies and aggregator, GUI) keep it longer than the ring would.
+     */
+    const cv::Mat view(header_->height, header_->width, header_->type,
+                       shm::SlotData(slot), header_->step);
+    MatPool::Site site("shm");
+    frame_.data = MatPool::Clone(view);
+    /* Same epoch as other cameras, so that they're aggregated together */
+    frame_.timestamp = ClockPolicy::ToSeconds(ClockPolicy::FromSteady(
+        static_cast<ClockPolicy::Nanoseconds>(slot->timestamp_ns)));
+    next_seq_ = seq + 1;
+    return;
+  }
+}
+
+/**
+ * @return  false when stream ended (producer closed or timed out)
+ */
+bool ShmFrameIterator::WaitForFrame() {
+  double waited = 0;
+
+  while (waited < timeout_) {
+    const auto notify = header_->notify.load(std::memory_order_seq_cst);
+    if (header_->write_seq.load(std::memory_order_acquire) > next_seq_) {
+      return true;
+    }
+    if (header_->closed.load()) {
+      return false;
+    }
+
+    header_->waiters.fetch_add(1, std::memory_order_seq_cst);
+    if (FutexWait(&header_->notify, notify, kWaitPeriod)) {
+      waited = 0;
+    } else {
+      waited += kWaitPeriod;
+    }
+    header_->waiters.fetch_sub(1, std::memory_order_seq_cst);
+  }
+
+  ERROR("No frame from shm producer for %f s", timeout_);
+  return false;
+}
+
+/* Provider */
+ShmVideoProvider::ShmVideoProvider(const std::string &name,
+                                   const uint32_t hold,
+                                   const double timeout)
+    : VideoProvider(),
+      name_(name),
+      hold_(hold),
+      timeout_(timeout) {
+}
+
+FrameIterator ShmVideoProvider::begin() {
+  if (!segment_.IsOpen() && !segment_.Open(name_)) {
+    return end();
+  }
+
+  if (!shm::ValidateRing(segment_)) {
+    segment_.Close();
+    return end();
+  }
+
+  return FrameIterator(this, new ShmFrameIterator(&segment_, hold_, timeout_));
+}
+
+FrameIterator ShmVideoProvider::end() {
+  return FrameIterator(this);
+}
+
+} // namespace dove_eye
@@ -0,0 +1,239 @@
+#include "dove_eye/tee_video_provider.h"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dove_eye/logging.h"
+#include "dove_eye/mat_pool.h"
+#include "dove_eye/metrics.h"
+
+namespace dove_eye {
+
+/** Queue of single iterator */
+struct TeeQueue {
+  size_t depth;
+  TeeVideoProvider::DropPolicy policy;
+  std::string dropped_metric;
+  std::deque<Frame> frames;
+};
+
+/** Capture thread and queues of all branches */
+class TeeVideoProvider::Hub {
+ public:
+  explicit Hub(VideoProvider *source)
+      : source_(source),
+        branches_(1),
+        started_(false),
+        finished_(false),
+        stop_(false) {
+    assert(source_);
+  }
+
+  ~Hub() {
+    {
+      Lock lock(mtx_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  inline std::string SourceId() const {
+    return source_->Id();
+  }
+
+  inline size_t AddBranch() {
+    Lock lock(mtx_);
+    return branches_++;
+  }
+
+  /** Register queue and start capture when it's the first one */
+  void Subscribe(TeeQueue *queue);
+
+  void Unsubscribe(TeeQueue *queue);
+
+  /** Wait for frame in the queue
+   *
+   * @return  false when the source ended
+   */
+  bool Pop(TeeQueue *queue, Frame *frame);
+
+ private:
+  typedef std::unique_lock<std::mutex> Lock;
+
+  std::unique_ptr<VideoProvider> source_;
+
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::vector<TeeQueue *> queues_;
+  size_t branches_;
+  bool started_;
+  bool finished_;
+  bool stop_;
+
+  std::thread thread_;
+
+  void Capture();
+
+  void Deliver(const Frame &frame);
+};
+
+void TeeVideoProvider::Hub::Subscribe(TeeQueue *queue) {
+  Lock lock(mtx_);
+  queues_.push_back(queue);
+
+  if (!started_) {
+    started_ = true;
+    thread_ = std::thread(&Hub::Capture, this);
+  }
+}
+
+void TeeVideoProvider::Hub::Unsubscribe(TeeQueue *queue) {
+  Lock lock(mtx_);
+  queues_.erase(std::remove(queues_.begin(), queues_.end(), queue),
+                queues_.end());
+}
+
+bool TeeVideoProvider::Hub::Pop(TeeQueue *queue, Frame *frame) {
+  Lock lock(mtx_);
+  cv_.wait(lock, [&] {
+           return !queue->frames.empty() || finished_ || stop_;
+           });
+
+  if (queue->frames.empty()) {
+    return false;
+  }
+
+  *frame = std::move(queue->frames.front());
+  queue->frames.pop_front();
+  return true;
+}
+
+void TeeVideoProvider::Hub::Capture() {
+  MatPool::Site site("tee");
+
+  auto it = source_->begin();
+  const auto end = source_->end();
+  for (; it != end; ++it) {
+    {
+      Lock lock(mtx_);
+      if (stop_) {
+        break;
+      }
+    }
+
+    /* Source may reuse its buffer, branches share single copy */
+    Frame frame = (*it).Clone();
+    Deliver(frame);
+  }
+
+  {
+    Lock lock(mtx_);
+    finished_ = true;
+  }
+  cv_.notify_all();
+  DEBUG("Tee of %s finished", source_->Id().c_str());
+}
+
+void TeeVideoProvider::Hub::Deliver(const Frame &frame) {
+  {
+    Lock lock(mtx_);
+    for (auto queue : queues_) {
+      if (queue->frames.size() < queue->depth) {
+        queue->frames.push_back(frame);
+        continue;
+      }
+
+      Metrics::Global().Add(queue->dropped_metric);
+      if (queue->policy == kDropOldest) {
+        queue->frames.pop_front();
+        queue->frames.push_back(frame);
+      }
+    }
+  }
+  cv_.notify_all();
+}
+
+class TeeVideoProvider::Iterator : public FrameIteratorImpl {
+ public:
+  Iterator(const std::shared_ptr<Hub> &hub, const std::string &id,
+           const size_t depth, const DropPolicy policy)
+      : hub_(hub),
+        valid_(true) {
+    queue_.depth = std::max(static_cast<size_t>(1), depth);
+    queue_.policy = policy;
+    queue_.dropped_metric = "tee." + id + ".dropped";
+
+    hub_->Subscribe(&queue_);
+    MoveNext();
+  }
+
+  ~Iterator() override {
+    hub_->Unsubscribe(&queue_);
+  }
+
+  inline Frame GetFrame() const override {
+    return frame_;
+  }
+
+  inline void MoveNext() override {
+    valid_ = valid_ && hub_->Pop(&queue_, &frame_);
+  }
+
+  inline bool IsValid() override {
+    return valid_;
+  }
+
+ private:
+  std::shared_ptr<Hub> hub_;
+  TeeQueue queue_;
+  bool valid_;
+  Frame frame_;
+};
+
+TeeVideoProvider::TeeVideoProvider(VideoProvider *source, const size_t depth,
+                                   const DropPolicy policy)
+    : hub_(std::make_shared<Hub>(source)),
+      branch_(0),
+      depth_(depth),
+      policy_(policy) {
+}
+
+TeeVideoProvider::TeeVideoProvider(const std::shared_ptr<Hub> &hub,
+                                   const size_t branch, const size_t depth,
+                                   const DropPolicy policy)
+    : hub_(hub),
+      branch_(branch),
+      depth_(depth),
+      policy_(policy) {
+}
+
+TeeVideoProvider *TeeVideoProvider::Branch(const size_t depth,
+                                           const DropPolicy policy) const {
+  return new TeeVideoProvider(hub_, hub_->AddBranch(), depth, policy);
+}
+
+std::string TeeVideoProvider::Id() const {
+  if (branch_ == 0) {
+    return hub_->SourceId();
+  }
+  return hub_->SourceId() + "#" + std::to_string(branch_);
+}
+
+FrameIterator TeeVideoProvider::begin() {
+  return FrameIterator(this, new Iterator(hub_, Id(), depth_, policy_));
+}
+
+FrameIterator TeeVideoProvider::end() {
+  return FrameIterator(this);
+}
+
+} // namespace dove_eye
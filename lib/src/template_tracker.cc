@@ -5,11 +5,18 @@
 #include "config.h"
 #include "dove_eye/cv_logging.h"
 #include "dove_eye/logging.h"
+#include "dove_eye/model_storage.h"
 
 using cv::matchTemplate;
 using cv::meanStdDev;
 using cv::minMaxLoc;
 
+namespace {
+
+const char kModelTag[] = "template";
+
+} // namespace
+
 namespace dove_eye {
 
 bool TemplateTracker::InitTrackerData(const cv::Mat &data, const Mark &mark) {
@@ -35,17 +42,34 @@ bool TemplateTracker::InitTrackerData(const cv::Mat &data, const Mark &mark) {
   return true;
 }
 
+void TemplateTracker::SaveTrackerData(ModelWriter *writer) const {
+  writer->Write(kModelTag);
+  writer->Write(data_.radius);
+  writer->Write(data_.search_template);
+}
+
+bool TemplateTracker::LoadTrackerData(ModelReader *reader) {
+  TemplateData data;
+  if (!reader->Expect(kModelTag) ||
+      !reader->Read(&data.radius) ||
+      !reader->Read(&data.search_template)) {
+    return false;
+  }
+
+  data_ = data;
+  return true;
+}
+
 /** Wrapper for OpenCV function matchTemplate
  * @see SearchingTracker::Search()
  */
 bool TemplateTracker::Search(
       const cv::Mat &data,
-      TrackerData &tracker_data,
+      TemplateData &tpl,
       const cv::Rect *roi,
       const cv::Mat *mask,
       const double threshold,
       Mark *result) const {
-  const TemplateData &tpl = static_cast<const TemplateData &>(tracker_data);
 
   DEBUG("%p->%s([%i, %i], %f, %p[%i, %i]@[%i, %i], %p, %f, res)",
         this, __func__,
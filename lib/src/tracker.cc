@@ -1,12 +1,18 @@
 #include "dove_eye/tracker.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <utility>
 
 #include <opencv2/opencv.hpp>
 
 #include "dove_eye/camera_pair.h"
+#include "dove_eye/circle_tracker.h"
+#include "dove_eye/histogram_tracker.h"
 #include "dove_eye/logging.h"
+#include "dove_eye/metrics.h"
+#include "dove_eye/template_tracker.h"
 
 using cv::computeCorrespondEpilines;
 using cv::projectPoints;
@@ -14,14 +20,21 @@ using cv::undistortPoints;
 
 namespace dove_eye {
 
-Tracker::Tracker(const CameraIndex arity, const InnerTracker &inner_tracker)
+template <class InnerTrackerT>
+BasicTracker<InnerTrackerT>::BasicTracker(
+    const CameraIndex arity,
+    const InnerTrackerT &inner_tracker,
+    const Parameters &parameters)
     : arity_(arity),
+      parameters_(parameters),
       positset_(arity_),
       trackstates_(arity_, kUninitialized),
       trackers_(arity_),
       distorted_input_(false),
       calibration_data_(nullptr),
-      location_valid_(false) {
+      location_valid_(false),
+      time_(0),
+      scheduler_(arity, parameters) {
   for (CameraIndex cam = 0; cam < arity_; ++cam) {
     trackers_[cam] = std::move(InnerTrackerPtr(inner_tracker.Clone()));
   }
@@ -31,8 +44,12 @@ Tracker::Tracker(const CameraIndex arity, const InnerTracker &inner_tracker)
 /**
  * @return  true when mark is accepted, false otherwise
  */
-Positset Tracker::SetMark(const Frameset &frameset, const CameraIndex cam,
-                      const InnerTracker::Mark mark, bool project_other) {
+template <class InnerTrackerT>
+Positset BasicTracker<InnerTrackerT>::SetMark(
+    const Frameset &frameset,
+    const CameraIndex cam,
+    const InnerTracker::Mark mark,
+    bool project_other) {
   assert(cam < arity_);
 
   auto tracker = trackers_[cam].get();
@@ -72,17 +89,154 @@ Positset Tracker::SetMark(const Frameset &frameset, const CameraIndex cam,
   return positset_;
 }
 
-Positset Tracker::Track(const Frameset &frameset) {
+template <class InnerTrackerT>
+Positset BasicTracker<InnerTrackerT>::Track(const Frameset &frameset) {
   assert(frameset.Arity() == arity_);
 
+  /* Frames of the frameset are close in time, use the latest one */
   for (CameraIndex cam = 0; cam < arity_; ++cam) {
-    (void)TrackSingle(cam, frameset[cam]);
+    if (frameset.IsValid(cam)) {
+      time_ = std::max(time_, frameset[cam].timestamp);
+    }
+  }
+
+  positset_.sequence_no = frameset.sequence_no;
+
+  const bool use_prior = LocationPredictable();
+  const auto &selection = scheduler_.Schedule();
+
+  double total_cost = 0;
+  for (CameraIndex cam = 0; cam < arity_; ++cam) {
+    if (!selection[cam]) {
+      (void)CoastSingle(cam, frameset[cam]);
+      continue;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const bool success = TrackSingle(cam, frameset[cam], use_prior);
+    const std::chrono::duration<double> cost =
+        std::chrono::steady_clock::now() - start;
+
+    scheduler_.Report(cam, success, cost.count());
+    total_cost += cost.count();
   }
 
+  auto &metrics = Metrics::Global();
+  metrics.Add(metrics_prefix_ + "tracker.framesets");
+  metrics.Add(metrics_prefix_ + "tracker.posits", positset_.ValidCount());
+  metrics.Set(metrics_prefix_ + "tracker.track_time", total_cost);
+
   return positset_;
 }
 
-bool Tracker::TrackSingle(const CameraIndex cam, const Frame &frame) {
+template <class InnerTrackerT>
+typename BasicTracker<InnerTrackerT>::Snapshot *
+BasicTracker<InnerTrackerT>::SaveSnapshot() const {
+  std::unique_ptr<Snapshot> snapshot(new Snapshot(arity_));
+
+  for (CameraIndex cam = 0; cam < arity_; ++cam) {
+    snapshot->trackers[cam].reset(trackers_[cam]->CloneState());
+    if (!snapshot->trackers[cam]) {
+      return nullptr;
+    }
+  }
+
+  snapshot->positset = positset_;
+  snapshot->trackstates = trackstates_;
+  snapshot->location = location_;
+  snapshot->location_valid = location_valid_;
+  snapshot->location_filter = location_filter_;
+  snapshot->time = time_;
+
+  return snapshot.release();
+}
+
+template <class InnerTrackerT>
+bool BasicTracker<InnerTrackerT>::RestoreSnapshot(
+    const Snapshot &snapshot) {
+  assert(snapshot.trackers.size() == arity_);
+
+  /* Clone again, the snapshot must stay intact for next restore */
+  TrackerVector trackers(arity_);
+  for (CameraIndex cam = 0; cam < arity_; ++cam) {
+    trackers[cam].reset(snapshot.trackers[cam]->CloneState());
+    if (!trackers[cam]) {
+      return false;
+    }
+  }
+
+  trackers_.swap(trackers);
+  positset_ = snapshot.positset;
+  trackstates_ = snapshot.trackstates;
+  location_ = snapshot.location;
+  location_valid_ = snapshot.location_valid;
+  location_filter_ = snapshot.location_filter;
+  time_ = snapshot.time;
+
+  return true;
+}
+
+template <class InnerTrackerT>
+bool BasicTracker<InnerTrackerT>::HasModel(const CameraIndex cam) const {
+  assert(cam < arity_);
+  return trackstates_[cam] != kUninitialized;
+}
+
+template <class InnerTrackerT>
+bool BasicTracker<InnerTrackerT>::SaveModel(const CameraIndex cam,
+                                            ModelWriter *writer) const {
+  assert(cam < arity_);
+  return trackers_[cam]->SaveModel(writer);
+}
+
+template <class InnerTrackerT>
+bool BasicTracker<InnerTrackerT>::LoadModel(const CameraIndex cam,
+                                            ModelReader *reader) {
+  assert(cam < arity_);
+
+  if (!trackers_[cam]->LoadModel(reader)) {
+    return false;
+  }
+
+  trackstates_[cam] = kLost;
+  positset_.SetValid(cam, false);
+  return true;
+}
+
+template <class InnerTrackerT>
+bool BasicTracker<InnerTrackerT>::SetLocation(const Location location) {
+  location_ = location;
+  location_valid_ = true;
+
+  if (LocationPredictable()) {
+    location_filter_.Update(time_, location);
+  } else {
+    /* Start over (with current parameters) */
+    location_filter_.Init(parameters_.Get(Parameters::LOCATION_KF_PROC_V),
+                          parameters_.Get(Parameters::LOCATION_KF_OBS_V));
+    location_filter_.Reset(time_, location);
+  }
+
+  return true;
+}
+
+template <class InnerTrackerT>
+void BasicTracker<InnerTrackerT>::Reacquire(const CameraIndex cam) {
+  assert(cam < arity_);
+
+  if (trackstates_[cam] != kTracking) {
+    return;
+  }
+
+  DEBUG("tracker(%i) forced to re-acquire", cam);
+  trackstates_[cam] = kLost;
+  positset_.SetValid(cam, false);
+}
+
+template <class InnerTrackerT>
+bool BasicTracker<InnerTrackerT>::TrackSingle(const CameraIndex cam,
+                                              const Frame &frame,
+                                              const bool use_prior) {
 		//std::cout << "tracking camera " << cam << " state " << trackstates_[cam] << "\n";
 	
   auto tracker = trackers_[cam].get();
@@ -96,7 +250,15 @@ bool Tracker::TrackSingle(const CameraIndex cam, const Frame &frame) {
     }
 
     case kTracking: {
-      if (!tracker->Track(frame, &positset_[cam])) {
+      InnerTracker::Prior prior;
+      bool success;
+      if (use_prior && ProjectPrior(cam, &prior)) {
+        success = tracker->Track(frame, prior, &positset_[cam]);
+      } else {
+        success = tracker->Track(frame, &positset_[cam]);
+      }
+
+      if (!success) {
         trackstates_[cam] = kLost;
         DEBUG("tracker(%i) lost", cam);
         positset_.SetValid(cam, false);
@@ -107,9 +269,10 @@ bool Tracker::TrackSingle(const CameraIndex cam, const Frame &frame) {
 
     case kLost: {
       /* First try re-initialization from knowledge of projection */
-      if (location_valid_) {
-        auto guess = ReprojectLocation(location_, cam);
-        if (tracker->ReinitializeTracking(frame, guess, &positset_[cam])) {
+      InnerTracker::Prior prior;
+      if (use_prior && ProjectPrior(cam, &prior)) {
+        if (tracker->ReinitializeTracking(frame, prior.center,
+                                          &positset_[cam])) {
           trackstates_[cam] = kTracking;
           DEBUG("tracker(%i) found from projection", cam);
           positset_.SetValid(cam, true);
@@ -132,7 +295,7 @@ bool Tracker::TrackSingle(const CameraIndex cam, const Frame &frame) {
           break;
         }
       }
-      if (exists_posit) {
+      if (exists_posit && calibration_data_) {
         auto epiline = CalculateEpiline(positset_[o_cam], o_cam, cam);
         if (tracker->ReinitializeTracking(frame, epiline, &positset_[cam])) {
           trackstates_[cam] = kTracking;
@@ -168,7 +331,81 @@ bool Tracker::TrackSingle(const CameraIndex cam, const Frame &frame) {
   return positset_.IsValid(cam);
 }
 
-Point2 Tracker::Undistort(const Point2 &point, const CameraIndex cam) const {
+/** Skipped camera keeps its state and posit is only predicted
+ *
+ * Predicted posit is flagged, so that localization doesn't take it for an
+ * observation.
+ *
+ * @note Frame is used for its timestamp only.
+ */
+template <class InnerTrackerT>
+bool BasicTracker<InnerTrackerT>::CoastSingle(const CameraIndex cam,
+                                              const Frame &frame) {
+  if (trackstates_[cam] != kTracking) {
+    positset_.SetValid(cam, false);
+    return false;
+  }
+
+  auto success = trackers_[cam]->Coast(frame, &positset_[cam]);
+  positset_.SetValid(cam, success);
+  positset_.SetPredicted(cam, success);
+
+  if (success && distorted_input()) {
+    positset_[cam] = Undistort(positset_[cam], cam);
+  }
+
+  return success;
+}
+
+/** Check whether location filter is recent enough to predict
+ */
+template <class InnerTrackerT>
+bool BasicTracker<InnerTrackerT>::LocationPredictable() const {
+  if (!location_valid_ || !location_filter_.initialized() ||
+      !calibration_data_) {
+    return false;
+  }
+
+  const auto timeout = parameters_.Get(Parameters::LOCATION_TIMEOUT);
+  return (time_ - location_filter_.time()) <= timeout;
+}
+
+/** Project predicted location and its uncertainty into camera image
+ *
+ * @return  false when location is not in front of the camera
+ */
+template <class InnerTrackerT>
+bool BasicTracker<InnerTrackerT>::ProjectPrior(
+    const CameraIndex cam,
+    InnerTracker::Prior *prior) const {
+  assert(calibration_data_);
+  assert(prior);
+
+  const auto location = location_filter_.Predict(time_);
+  const auto deviation = location_filter_.PredictDeviation(time_);
+
+  /* Depth of location in camera coordinates */
+  const cv::Mat &R = calibration_data_->CameraRotation(cam);
+  const cv::Mat &t = calibration_data_->CameraTranslation(cam);
+  cv::Vec3d world_point(location.x, location.y, location.z);
+  cv::Mat camera_point = R * cv::Mat(world_point) + t;
+  const double depth = camera_point.at<double>(2);
+  if (depth <= 0) {
+    return false;
+  }
+
+  /* Three sigma interval at the depth of the object */
+  auto &C = calibration_data_->camera_parameters(cam).camera_matrix;
+  const double focal = std::max(C.at<double>(0, 0), C.at<double>(1, 1));
+
+  prior->center = ReprojectLocation(location, cam);
+  prior->radius = focal * 3 * deviation / depth;
+  return true;
+}
+
+template <class InnerTrackerT>
+Point2 BasicTracker<InnerTrackerT>::Undistort(const Point2 &point,
+                                              const CameraIndex cam) const {
   assert(calibration_data_);
   // TODO verify this routine
 
@@ -180,7 +417,8 @@ Point2 Tracker::Undistort(const Point2 &point, const CameraIndex cam) const {
   return Point2(result);
 }
 
-InnerTracker::Epiline Tracker::CalculateEpiline(
+template <class InnerTrackerT>
+InnerTracker::Epiline BasicTracker<InnerTrackerT>::CalculateEpiline(
       const Posit posit,
       const CameraIndex marked_cam,
       const CameraIndex cam) const {
@@ -199,8 +437,10 @@ InnerTracker::Epiline Tracker::CalculateEpiline(
 }
 
 
-Point2 Tracker::ReprojectLocation(const Location location,
-                                       const CameraIndex cam) const {
+template <class InnerTrackerT>
+Point2 BasicTracker<InnerTrackerT>::ReprojectLocation(
+    const Location location,
+    const CameraIndex cam) const {
   assert(calibration_data_);
 
   Point3Vector object_points({static_cast<Point3>(location)});
@@ -221,4 +461,13 @@ Point2 Tracker::ReprojectLocation(const Location location,
   return image_points.front();
 }
 
+/*
+ * Implementations are instantiated here, static ones for builds that pin
+ * inner tracker (see static_tracker.h).
+ */
+template class BasicTracker<InnerTracker>;
+template class BasicTracker<CircleTracker>;
+template class BasicTracker<HistogramTracker>;
+template class BasicTracker<TemplateTracker>;
+
 } // namespace dove_eye
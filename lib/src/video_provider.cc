@@ -4,6 +4,8 @@
 
 #include <opencv2/opencv.hpp>
 
+#include "dove_eye/mat_pool.h"
+
 namespace dove_eye {
 
 void VideoProvider::PreprocessFrame(Frame *frame) const {
@@ -12,7 +14,9 @@ void VideoProvider::PreprocessFrame(Frame *frame) const {
   }
 
   assert(camera_parameters());
+  MatPool::Site site("undistort");
   cv::Mat undistored;
+  MatPool::Use(&undistored);
   cv::undistort(frame->data, undistored,
                 camera_parameters()->camera_matrix,
                 camera_parameters()->distortion_coefficients);
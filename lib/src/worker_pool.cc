@@ -0,0 +1,61 @@
+#include "dove_eye/worker_pool.h"
+
+#include <algorithm>
+
+namespace dove_eye {
+
+WorkerPool::WorkerPool(const size_t threads)
+    : stop_(false) {
+  const size_t count = threads ? threads :
+      std::max(1u, std::thread::hardware_concurrency());
+
+  for (size_t i = 0; i < count; ++i) {
+    threads_.push_back(std::thread(&WorkerPool::Run, this));
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    Lock lock(mtx_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+WorkerPool &WorkerPool::Shared() {
+  static WorkerPool pool;
+  return pool;
+}
+
+void WorkerPool::Enqueue(Task task) {
+  {
+    Lock lock(mtx_);
+    tasks_.push(std::move(task));
+  }
+  cv_.notify_one();
+}
+
+void WorkerPool::Run() {
+  while (true) {
+    Task task;
+    {
+      Lock lock(mtx_);
+      cv_.wait(lock, [&] { return stop_ || !tasks_.empty(); });
+
+      /* Finish queued tasks, somebody may wait for them */
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop();
+    }
+
+    task();
+  }
+}
+
+} // namespace dove_eye
@@ -0,0 +1,395 @@
+/** Segment-parallel offline tracking
+ *
+ * Recording is split into overlapping time segments that are tracked
+ * independently (each on its own core). Trackers are seeded by marks on the
+ * first frameset of the recording and each segment starts by re-acquiring
+ * the object. Segment trajectories are then stitched in the overlaps where
+ * they agree.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "dove_eye/blocking_policy.h"
+#include "dove_eye/calibration_data.h"
+#include "dove_eye/calibration_storage.h"
+#include "dove_eye/file_video_provider.h"
+#include "dove_eye/frameset.h"
+#include "dove_eye/frameset_aggregator.h"
+#include "dove_eye/localization.h"
+#include "dove_eye/location.h"
+#include "dove_eye/logging.h"
+#include "dove_eye/parameters.h"
+#include "dove_eye/static_tracker.h"
+#include "dove_eye/types.h"
+#include "tool_options.h"
+
+using dove_eye::Aggregator;
+using dove_eye::BlockingPolicy;
+using dove_eye::CalibrationData;
+using dove_eye::CalibrationStorage;
+using dove_eye::CameraIndex;
+using dove_eye::CreateStaticInnerTracker;
+using dove_eye::FileVideoProvider;
+using dove_eye::Frame;
+using dove_eye::Frameset;
+using dove_eye::FramesetAggregator;
+using dove_eye::InnerTracker;
+using dove_eye::Localization;
+using dove_eye::Location;
+using dove_eye::Parameters;
+using dove_eye::StaticInnerTracker;
+using dove_eye::StaticTracker;
+
+using tools::ParseMark;
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace {
+
+/** Timestamps of the same frame in different segments are equal up to this */
+const double kTimeTolerance = 1e-4;
+
+typedef std::map<Frame::Timestamp, Location> Trajectory;
+
+struct Options {
+  string tracker = dove_eye::kDefaultStaticTracker;
+  size_t jobs = 0;
+  /* Segment length and overlap (in seconds), 0 means automatic */
+  double segment = 0;
+  double overlap = 2;
+  /* Distance of segment trajectories to be stitched (in meters) */
+  double distance = 0.05;
+  string calibration;
+  vector<string> files;
+  /* Marks to initialize tracking, indexed by camera */
+  vector<InnerTracker::Mark> marks;
+};
+
+struct Segment {
+  Frame::Timestamp start;
+  Frame::Timestamp end;
+  Trajectory trajectory;
+};
+
+bool ParseOptions(int argc, char *argv[], Options *options) {
+  int i = 1;
+  for (; i < argc && argv[i][0] == '-'; i += 2) {
+    if (i + 1 >= argc) {
+      return false;
+    }
+    const string option(argv[i]);
+    const string value(argv[i + 1]);
+
+    if (option == "-t") {
+      options->tracker = value;
+    } else if (option == "-j") {
+      options->jobs = std::stoul(value);
+    } else if (option == "-s") {
+      options->segment = std::stod(value);
+    } else if (option == "-o") {
+      options->overlap = std::stod(value);
+    } else if (option == "-d") {
+      options->distance = std::stod(value);
+    } else if (option == "-m") {
+      if (!ParseMark(value, &options->marks)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+
+  if (argc - i < 3) {
+    return false;
+  }
+
+  options->calibration = argv[i];
+  options->files.assign(argv + i + 1, argv + argc);
+  options->marks.resize(
+      std::max(options->marks.size(), options->files.size()));
+  return true;
+}
+
+/** Duration of the shortest video (in seconds) */
+double Duration(const vector<string> &files) {
+  double result = -1;
+  for (auto &file : files) {
+    cv::VideoCapture capture(file);
+    const double fps = capture.get(CV_CAP_PROP_FPS);
+    const double frames = capture.get(CV_CAP_PROP_FRAME_COUNT);
+    if (fps <= 0 || frames <= 0) {
+      ERROR("Cannot determine length of %s", file.c_str());
+      return -1;
+    }
+
+    const double duration = frames / fps;
+    result = (result < 0) ? duration : std::min(result, duration);
+  }
+  return result;
+}
+
+class Batch {
+ public:
+  Batch(const Options &options, const CalibrationData &calibration_data,
+        const Frameset &seed)
+      : options_(options),
+        calibration_data_(calibration_data),
+        seed_(seed) {
+  }
+
+  void Run(vector<Segment> *segments, const size_t threads);
+
+ private:
+  const Options &options_;
+  const CalibrationData &calibration_data_;
+  /* First frameset of the recording where marks are applied */
+  const Frameset &seed_;
+
+  std::atomic<size_t> next_segment_;
+
+  void Worker(vector<Segment> *segments);
+
+  void TrackSegment(Segment *segment) const;
+};
+
+void Batch::Run(vector<Segment> *segments, const size_t threads) {
+  next_segment_ = 0;
+
+  vector<std::thread> workers;
+  for (size_t i = 0; i < threads; ++i) {
+    workers.push_back(std::thread(&Batch::Worker, this, segments));
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void Batch::Worker(vector<Segment> *segments) {
+  size_t index;
+  while ((index = next_segment_++) < segments->size()) {
+    TrackSegment(&(*segments)[index]);
+  }
+}
+
+void Batch::TrackSegment(Segment *segment) const {
+  const CameraIndex arity = seed_.Arity();
+  const Parameters parameters;
+
+  Aggregator::ProvidersContainer providers;
+  for (auto &file : options_.files) {
+    auto provider = new FileVideoProvider(file);
+    provider->start_time(segment->start);
+    providers.push_back(provider);
+  }
+  FramesetAggregator<BlockingPolicy> aggregator(providers, parameters);
+
+  unique_ptr<StaticInnerTracker> inner_tracker(
+      CreateStaticInnerTracker(options_.tracker, parameters));
+  StaticTracker tracker(arity, *inner_tracker, parameters);
+  tracker.calibration_data(&calibration_data_);
+
+  Localization localization(arity, parameters);
+  localization.calibration_data(&calibration_data_);
+
+  /*
+   * Learn the object from the seed. Unless the segment starts with the seed,
+   * the seed position is stale, the camera is thus made lost and it
+   * re-acquires the object in the first frameset of the segment.
+   */
+  for (CameraIndex cam = 0; cam < arity; ++cam) {
+    const auto &mark = options_.marks[cam];
+    if (!seed_.IsValid(cam) || mark.type == InnerTracker::Mark::kInvalid) {
+      continue;
+    }
+
+    tracker.SetMark(seed_, cam, mark);
+  }
+
+  /* Marking may have initialized other cameras by projection too */
+  for (CameraIndex cam = 0; cam < arity; ++cam) {
+    if (seed_.IsValid(cam) &&
+        segment->start > seed_[cam].timestamp + kTimeTolerance) {
+      tracker.Reacquire(cam);
+    }
+  }
+
+  for (auto frameset : aggregator) {
+    if (frameset.ValidCount() == 0) {
+      continue;
+    }
+
+    const auto positset = tracker.Track(frameset);
+    if (tracker.time() > segment->end) {
+      break;
+    }
+
+    Location location;
+    if (!localization.Locate(positset, &location)) {
+      continue;
+    }
+    tracker.SetLocation(location);
+    segment->trajectory[tracker.time()] = location;
+
+    for (CameraIndex cam = 0; cam < arity; ++cam) {
+      if (localization.IsOutlier(cam)) {
+        tracker.Reacquire(cam);
+      }
+    }
+  }
+
+  DEBUG("Segment [%f, %f] has %zu locations", segment->start, segment->end,
+        segment->trajectory.size());
+}
+
+/** Find time when trajectories agree
+ *
+ * @return  first time in the overlap where both are located close enough,
+ *          end of the overlap when there's no such time
+ */
+Frame::Timestamp FindSwitchTime(const Segment &earlier, const Segment &later,
+                                const double distance) {
+  for (auto &entry : later.trajectory) {
+    if (entry.first > earlier.end) {
+      break;
+    }
+
+    auto it = earlier.trajectory.lower_bound(entry.first - kTimeTolerance);
+    if (it == earlier.trajectory.end() ||
+        it->first > entry.first + kTimeTolerance) {
+      continue;
+    }
+
+    if (cv::norm(it->second - entry.second) <= distance) {
+      return entry.first;
+    }
+  }
+
+  ERROR("Segments at %f do not agree, trajectory may be discontinuous",
+        later.start);
+  return earlier.end;
+}
+
+Trajectory Stitch(const vector<Segment> &segments, const double distance) {
+  Trajectory result;
+  Frame::Timestamp from = 0;
+
+  for (size_t i = 0; i < segments.size(); ++i) {
+    const auto &trajectory = segments[i].trajectory;
+
+    /* Last segment is used till its end */
+    auto last = trajectory.end();
+    Frame::Timestamp to = segments[i].end;
+    if (i + 1 < segments.size()) {
+      to = FindSwitchTime(segments[i], segments[i + 1], distance);
+      last = trajectory.lower_bound(to - kTimeTolerance);
+    }
+
+    result.insert(trajectory.lower_bound(from - kTimeTolerance), last);
+    from = to;
+  }
+
+  return result;
+}
+
+void PrintUsage(const string &name) {
+  cout << "Usage: " << name << " [-t tracker] [-j jobs] [-s segment] "
+      "[-o overlap] [-d distance] [-m cam,x,y,radius]... "
+      "calibration-file video-file ..." << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  const CameraIndex arity = options.files.size();
+  if (arity > CONFIG_MAX_ARITY) {
+    ERROR("At most %i cameras supported", CONFIG_MAX_ARITY);
+    return 1;
+  }
+
+  CalibrationData calibration_data;
+  if (!CalibrationStorage::LoadFromFile(options.calibration,
+                                        &calibration_data)) {
+    return 1;
+  }
+  if (calibration_data.Arity() != arity) {
+    ERROR("Calibration is for %i camera(s)", calibration_data.Arity());
+    return 1;
+  }
+
+  const Parameters default_parameters;
+  unique_ptr<StaticInnerTracker> probe(
+      CreateStaticInnerTracker(options.tracker, default_parameters));
+  if (!probe) {
+    ERROR("Unknown tracker %s (or not in this build)", options.tracker.c_str());
+    return 1;
+  }
+
+  const double duration = Duration(options.files);
+  if (duration < 0) {
+    return 1;
+  }
+
+  /* Seed frameset (marks refer to it) */
+  Frameset seed(arity);
+  {
+    Aggregator::ProvidersContainer providers;
+    for (auto &file : options.files) {
+      providers.push_back(new FileVideoProvider(file));
+    }
+    FramesetAggregator<BlockingPolicy> aggregator(providers,
+                                                  default_parameters);
+    for (auto frameset : aggregator) {
+      if (frameset.ValidCount() > 0) {
+        seed = frameset;
+        break;
+      }
+    }
+  }
+
+  /* Parallelism is across segments, not inside OpenCV */
+  cv::setNumThreads(1);
+  size_t threads = options.jobs;
+  if (!threads) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  const double length = (options.segment > 0) ?
+      options.segment : duration / threads;
+  vector<Segment> segments;
+  for (double start = 0; start < duration; start += length) {
+    Segment segment;
+    segment.start = start;
+    segment.end = start + length + options.overlap;
+    segments.push_back(segment);
+  }
+
+  Batch batch(options, calibration_data, seed);
+  batch.Run(&segments, std::min(threads, segments.size()));
+
+  for (auto &entry : Stitch(segments, options.distance)) {
+    cout << entry.first << " " << entry.second.x << " " << entry.second.y <<
+        " " << entry.second.z << endl;
+  }
+
+  return 0;
+}
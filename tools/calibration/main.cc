@@ -70,7 +70,6 @@ int CalibrateCameras(const string &output, const vector<string> &filenames) {
   typedef FramesetAggregator<BlockingPolicy> Aggregator;
   cv::namedWindow("test");
 
-  // TODO this works, consider adding virtual dtor to CalibrationPattern though
   ChessboardPattern pattern(6, 9, 0.026); // inner corners, 26 mm
   CameraCalibration calibration(filenames.size(), pattern);
 
@@ -0,0 +1,250 @@
+/** Camera characterization
+ *
+ * Sweeps capture modes of camera devices, measures their performance and
+ * writes camera profile (see dove_eye::CameraProfile).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "dove_eye/camera_profile.h"
+#include "dove_eye/logging.h"
+
+using dove_eye::CameraMode;
+using dove_eye::CameraProfile;
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options {
+  vector<int> devices;
+  size_t frames = 120;
+  size_t warmup = 15;
+  string output;
+};
+
+const int kResolutions[][2] = {
+  {160, 120},
+  {320, 240},
+  {640, 360},
+  {640, 480},
+  {800, 600},
+  {1280, 720},
+  {1920, 1080}
+};
+
+const char *kFourccs[] = {
+  "",
+  "YUYV",
+  "MJPG"
+};
+
+const double kFrameRates[] = {
+  15,
+  30,
+  60
+};
+
+/** Stop scanning after this many consecutive missing devices */
+const int kMaxMissing = 2;
+
+bool ParseOptions(int argc, char *argv[], Options *options) {
+  int i = 1;
+  for (; i < argc && argv[i][0] == '-'; i += 2) {
+    if (i + 1 >= argc) {
+      return false;
+    }
+    const string option(argv[i]);
+    const string value(argv[i + 1]);
+
+    if (option == "-d") {
+      options->devices.push_back(std::stoi(value));
+    } else if (option == "-n") {
+      options->frames = std::stoul(value);
+    } else if (option == "-w") {
+      options->warmup = std::stoul(value);
+    } else {
+      return false;
+    }
+  }
+
+  if (argc - i != 1 || options->frames < 2) {
+    return false;
+  }
+  options->output = argv[i];
+  return true;
+}
+
+/** Request mode and read back what the backend actually set */
+CameraMode SetMode(cv::VideoCapture *capture, const CameraMode &requested) {
+  if (requested.fourcc != 0) {
+    capture->set(CV_CAP_PROP_FOURCC, requested.fourcc);
+  }
+  capture->set(CV_CAP_PROP_FRAME_WIDTH, requested.width);
+  capture->set(CV_CAP_PROP_FRAME_HEIGHT, requested.height);
+  capture->set(CV_CAP_PROP_FPS, requested.fps);
+
+  /* Some backends report no FOURCC (0 or -1), keep the requested one */
+  const double fourcc = capture->get(CV_CAP_PROP_FOURCC);
+  const uint32_t actual_fourcc = (fourcc > 0 && fourcc <= UINT32_MAX) ?
+      static_cast<uint32_t>(fourcc) : requested.fourcc;
+
+  return CameraMode(capture->get(CV_CAP_PROP_FRAME_WIDTH),
+                    capture->get(CV_CAP_PROP_FRAME_HEIGHT),
+                    actual_fourcc,
+                    std::max(0.0, capture->get(CV_CAP_PROP_FPS)));
+}
+
+/** Measure sustained capture of the current mode
+ *
+ * @return  false when camera doesn't deliver frames
+ */
+bool Measure(cv::VideoCapture *capture, const Options &options,
+             CameraMode *mode) {
+  cv::Mat frame;
+  for (size_t i = 0; i < options.warmup; ++i) {
+    if (!capture->read(frame)) {
+      return false;
+    }
+  }
+
+  vector<Clock::time_point> grab_times;
+  grab_times.reserve(options.frames);
+  double retrieve_sum = 0;
+
+  const auto cpu_start = std::clock();
+  for (size_t i = 0; i < options.frames; ++i) {
+    if (!capture->grab()) {
+      return false;
+    }
+    const auto grabbed = Clock::now();
+    if (!capture->retrieve(frame) || frame.empty()) {
+      return false;
+    }
+    const auto retrieved = Clock::now();
+
+    grab_times.push_back(grabbed);
+    retrieve_sum += std::chrono::duration<double>(retrieved - grabbed).count();
+  }
+  const auto cpu_end = std::clock();
+
+  /* Frame size may differ from reported one */
+  mode->width = frame.cols;
+  mode->height = frame.rows;
+
+  const size_t n = grab_times.size();
+  const double duration = std::chrono::duration<double>(
+      grab_times.back() - grab_times.front()).count();
+  const double mean_interval = duration / (n - 1);
+
+  double variance = 0;
+  for (size_t i = 1; i < n; ++i) {
+    const double interval = std::chrono::duration<double>(
+        grab_times[i] - grab_times[i - 1]).count();
+    variance += (interval - mean_interval) * (interval - mean_interval);
+  }
+
+  mode->measured_fps = (mean_interval > 0) ? 1 / mean_interval : 0;
+  mode->latency = retrieve_sum / n;
+  mode->jitter = std::sqrt(variance / (n - 1));
+  mode->cpu = static_cast<double>(cpu_end - cpu_start) / CLOCKS_PER_SEC / n;
+  return true;
+}
+
+void ProfileDevice(const int device, const Options &options,
+                   CameraProfile *profile) {
+  cv::VideoCapture capture(device);
+  if (!capture.isOpened()) {
+    ERROR("Cannot open device %d", device);
+    return;
+  }
+
+  /* Backends silently fall back to other modes, measure each one once */
+  std::set<std::tuple<int, int, uint32_t, double>> measured;
+
+  for (auto &resolution : kResolutions) {
+    for (auto fourcc : kFourccs) {
+      for (auto fps : kFrameRates) {
+        CameraMode mode = SetMode(&capture,
+            CameraMode(resolution[0], resolution[1],
+                       CameraMode::StringToFourcc(fourcc), fps));
+        auto key = std::make_tuple(mode.width, mode.height, mode.fourcc,
+                                   mode.fps);
+        if (!measured.insert(key).second) {
+          continue;
+        }
+
+        if (!Measure(&capture, options, &mode)) {
+          ERROR("Device %d: mode %dx%d %s failed", device, mode.width,
+                mode.height, CameraMode::FourccToString(mode.fourcc).c_str());
+          continue;
+        }
+
+        cout << device << "\t" << mode.width << "x" << mode.height << "\t" <<
+            CameraMode::FourccToString(mode.fourcc) << "\t" << mode.fps <<
+            "\t" << mode.measured_fps << " fps\t" <<
+            mode.latency * 1000 << " ms\t" << mode.jitter * 1000 << " ms\t" <<
+            mode.cpu * 1000 << " ms cpu" <<
+            (mode.Sustained() ? "" : "\t(not sustained)") << endl;
+        profile->AddMode(device, mode);
+      }
+    }
+  }
+}
+
+void PrintUsage(const string &name) {
+  cout << "Usage: " << name << " [-d device]... [-n frames] [-w warmup] "
+      "profile-file" << endl;
+  cout << "  without -d all devices are probed" << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  CameraProfile profile;
+  if (!options.devices.empty()) {
+    for (auto device : options.devices) {
+      ProfileDevice(device, options, &profile);
+    }
+  } else {
+    int missing = 0;
+    for (int device = 0; missing < kMaxMissing; ++device) {
+      /* Probe separately, ProfileDevice reports errors */
+      bool present;
+      {
+        cv::VideoCapture capture(device);
+        present = capture.isOpened();
+      }
+      if (!present) {
+        ++missing;
+        continue;
+      }
+      missing = 0;
+      ProfileDevice(device, options, &profile);
+    }
+  }
+
+  return CameraProfile::SaveToFile(options.output, profile) ? 0 : 1;
+}
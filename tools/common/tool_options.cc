@@ -0,0 +1,104 @@
+#include "tool_options.h"
+
+#include <cctype>
+#include <sstream>
+
+#include <opencv2/opencv.hpp>
+
+#include "dove_eye/logging.h"
+
+using dove_eye::InnerTracker;
+using dove_eye::MjpegDecoder;
+using dove_eye::Parameters;
+using std::string;
+
+namespace tools {
+
+bool FindKey(const string &name, Parameters::Key *key) {
+  const Parameters parameters;
+  for (auto &param : parameters) {
+    if (param.name == name) {
+      *key = param.key;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool LoadParameters(const string &filename, Parameters *parameters) {
+  cv::FileStorage fs(filename, cv::FileStorage::READ);
+  if (!fs.isOpened()) {
+    ERROR("Cannot open parameters %s", filename.c_str());
+    return false;
+  }
+
+  for (auto &param : *parameters) {
+    /* Same key names as io::ParametersStorage */
+    string name;
+    for (auto c : param.name) {
+      if (c == '.') {
+        name += '_';
+      } else if (c != '[' && c != ']') {
+        name += c;
+      }
+    }
+
+    if (fs[name].empty()) {
+      continue;
+    }
+
+    double value;
+    fs[name] >> value;
+    if (!parameters->Set(param.key, value)) {
+      ERROR("Parameter %s out of range", param.name.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ParseMark(const string &value, MarksVector *marks) {
+  std::istringstream ss(value);
+  int cam;
+  char sep1, sep2, sep3;
+  InnerTracker::Mark mark(InnerTracker::Mark::kCircle);
+
+  if (!(ss >> cam >> sep1 >> mark.center.x >> sep2 >> mark.center.y >>
+        sep3 >> mark.radius) || cam < 0) {
+    return false;
+  }
+
+  if (marks->size() <= static_cast<size_t>(cam)) {
+    marks->resize(cam + 1);
+  }
+  (*marks)[cam] = mark;
+  return true;
+}
+
+bool ParseMjpeg(const string &value, MjpegDecoder::Options *options) {
+  const auto colon = value.find(':');
+  const string mode = value.substr(0, colon);
+  if (mode == "color" || mode == "gray") {
+    options->grayscale = (mode == "gray");
+  } else {
+    return false;
+  }
+
+  options->scale_denom = 1;
+  if (colon != string::npos) {
+    options->scale_denom = std::stoi(value.substr(colon + 1));
+  }
+  const int scale = options->scale_denom;
+  return scale == 1 || scale == 2 || scale == 4 || scale == 8;
+}
+
+bool IsDevice(const string &source) {
+  for (auto c : source) {
+    if (!std::isdigit(c)) {
+      return false;
+    }
+  }
+  return !source.empty();
+}
+
+} // namespace tools
@@ -0,0 +1,40 @@
+#ifndef TOOLS_TOOL_OPTIONS_H_
+#define TOOLS_TOOL_OPTIONS_H_
+
+#include <string>
+#include <vector>
+
+#include "dove_eye/inner_tracker.h"
+#include "dove_eye/mjpeg_decoder.h"
+#include "dove_eye/parameters.h"
+
+/** Parsing of command line options shared by the tools */
+namespace tools {
+
+typedef std::vector<dove_eye::InnerTracker::Mark> MarksVector;
+
+/** Find parameter by its name (e.g. "track.search.factor") */
+bool FindKey(const std::string &name, dove_eye::Parameters::Key *key);
+
+/** Load parameters file (as saved by the GUI or used by the daemon)
+ *
+ * Keys missing in the file keep their values.
+ *
+ * @return  false when the file cannot be read
+ */
+bool LoadParameters(const std::string &filename,
+                    dove_eye::Parameters *parameters);
+
+/** Parse "cam,x,y,radius" circle mark into marks indexed by camera */
+bool ParseMark(const std::string &value, MarksVector *marks);
+
+/** Parse "color|gray[:scale]" (scale is 1, 2, 4 or 8) */
+bool ParseMjpeg(const std::string &value,
+                dove_eye::MjpegDecoder::Options *options);
+
+/** Source given by number is a camera device, otherwise it's a file */
+bool IsDevice(const std::string &source);
+
+} // namespace tools
+
+#endif // TOOLS_TOOL_OPTIONS_H_
@@ -0,0 +1,475 @@
+/** Headless tracking daemon
+ *
+ * Runs capture-track-localize pipeline without any widgets, it is controlled
+ * through a local socket (see io::CommandServer).
+ *
+ * Several independent rigs can be run in one process (see RigHost), each
+ * with its own sources, options and socket. Groups of rig arguments are
+ * separated by "--". A camera used by several rigs is captured only once and
+ * its frames are shared (see TeeVideoProvider), the first rig using it
+ * decides its profile and MJPEG options.
+ */
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QMetaObject>
+
+#include "config.h"
+#include "controller.h"
+#include "dove_eye/async_policy.h"
+#include "dove_eye/blocking_policy.h"
+#include "dove_eye/calibration_data.h"
+#include "dove_eye/calibration_pattern_factory.h"
+#include "dove_eye/calibration_storage.h"
+#include "dove_eye/camera_calibration.h"
+#include "dove_eye/camera_profile.h"
+#include "dove_eye/camera_video_provider.h"
+#include "dove_eye/file_video_provider.h"
+#include "dove_eye/frameset_aggregator.h"
+#ifdef CONFIG_HISTORY
+#include "dove_eye/history_store.h"
+#endif
+#include "dove_eye/inner_tracker_factory.h"
+#include "dove_eye/localization.h"
+#include "dove_eye/logging.h"
+#include "dove_eye/mjpeg_decoder.h"
+#include "dove_eye/parameters.h"
+#ifdef CONFIG_SHM
+#include "dove_eye/shm_result_publisher.h"
+#include "dove_eye/shm_video_provider.h"
+#endif
+#include "dove_eye/tee_video_provider.h"
+#include "dove_eye/tracker.h"
+#include "dove_eye/types.h"
+#include "io/command_server.h"
+#include "io/parameters_storage.h"
+#include "rig_host.h"
+#include "tool_options.h"
+
+using dove_eye::Aggregator;
+using dove_eye::AsyncPolicy;
+using dove_eye::BlockingPolicy;
+using dove_eye::CalibrationData;
+using dove_eye::CalibrationStorage;
+using dove_eye::CameraCalibration;
+using dove_eye::CameraIndex;
+using dove_eye::CameraProfile;
+using dove_eye::CameraVideoProvider;
+using dove_eye::CreateCalibrationPattern;
+using dove_eye::CreateInnerTracker;
+using dove_eye::FileVideoProvider;
+using dove_eye::FramesetAggregator;
+using dove_eye::InnerTracker;
+using dove_eye::Localization;
+using dove_eye::MjpegDecoder;
+using dove_eye::Parameters;
+using dove_eye::TeeVideoProvider;
+using dove_eye::Tracker;
+using dove_eye::VideoProvider;
+using io::CommandServer;
+using io::ParametersStorage;
+
+using tools::IsDevice;
+using tools::ParseMjpeg;
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace {
+
+const char kDefaultSocket[] = "dove-eye";
+const string kShmPrefix("shm:");
+/* Another daemon must be given different name (or "" to not publish) */
+const char kDefaultResultsShmName[] = "/dove-eye-results";
+
+/** Options of single rig */
+struct Options {
+  /* Default depends on rig index */
+  string socket;
+  double weight = 1;
+  string tracker = "circle";
+  string parameters;
+  string calibration;
+  string calibration_output;
+  string model;
+  string history;
+  string camera_profile;
+  bool mjpeg = false;
+  MjpegDecoder::Options mjpeg_options;
+  /* Frames buffered for the rig when its camera is shared */
+  size_t queue_depth = TeeVideoProvider::kDefaultDepth;
+  vector<string> sources;
+};
+
+/** Camera used by more than one rig */
+struct SharedDevice {
+  CameraProfile camera_profile;
+  unique_ptr<TeeVideoProvider> tee;
+};
+
+typedef std::map<string, SharedDevice> SharedDevices;
+
+struct HostOptions {
+  size_t cpu_slots = 0;
+  string results_shm_name = kDefaultResultsShmName;
+  vector<Options> rigs;
+};
+
+/** Parse arguments of single rig, argv[begin, end) */
+bool ParseRigOptions(char *argv[], const int begin, const int end,
+                     Options *options, HostOptions *host_options) {
+  int i = begin;
+  for (; i < end && argv[i][0] == '-'; i += 2) {
+    if (i + 1 >= end) {
+      return false;
+    }
+    const string option(argv[i]);
+    const string value(argv[i + 1]);
+
+    if (option == "-s") {
+      options->socket = value;
+    } else if (option == "-w") {
+      options->weight = std::stod(value);
+    } else if (option == "-j") {
+      host_options->cpu_slots = std::stoul(value);
+    } else if (option == "-r") {
+      host_options->results_shm_name = value;
+    } else if (option == "-t") {
+      options->tracker = value;
+    } else if (option == "-p") {
+      options->parameters = value;
+    } else if (option == "-c") {
+      options->calibration = value;
+    } else if (option == "-o") {
+      options->calibration_output = value;
+    } else if (option == "-M") {
+      options->model = value;
+    } else if (option == "-H") {
+      options->history = value;
+    } else if (option == "-P") {
+      options->camera_profile = value;
+    } else if (option == "-q") {
+      options->queue_depth = std::stoul(value);
+    } else if (option == "-J") {
+      options->mjpeg = true;
+      if (!ParseMjpeg(value, &options->mjpeg_options)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+
+  options->sources.assign(argv + i, argv + end);
+  return options->weight > 0 && options->queue_depth > 0 &&
+      options->sources.size() > 0 &&
+      options->sources.size() <= static_cast<size_t>(CONFIG_MAX_ARITY);
+}
+
+bool ParseOptions(int argc, char *argv[], HostOptions *options) {
+  const string separator("--");
+
+  int begin = 1;
+  while (begin <= argc) {
+    int end = begin;
+    while (end < argc && argv[end] != separator) {
+      ++end;
+    }
+
+    Options rig_options;
+    if (!ParseRigOptions(argv, begin, end, &rig_options, options)) {
+      return false;
+    }
+    if (rig_options.socket.empty()) {
+      rig_options.socket = kDefaultSocket;
+      if (!options->rigs.empty()) {
+        rig_options.socket += "-" + std::to_string(options->rigs.size());
+      }
+    }
+    options->rigs.push_back(rig_options);
+
+    begin = end + 1;
+  }
+
+  return true;
+}
+
+VideoProvider *CreateCameraProvider(const string &source,
+                                    const CameraProfile *camera_profile,
+                                    const Options &options) {
+  auto provider = new CameraVideoProvider(std::stoi(source));
+  provider->profile(camera_profile);
+  provider->mjpeg(options.mjpeg, options.mjpeg_options);
+  return provider;
+}
+
+/** Open cameras used by several rigs, each of them once */
+bool CreateSharedDevices(const HostOptions &options, SharedDevices *devices) {
+  std::map<string, size_t> users;
+  for (auto &rig_options : options.rigs) {
+    for (auto &source : rig_options.sources) {
+      if (IsDevice(source)) {
+        ++users[source];
+      }
+    }
+  }
+
+  for (auto &rig_options : options.rigs) {
+    for (auto &source : rig_options.sources) {
+      if (!IsDevice(source) || users[source] < 2 || devices->count(source)) {
+        continue;
+      }
+
+      auto &device = (*devices)[source];
+      const bool profiled = !rig_options.camera_profile.empty();
+      if (profiled &&
+          !CameraProfile::LoadFromFile(rig_options.camera_profile,
+                                       &device.camera_profile)) {
+        return false;
+      }
+      device.tee.reset(new TeeVideoProvider(CreateCameraProvider(
+          source, profiled ? &device.camera_profile : nullptr, rig_options)));
+      DEBUG("Camera %s shared by %i rigs", source.c_str(),
+            static_cast<int>(users[source]));
+    }
+  }
+
+  return true;
+}
+
+/** Source "shm:<name>" is a shared memory frame ring */
+bool IsShm(const string &source) {
+  return source.compare(0, kShmPrefix.size(), kShmPrefix) == 0;
+}
+
+VideoProvider *CreateVideoProvider(const string &source,
+                                   const CameraProfile *camera_profile,
+                                   const SharedDevices &devices,
+                                   const Options &options) {
+  const auto shared = devices.find(source);
+  if (shared != devices.end()) {
+    return shared->second.tee->Branch(options.queue_depth);
+  }
+  if (IsDevice(source)) {
+    return CreateCameraProvider(source, camera_profile, options);
+  }
+#ifdef CONFIG_SHM
+  if (IsShm(source)) {
+    return new dove_eye::ShmVideoProvider(source.substr(kShmPrefix.size()));
+  }
+#endif
+  return new FileVideoProvider(source);
+}
+
+void PrintUsage(const string &name) {
+  cout << "Usage: " << name << " [-j cpu-slots] [-r results-shm-name] "
+      "[-s socket] [-w weight] "
+      "[-t tracker] [-p parameters] "
+      "[-c calibration] [-o calibration-output] [-M tracker-model] "
+      "[-H history] [-P camera-profile] [-J color|gray[:scale]] "
+      "[-q shared-camera-queue] "
+      "video-file|device|shm:name ... [-- rig-options source ...]..." << endl;
+}
+
+/** Pipeline of single rig */
+class DaemonRig : public Rig {
+ public:
+  /** @return  new rig or nullptr on error */
+  static DaemonRig *Create(const Options &options,
+                           const SharedDevices &devices,
+                           const RigContext &context);
+
+ private:
+  Parameters parameters_;
+  CameraProfile camera_profile_;
+  unique_ptr<InnerTracker> inner_tracker_;
+#ifdef CONFIG_HISTORY
+  /* Outlives controller, so that it's closed after the last record */
+  dove_eye::HistoryWriter history_writer_;
+#endif
+  unique_ptr<Controller> controller_;
+  unique_ptr<CommandServer> command_server_;
+};
+
+DaemonRig *DaemonRig::Create(const Options &options,
+                             const SharedDevices &devices,
+                             const RigContext &context) {
+  unique_ptr<DaemonRig> rig(new DaemonRig());
+  auto &parameters = rig->parameters_;
+
+  ParametersStorage parameters_storage(parameters);
+  if (!options.parameters.empty()) {
+    parameters_storage.LoadFromFile(QString::fromStdString(options.parameters));
+  }
+
+  const CameraIndex arity = options.sources.size();
+
+  if (!options.camera_profile.empty() &&
+      !CameraProfile::LoadFromFile(options.camera_profile,
+                                   &rig->camera_profile_)) {
+    return nullptr;
+  }
+
+  rig->inner_tracker_.reset(CreateInnerTracker(options.tracker, parameters));
+  if (!rig->inner_tracker_) {
+    ERROR("Unknown tracker %s", options.tracker.c_str());
+    return nullptr;
+  }
+
+  CalibrationData calibration_data;
+  if (!options.calibration.empty()) {
+    if (!CalibrationStorage::LoadFromFile(options.calibration,
+                                          &calibration_data)) {
+      return nullptr;
+    }
+    if (calibration_data.Arity() != arity) {
+      ERROR("Calibration is for %i camera(s)", calibration_data.Arity());
+      return nullptr;
+    }
+  }
+
+#ifdef CONFIG_HISTORY
+  if (!options.history.empty() &&
+      !rig->history_writer_.Open(options.history, arity)) {
+    return nullptr;
+  }
+#endif
+
+  /* Live sources (cameras, shm rings) must not be blocked, files shouldn't
+   * drop frames */
+  bool live = false;
+  Aggregator::ProvidersContainer providers;
+  for (auto source : options.sources) {
+    live = live || IsDevice(source) || IsShm(source);
+    providers.push_back(CreateVideoProvider(
+        source,
+        options.camera_profile.empty() ? nullptr : &rig->camera_profile_,
+        devices, options));
+  }
+
+  Aggregator *aggregator = nullptr;
+  if (live) {
+    aggregator = new FramesetAggregator<AsyncPolicy<true>>(
+        std::move(providers), parameters);
+  } else {
+    aggregator = new FramesetAggregator<BlockingPolicy>(
+        std::move(providers), parameters);
+  }
+
+  auto pattern = CreateCalibrationPattern(parameters);
+  auto calibration = new CameraCalibration(parameters, arity, pattern);
+
+  auto tracker = new Tracker(arity, *rig->inner_tracker_, parameters);
+  auto localization = new Localization(arity, parameters);
+
+  /* Metrics registry is shared by all rigs */
+  aggregator->metrics_prefix(context.metrics_prefix);
+  tracker->metrics_prefix(context.metrics_prefix);
+  localization->metrics_prefix(context.metrics_prefix);
+
+  rig->controller_.reset(new Controller(parameters, aggregator, calibration,
+                                        tracker, localization));
+  auto controller = rig->controller_.get();
+  controller->SetTrackerMarkType(rig->inner_tracker_->PreferredMarkType());
+  controller->cpu_scheduler(context.scheduler, context.client);
+#ifdef CONFIG_HISTORY
+  if (rig->history_writer_.IsOpen()) {
+    controller->history_writer(&rig->history_writer_);
+  }
+#endif
+
+#ifdef CONFIG_SHM
+  if (context.result_publisher) {
+    controller->result_publisher(context.result_publisher, context.index);
+  }
+#endif
+
+  /* Finished calibration is applied (and stored) immediately */
+  const auto calibration_output = options.calibration_output;
+  QObject::connect(controller, &Controller::CalibrationDataReady,
+                   [controller, calibration_output](
+                       const CalibrationData calibration_data) {
+    controller->SetCalibrationData(calibration_data);
+    if (!calibration_output.empty()) {
+      CalibrationStorage::SaveToFile(calibration_output, calibration_data);
+    }
+  });
+
+  if (!options.calibration.empty()) {
+    controller->SetCalibrationData(calibration_data);
+    controller->SetLocalizationActive(true);
+  }
+
+  /* Warm start, trackers search for the object in the first frameset */
+  if (!options.model.empty() &&
+      !controller->LoadTrackerModel(QString::fromStdString(options.model))) {
+    return nullptr;
+  }
+
+  rig->command_server_.reset(new CommandServer(parameters, controller));
+  rig->command_server_->metrics_prefix(context.metrics_prefix);
+  if (!rig->command_server_->Listen(QString::fromStdString(options.socket))) {
+    return nullptr;
+  }
+  /* Any rig can quit the whole process */
+  QObject::connect(rig->command_server_.get(), &CommandServer::QuitRequested,
+                   QCoreApplication::instance(), &QCoreApplication::quit);
+
+  /* Same as GUI, live cameras run immediately, files wait for start */
+  controller->Start(!live);
+
+  return rig.release();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  QCoreApplication app(argc, argv);
+
+  HostOptions options;
+  if (!ParseOptions(argc, argv, &options)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  /* Outlive the rigs, branches of the tees are owned by rigs' aggregators */
+  SharedDevices devices;
+  if (!CreateSharedDevices(options, &devices)) {
+    return 1;
+  }
+
+  RigHost host(options.cpu_slots);
+#ifdef CONFIG_SHM
+  if (!options.results_shm_name.empty() &&
+      !host.CreateResultPublisher(options.results_shm_name)) {
+    ERROR("Results will not be published to shared memory");
+  }
+#endif
+
+  for (auto &rig_options : options.rigs) {
+    const auto factory = [rig_options, &devices](
+        const RigContext &context) -> Rig * {
+      return DaemonRig::Create(rig_options, devices, context);
+    };
+    host.AddRig(rig_options.socket, rig_options.weight, factory);
+  }
+
+  QObject::connect(&host, &RigHost::Failed, [&app]() {
+    app.exit(1);
+  });
+
+  /* From event loop, so that failed rig can exit it */
+  QMetaObject::invokeMethod(&host, "Start", Qt::QueuedConnection);
+  const int result = app.exec();
+
+  host.Stop();
+  return result;
+}
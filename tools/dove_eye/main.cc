@@ -1,3 +1,4 @@
+#include <iostream>
 #include <vector>
 #include <string>
 
@@ -9,16 +10,39 @@
 
 using dove_eye::CameraIndex;
 using gui::MainWindow;
+using std::cout;
+using std::endl;
 using std::string;
 using std::vector;
 
+namespace {
+
+/* Another instance must be given different name (or "" to not publish) */
+const char kDefaultResultsShmName[] = "/dove-eye-results";
+
+void PrintUsage(const string &name) {
+  cout << "Usage: " << name << " [-r results-shm-name]" << endl;
+}
+
+} // namespace
+
 int main(int argc, char* argv[]) {
+  /* Removes Qt options from arguments */
+  QApplication app(argc, argv);
 
   vector<string> args(argv + 1, argv + argc);
 
-  QApplication app(argc, argv);
+  string results_shm_name = kDefaultResultsShmName;
+  for (size_t i = 0; i < args.size(); i += 2) {
+    if (args[i] == "-r" && i + 1 < args.size()) {
+      results_shm_name = args[i + 1];
+    } else {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
 
-  Application application;
+  Application application(results_shm_name);
 
   MainWindow main_window(&application);
   main_window.show();
@@ -27,4 +51,3 @@ int main(int argc, char* argv[]) {
 
   return rc;
 }
-
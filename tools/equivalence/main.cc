@@ -0,0 +1,812 @@
+/** Golden-output equivalence of tracking configurations
+ *
+ * Tracks the same session with the reference configuration (serial tracking
+ * with runtime dispatched inner tracker, OpenCV without threads, default
+ * parameters) and with a candidate configuration. Positsets and locations
+ * are compared frameset by frameset within tolerances and throughput and
+ * latency of both configurations are reported.
+ *
+ * Session is either a recording (decoded once, like BlockingPolicy plays it)
+ * or a synthetic ball moving in front of the calibrated cameras.
+ *
+ * The reference reads framesets directly from memory. Candidate may instead
+ * stream the stored frames through an ingest path and aggregate them anew
+ * (source=blocking|async|tee), framesets of both are then paired by time.
+ * Tee is exercised with a single (lossless) branch per camera.
+ * Only lossless paths can be compared this way. Shared-memory rings and MJPEG
+ * capture are live sources (they drop frames, stamp them by arrival) and
+ * batch segments re-acquire the object by design, they aren't covered.
+ *
+ * Exit status is 0 when the configurations are equivalent, 2 when they
+ * differ.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "dove_eye/async_policy.h"
+#include "dove_eye/blocking_policy.h"
+#include "dove_eye/calibration_data.h"
+#include "dove_eye/calibration_storage.h"
+#include "dove_eye/file_video_provider.h"
+#include "dove_eye/frame_store.h"
+#include "dove_eye/frameset_aggregator.h"
+#include "dove_eye/inner_tracker_factory.h"
+#include "dove_eye/localization.h"
+#include "dove_eye/location.h"
+#include "dove_eye/logging.h"
+#include "dove_eye/parameters.h"
+#include "dove_eye/positset.h"
+#include "dove_eye/static_tracker.h"
+#include "dove_eye/tee_video_provider.h"
+#include "dove_eye/tracker.h"
+#include "dove_eye/types.h"
+#include "dove_eye/video_provider.h"
+#include "tool_options.h"
+
+using dove_eye::Aggregator;
+using dove_eye::AsyncPolicy;
+using dove_eye::BasicTracker;
+using dove_eye::BlockingPolicy;
+using dove_eye::CalibrationData;
+using dove_eye::CalibrationStorage;
+using dove_eye::CameraIndex;
+using dove_eye::CreateInnerTracker;
+using dove_eye::CreateStaticInnerTracker;
+using dove_eye::FileVideoProvider;
+using dove_eye::Frame;
+using dove_eye::FrameIterator;
+using dove_eye::FrameIteratorImpl;
+using dove_eye::FrameStore;
+using dove_eye::Frameset;
+using dove_eye::FramesetAggregator;
+using dove_eye::InnerTracker;
+using dove_eye::Localization;
+using dove_eye::Location;
+using dove_eye::Parameters;
+using dove_eye::Point2;
+using dove_eye::Positset;
+using dove_eye::StaticInnerTracker;
+using dove_eye::TeeVideoProvider;
+using dove_eye::VideoProvider;
+
+using tools::FindKey;
+using tools::ParseMark;
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/* Synthetic session (lengths in meters) */
+const double kSyntheticFps = 30;
+const double kSyntheticDistance = 2;
+const double kSyntheticAmplitude = 0.3;
+const double kSyntheticBallRadius = 0.05;
+/** Period of the synthetic motion [s] */
+const double kSyntheticPeriod = 4;
+
+/** Framesets of both configurations are paired when their times differ less */
+const double kTimeTolerance = 1e-4;
+
+/** How the configuration gets framesets */
+enum Source {
+  /** Stored framesets directly */
+  kStore,
+  /** Stored frames re-aggregated by BlockingPolicy */
+  kBlocking,
+  /** Stored frames re-aggregated by AsyncPolicy (without drops) */
+  kAsync,
+  /** Stored frames through tee branches */
+  kTee
+};
+
+struct Config {
+  string name;
+  bool static_tracker = false;
+  int threads = 1;
+  Source source = kStore;
+  vector<std::pair<Parameters::Key, double>> parameters;
+};
+
+struct Options {
+  string tracker = dove_eye::kDefaultStaticTracker;
+  size_t max_framesets = 0;
+  size_t synthetic_framesets = 0;
+  size_t repeat = 1;
+  size_t reported = 10;
+  /* Tolerances in pixels and meters */
+  double posit_tolerance = 0.5;
+  double location_tolerance = 1e-3;
+  Config candidate;
+  string calibration;
+  vector<string> files;
+  /* Marks to initialize tracking, indexed by camera */
+  vector<InnerTracker::Mark> marks;
+};
+
+/** Output of a configuration for single frameset */
+struct Result {
+  /** Time of the frameset (its latest frame) */
+  Frame::Timestamp time;
+  Positset positset;
+  bool located;
+  Location location;
+  /** Time of tracking and localization [s] */
+  double latency;
+
+  explicit Result(const CameraIndex arity)
+      : time(0),
+        positset(arity),
+        located(false),
+        latency(0) {
+  }
+};
+
+typedef vector<Result> Results;
+
+struct Performance {
+  double duration = 0;
+  double fps = 0;
+  double mean = 0;
+  double median = 0;
+  double p99 = 0;
+  double max = 0;
+};
+
+struct Difference {
+  /** Framesets present in one configuration only */
+  size_t unpaired = 0;
+
+  size_t posits = 0;
+  size_t posit_mismatches = 0;
+  double max_posit_error = 0;
+
+  size_t locations = 0;
+  size_t location_mismatches = 0;
+  double max_location_error = 0;
+
+  inline bool Equivalent() const {
+    return unpaired == 0 && posit_mismatches == 0 &&
+        location_mismatches == 0;
+  }
+};
+
+bool ParseSource(const string &value, Source *source) {
+  if (value == "store") {
+    *source = kStore;
+  } else if (value == "blocking") {
+    *source = kBlocking;
+  } else if (value == "async") {
+    *source = kAsync;
+  } else if (value == "tee") {
+    *source = kTee;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/** Parse "static=0|1", "threads=n", "source=name" or "parameter.name=value" */
+bool ParseSetting(const string &value, Config *config) {
+  auto eq = value.find('=');
+  if (eq == string::npos) {
+    return false;
+  }
+  const string name = value.substr(0, eq);
+  const string setting = value.substr(eq + 1);
+
+  if (name == "static") {
+    config->static_tracker = std::stoi(setting) != 0;
+  } else if (name == "threads") {
+    config->threads = std::stoi(setting);
+  } else if (name == "source") {
+    if (!ParseSource(setting, &config->source)) {
+      ERROR("Unknown source %s", setting.c_str());
+      return false;
+    }
+  } else {
+    Parameters::Key key;
+    if (!FindKey(name, &key)) {
+      ERROR("Unknown parameter %s", name.c_str());
+      return false;
+    }
+    config->parameters.push_back(std::make_pair(key, std::stod(setting)));
+  }
+  return true;
+}
+
+bool ParseOptions(int argc, char *argv[], Options *options) {
+  int i = 1;
+  for (; i < argc && argv[i][0] == '-'; i += 2) {
+    if (i + 1 >= argc) {
+      return false;
+    }
+    const string option(argv[i]);
+    const string value(argv[i + 1]);
+
+    if (option == "-t") {
+      options->tracker = value;
+    } else if (option == "-n") {
+      options->max_framesets = std::stoul(value);
+    } else if (option == "-S") {
+      options->synthetic_framesets = std::stoul(value);
+    } else if (option == "-r") {
+      options->repeat = std::max(1ul, std::stoul(value));
+    } else if (option == "-v") {
+      options->reported = std::stoul(value);
+    } else if (option == "-e") {
+      options->posit_tolerance = std::stod(value);
+    } else if (option == "-l") {
+      options->location_tolerance = std::stod(value);
+    } else if (option == "-c") {
+      if (!ParseSetting(value, &options->candidate)) {
+        return false;
+      }
+    } else if (option == "-m") {
+      if (!ParseMark(value, &options->marks)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+
+  if (argc - i < 1 || (!options->synthetic_framesets && argc - i < 3)) {
+    return false;
+  }
+
+  options->calibration = argv[i];
+  options->files.assign(argv + i + 1, argv + argc);
+  return true;
+}
+
+/** Ball position at given time (world coordinates) */
+cv::Mat SyntheticLocation(const CalibrationData &calibration_data,
+                          const double time) {
+  const double phase = 2 * M_PI * time / kSyntheticPeriod;
+
+  /* Ellipse in front of camera 0 */
+  cv::Mat in_camera = (cv::Mat_<double>(3, 1) <<
+      kSyntheticAmplitude * std::cos(phase),
+      0.5 * kSyntheticAmplitude * std::sin(phase),
+      kSyntheticDistance + kSyntheticAmplitude * std::sin(phase));
+
+  const cv::Mat &rotation = calibration_data.CameraRotation(0);
+  const cv::Mat &translation = calibration_data.CameraTranslation(0);
+  return rotation.t() * (in_camera - translation);
+}
+
+/** Project the ball
+ *
+ * @return  false when the ball is behind the camera
+ */
+bool SyntheticProject(const CalibrationData &calibration_data,
+                      const CameraIndex cam, const cv::Mat &location,
+                      InnerTracker::Mark *mark) {
+  const cv::Mat in_camera = calibration_data.CameraRotation(cam) * location +
+      calibration_data.CameraTranslation(cam);
+  const double depth = in_camera.at<double>(2);
+  if (depth <= kSyntheticBallRadius) {
+    return false;
+  }
+
+  const cv::Mat &camera_matrix =
+      calibration_data.camera_parameters(cam).camera_matrix;
+  const cv::Mat image = camera_matrix * in_camera;
+
+  *mark = InnerTracker::Mark(InnerTracker::Mark::kCircle);
+  mark->center = Point2(image.at<double>(0) / depth,
+                        image.at<double>(1) / depth);
+  mark->radius = camera_matrix.at<double>(0, 0) * kSyntheticBallRadius / depth;
+  return true;
+}
+
+/** Render synthetic session, marks are set to the initial ball projections
+ *
+ * Frames are undistorted (the tracker doesn't expect distorted input).
+ */
+void CreateSynthetic(const CalibrationData &calibration_data,
+                     const size_t framesets, FrameStore *store,
+                     vector<InnerTracker::Mark> *marks) {
+  const CameraIndex arity = calibration_data.Arity();
+
+  /* Textured static background of each camera */
+  vector<cv::Mat> backgrounds(arity);
+  for (CameraIndex cam = 0; cam < arity; ++cam) {
+    const cv::Mat &camera_matrix =
+        calibration_data.camera_parameters(cam).camera_matrix;
+    const cv::Size size(2 * cvRound(camera_matrix.at<double>(0, 2)),
+                        2 * cvRound(camera_matrix.at<double>(1, 2)));
+
+    cv::Mat noise(size.height / 8, size.width / 8, CV_8UC3);
+    cv::RNG rng(cam + 1);
+    rng.fill(noise, cv::RNG::UNIFORM, cv::Scalar::all(40),
+             cv::Scalar::all(140));
+    cv::resize(noise, backgrounds[cam], size, 0, 0, cv::INTER_LINEAR);
+  }
+
+  marks->assign(arity, InnerTracker::Mark());
+
+  for (size_t i = 0; i < framesets; ++i) {
+    const double time = i / kSyntheticFps;
+    const cv::Mat location = SyntheticLocation(calibration_data, time);
+
+    Frameset frameset(arity, i);
+    for (CameraIndex cam = 0; cam < arity; ++cam) {
+      Frame &frame = frameset[cam];
+      frame.timestamp = time;
+      frame.data = backgrounds[cam].clone();
+      frameset.SetValid(cam, true);
+
+      InnerTracker::Mark mark;
+      if (!SyntheticProject(calibration_data, cam, location, &mark)) {
+        continue;
+      }
+      cv::circle(frame.data, mark.center, cvRound(mark.radius),
+                 cv::Scalar(0, 128, 255), -1, CV_AA);
+
+      if (i == 0) {
+        (*marks)[cam] = mark;
+      }
+    }
+
+    store->Add(std::move(frameset));
+  }
+}
+
+/** Frames of single camera from the store, as fast as they're read */
+class StoreVideoProvider : public VideoProvider {
+ public:
+  StoreVideoProvider(const FrameStore &store, const CameraIndex cam)
+      : store_(store),
+        cam_(cam) {
+  }
+
+  inline std::string Id() const override {
+    return "store:" + std::to_string(cam_);
+  }
+
+  FrameIterator begin() override {
+    return FrameIterator(this, new Iterator(store_, cam_));
+  }
+
+  FrameIterator end() override {
+    return FrameIterator(this);
+  }
+
+ private:
+  class Iterator : public FrameIteratorImpl {
+   public:
+    Iterator(const FrameStore &store, const CameraIndex cam)
+        : store_(store),
+          cam_(cam),
+          index_(0) {
+      Skip();
+    }
+
+    inline Frame GetFrame() const override {
+      return store_[index_][cam_];
+    }
+
+    inline void MoveNext() override {
+      ++index_;
+      Skip();
+    }
+
+    inline bool IsValid() override {
+      return index_ < store_.size();
+    }
+
+   private:
+    const FrameStore &store_;
+    const CameraIndex cam_;
+    size_t index_;
+
+    inline void Skip() {
+      while (index_ < store_.size() && !store_[index_].IsValid(cam_)) {
+        ++index_;
+      }
+    }
+  };
+
+  const FrameStore &store_;
+  const CameraIndex cam_;
+};
+
+template <class InnerTrackerT, class FramesetsT>
+void Track(const Options &options, FramesetsT &framesets,
+           const CameraIndex arity,
+           const CalibrationData &calibration_data,
+           const InnerTrackerT &inner_tracker, const Parameters &parameters,
+           Results *results) {
+
+  BasicTracker<InnerTrackerT> tracker(arity, inner_tracker, parameters);
+  tracker.calibration_data(&calibration_data);
+
+  Localization localization(arity, parameters);
+  localization.calibration_data(&calibration_data);
+
+  results->clear();
+  vector<bool> marked(arity, false);
+
+  for (auto &&frameset : framesets) {
+    /* Empty framesets are not stored, skip them alike */
+    if (frameset.ValidCount() == 0) {
+      continue;
+    }
+
+    for (CameraIndex cam = 0; cam < arity; ++cam) {
+      const auto &mark = options.marks[cam];
+      if (!marked[cam] && frameset.IsValid(cam) &&
+          mark.type != InnerTracker::Mark::kInvalid) {
+        tracker.SetMark(frameset, cam, mark);
+        marked[cam] = true;
+      }
+    }
+
+    Result result(arity);
+    const auto start = Clock::now();
+
+    result.positset = tracker.Track(frameset);
+    result.time = tracker.time();
+    result.located = localization.Locate(result.positset, &result.location);
+    if (result.located) {
+      tracker.SetLocation(result.location);
+      for (CameraIndex cam = 0; cam < arity; ++cam) {
+        if (localization.IsOutlier(cam)) {
+          tracker.Reacquire(cam);
+        }
+      }
+    }
+
+    result.latency = std::chrono::duration<double>(
+        Clock::now() - start).count();
+    results->push_back(std::move(result));
+  }
+}
+
+template <class InnerTrackerT>
+void TrackSource(const Options &options, const FrameStore &store,
+                 const CalibrationData &calibration_data, const Source source,
+                 const InnerTrackerT &inner_tracker,
+                 const Parameters &parameters, Results *results) {
+  const CameraIndex arity = store.Arity();
+  if (source == kStore) {
+    Track(options, store, arity, calibration_data, inner_tracker, parameters,
+          results);
+    return;
+  }
+
+  /* Aggregator owns the providers */
+  Aggregator::ProvidersContainer providers;
+  for (CameraIndex cam = 0; cam < arity; ++cam) {
+    auto provider = new StoreVideoProvider(store, cam);
+    if (source != kTee) {
+      providers.push_back(provider);
+      continue;
+    }
+
+    /*
+     * Branch keeps the tee's capture alive. It mustn't drop, so its queue
+     * can hold the whole session. (Capture starts with the first
+     * subscriber, additional consumers would make the result racy.)
+     */
+    TeeVideoProvider tee(provider);
+    providers.push_back(tee.Branch(store.size() + 1,
+                                   TeeVideoProvider::kDropNewest));
+  }
+
+  if (source == kAsync) {
+    FramesetAggregator<AsyncPolicy<false>> aggregator(providers, parameters);
+    Track(options, aggregator, arity, calibration_data, inner_tracker,
+          parameters, results);
+  } else {
+    FramesetAggregator<BlockingPolicy> aggregator(providers, parameters);
+    Track(options, aggregator, arity, calibration_data, inner_tracker,
+          parameters, results);
+  }
+}
+
+bool Run(const Options &options, const FrameStore &store,
+         const CalibrationData &calibration_data, const Config &config,
+         Results *results) {
+  Parameters parameters;
+  for (auto &setting : config.parameters) {
+    if (!parameters.Set(setting.first, setting.second)) {
+      ERROR("Value %f out of range", setting.second);
+      return false;
+    }
+  }
+
+  cv::setNumThreads(config.threads);
+
+  if (config.static_tracker) {
+    unique_ptr<StaticInnerTracker> inner_tracker(
+        CreateStaticInnerTracker(options.tracker, parameters));
+    if (!inner_tracker) {
+      ERROR("Tracker %s is not pinned in this build", options.tracker.c_str());
+      return false;
+    }
+    TrackSource(options, store, calibration_data, config.source,
+                *inner_tracker, parameters, results);
+  } else {
+    unique_ptr<InnerTracker> inner_tracker(
+        CreateInnerTracker(options.tracker, parameters));
+    if (!inner_tracker) {
+      ERROR("Unknown tracker %s", options.tracker.c_str());
+      return false;
+    }
+    TrackSource(options, store, calibration_data, config.source,
+                *inner_tracker, parameters, results);
+  }
+
+  return true;
+}
+
+Performance Measure(const Results &results) {
+  Performance performance;
+  if (results.empty()) {
+    return performance;
+  }
+
+  vector<double> latencies;
+  for (auto &result : results) {
+    latencies.push_back(result.latency);
+    performance.duration += result.latency;
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  performance.fps = results.size() / performance.duration;
+  performance.mean = performance.duration / results.size();
+  performance.median = latencies[latencies.size() / 2];
+  performance.p99 = latencies[(latencies.size() - 1) * 99 / 100];
+  performance.max = latencies.back();
+  return performance;
+}
+
+/** Run configuration repeatedly, the fastest run is kept */
+bool RunBest(const Options &options, const FrameStore &store,
+             const CalibrationData &calibration_data, const Config &config,
+             Results *results, Performance *performance) {
+  for (size_t i = 0; i < options.repeat; ++i) {
+    Results run;
+    if (!Run(options, store, calibration_data, config, &run)) {
+      return false;
+    }
+
+    const auto run_performance = Measure(run);
+    if (i == 0 || run_performance.duration < performance->duration) {
+      *performance = run_performance;
+      results->swap(run);
+    }
+  }
+  return true;
+}
+
+void PrintPosit(const Positset &positset, const CameraIndex cam) {
+  if (positset.IsValid(cam)) {
+    cout << "(" << positset[cam].x << ", " << positset[cam].y << ")";
+  } else {
+    cout << "-";
+  }
+}
+
+void PrintLocation(const Result &result) {
+  if (result.located) {
+    cout << "(" << result.location.x << ", " << result.location.y << ", " <<
+        result.location.z << ")";
+  } else {
+    cout << "-";
+  }
+}
+
+/** Index of candidate framesets by their time */
+typedef std::map<Frame::Timestamp, const Result *> ResultIndex;
+
+const Result *FindResult(const ResultIndex &index,
+                         const Frame::Timestamp time) {
+  auto it = index.lower_bound(time - kTimeTolerance);
+  if (it == index.end() || it->first > time + kTimeTolerance) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+Difference Compare(const Options &options, const FrameStore &store,
+                   const Results &reference, const Results &candidate) {
+  /* Reference reads the store directly */
+  assert(reference.size() == store.size());
+
+  ResultIndex candidate_index;
+  for (auto &result : candidate) {
+    candidate_index[result.time] = &result;
+  }
+
+  Difference difference;
+  size_t reported = 0;
+  size_t paired = 0;
+
+  for (size_t i = 0; i < reference.size(); ++i) {
+    const auto &ref = reference[i];
+    const size_t sequence_no = store[i].sequence_no;
+
+    const auto cand_ptr = FindResult(candidate_index, ref.time);
+    if (!cand_ptr) {
+      ++difference.unpaired;
+      if (reported++ < options.reported) {
+        cout << "frameset " << sequence_no << " missing in candidate" << endl;
+      }
+      continue;
+    }
+    const auto &cand = *cand_ptr;
+    ++paired;
+
+    for (CameraIndex cam = 0; cam < store.Arity(); ++cam) {
+      const bool ref_valid = ref.positset.IsValid(cam);
+      const bool cand_valid = cand.positset.IsValid(cam);
+      if (!ref_valid && !cand_valid) {
+        continue;
+      }
+
+      ++difference.posits;
+      bool mismatch = ref_valid != cand_valid;
+      if (!mismatch) {
+        const double error = cv::norm(ref.positset[cam] - cand.positset[cam]);
+        difference.max_posit_error = std::max(difference.max_posit_error,
+                                              error);
+        mismatch = error > options.posit_tolerance;
+      }
+
+      if (mismatch) {
+        ++difference.posit_mismatches;
+        if (reported++ < options.reported) {
+          cout << "frameset " << sequence_no << " cam " << cam << ": ";
+          PrintPosit(ref.positset, cam);
+          cout << " != ";
+          PrintPosit(cand.positset, cam);
+          cout << endl;
+        }
+      }
+    }
+
+    if (!ref.located && !cand.located) {
+      continue;
+    }
+
+    ++difference.locations;
+    bool mismatch = ref.located != cand.located;
+    if (!mismatch) {
+      const double error = cv::norm(ref.location - cand.location);
+      difference.max_location_error = std::max(difference.max_location_error,
+                                               error);
+      mismatch = error > options.location_tolerance;
+    }
+
+    if (mismatch) {
+      ++difference.location_mismatches;
+      if (reported++ < options.reported) {
+        cout << "frameset " << sequence_no << " location: ";
+        PrintLocation(ref);
+        cout << " != ";
+        PrintLocation(cand);
+        cout << endl;
+      }
+    }
+  }
+
+  /* Framesets regrouped differently (or not stored at all) */
+  if (candidate.size() > paired) {
+    difference.unpaired += candidate.size() - paired;
+  }
+
+  return difference;
+}
+
+void PrintPerformance(const string &name, const Performance &performance) {
+  cout << name << "\t" << performance.fps << "\t" <<
+      performance.mean * 1000 << "\t" << performance.median * 1000 << "\t" <<
+      performance.p99 * 1000 << "\t" << performance.max * 1000 << endl;
+}
+
+void PrintUsage(const string &name) {
+  cout << "Usage: " << name << " [-t tracker] [-n max-framesets] "
+      "[-S synthetic-framesets] [-r repeat] [-v max-reported] "
+      "[-e posit-tolerance] [-l location-tolerance] "
+      "[-c static=0|1|threads=n|source=store|blocking|async|tee|name=value]"
+      "... [-m cam,x,y,radius]... "
+      "calibration-file [video-file ...]" << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  CalibrationData calibration_data;
+  if (!CalibrationStorage::LoadFromFile(options.calibration,
+                                        &calibration_data)) {
+    return 1;
+  }
+
+  const CameraIndex arity = options.synthetic_framesets ?
+      calibration_data.Arity() : options.files.size();
+  if (arity > CONFIG_MAX_ARITY) {
+    ERROR("At most %i cameras supported", CONFIG_MAX_ARITY);
+    return 1;
+  }
+  if (calibration_data.Arity() != arity) {
+    ERROR("Calibration is for %i camera(s)", calibration_data.Arity());
+    return 1;
+  }
+
+  FrameStore store(arity);
+  if (options.synthetic_framesets) {
+    CreateSynthetic(calibration_data, options.synthetic_framesets, &store,
+                    &options.marks);
+  } else {
+    const Parameters default_parameters;
+    Aggregator::ProvidersContainer providers;
+    for (auto &file : options.files) {
+      providers.push_back(new FileVideoProvider(file));
+    }
+    FramesetAggregator<BlockingPolicy> aggregator(providers,
+                                                  default_parameters);
+    store.Load(&aggregator, options.max_framesets);
+  }
+  options.marks.resize(std::max(options.marks.size(),
+                                static_cast<size_t>(arity)));
+  DEBUG("Stored %zu framesets (%zu MiB)", store.size(),
+        store.bytes() >> 20);
+
+  Config reference;
+  reference.name = "reference";
+  options.candidate.name = "candidate";
+
+  Results reference_results, candidate_results;
+  Performance reference_performance, candidate_performance;
+  if (!RunBest(options, store, calibration_data, reference,
+               &reference_results, &reference_performance) ||
+      !RunBest(options, store, calibration_data, options.candidate,
+               &candidate_results, &candidate_performance)) {
+    return 1;
+  }
+
+  const auto difference = Compare(options, store, reference_results,
+                                   candidate_results);
+
+  cout << "config\tfps\tmean [ms]\tmedian [ms]\tp99 [ms]\tmax [ms]" << endl;
+  PrintPerformance(reference.name, reference_performance);
+  PrintPerformance(options.candidate.name, candidate_performance);
+
+  cout << "framesets: " << store.size() << " stored, " <<
+      difference.unpaired << " unpaired" << endl;
+  cout << "posits: " << difference.posits << " compared, " <<
+      difference.posit_mismatches << " mismatched, max error " <<
+      difference.max_posit_error << " px" << endl;
+  cout << "locations: " << difference.locations << " compared, " <<
+      difference.location_mismatches << " mismatched, max error " <<
+      difference.max_location_error << " m" << endl;
+  cout << (difference.Equivalent() ? "EQUIVALENT" : "DIFFERENT") << endl;
+
+  return difference.Equivalent() ? 0 : 2;
+}
@@ -0,0 +1,197 @@
+/** Query history file recorded by the daemon
+ *
+ * Prints records of a time range or their location summaries.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "dove_eye/history_store.h"
+#include "dove_eye/logging.h"
+#include "dove_eye/types.h"
+
+using dove_eye::CameraIndex;
+using dove_eye::HistoryReader;
+using dove_eye::Location;
+
+using std::cout;
+using std::endl;
+using std::string;
+
+namespace {
+
+struct Options {
+  string from;
+  string to;
+  size_t buckets = 0;
+  size_t max_records = 0;
+  string filename;
+};
+
+bool ParseOptions(int argc, char *argv[], Options *options) {
+  int i = 1;
+  for (; i < argc && argv[i][0] == '-'; i += 2) {
+    if (i + 1 >= argc) {
+      return false;
+    }
+    const string option(argv[i]);
+    const string value(argv[i + 1]);
+
+    if (option == "-f") {
+      options->from = value;
+    } else if (option == "-t") {
+      options->to = value;
+    } else if (option == "-b") {
+      options->buckets = std::stoul(value);
+    } else if (option == "-n") {
+      options->max_records = std::stoul(value);
+    } else {
+      return false;
+    }
+  }
+
+  if (argc - i != 1) {
+    return false;
+  }
+  options->filename = argv[i];
+  return true;
+}
+
+/** Parse Unix time or local "[YYYY-MM-DD ]HH:MM:SS"
+ *
+ * @param[in]  reference  date is taken from here when not specified
+ */
+bool ParseTime(const string &value, const double reference, double *result) {
+  struct tm tm;
+  const time_t reference_secs = reference;
+  localtime_r(&reference_secs, &tm);
+
+  int seconds;
+  if (std::sscanf(value.c_str(), "%d-%d-%d %d:%d:%d", &tm.tm_year, &tm.tm_mon,
+                  &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &seconds) == 6) {
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+  } else if (std::sscanf(value.c_str(), "%d:%d:%d", &tm.tm_hour, &tm.tm_min,
+                         &seconds) != 3) {
+    try {
+      size_t end;
+      *result = std::stod(value, &end);
+      return end == value.size();
+    } catch (const std::exception &) {
+      return false;
+    }
+  }
+
+  tm.tm_sec = seconds;
+  tm.tm_isdst = -1;
+  *result = std::mktime(&tm);
+  return true;
+}
+
+string FormatTime(const double time) {
+  struct tm tm;
+  const time_t secs = time;
+  localtime_r(&secs, &tm);
+
+  char buffer[64];
+  std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+  char millis[8];
+  std::snprintf(millis, sizeof(millis), ".%03d",
+                static_cast<int>((time - secs) * 1000));
+  return string(buffer) + millis;
+}
+
+void PrintRecords(const HistoryReader &reader, const double from,
+                  const double to, const size_t max_records) {
+  HistoryReader::RecordsVector records;
+  reader.Query(from, to, &records, max_records);
+
+  for (auto &record : records) {
+    cout << FormatTime(record.time) << "\t" << record.stream_time << "\t" <<
+        record.positset.sequence_no;
+    for (CameraIndex cam = 0; cam < reader.Arity(); ++cam) {
+      cout << "\t" << static_cast<int>(record.states[cam]);
+      if (record.positset.IsValid(cam)) {
+        cout << " " << record.positset[cam].x << " " <<
+            record.positset[cam].y;
+      } else {
+        cout << " -";
+      }
+    }
+    if (record.location_valid) {
+      cout << "\t" << record.location.x << " " << record.location.y << " " <<
+          record.location.z;
+    } else {
+      cout << "\t-";
+    }
+    cout << endl;
+  }
+}
+
+void PrintSummaries(const HistoryReader &reader, const double from,
+                    const double to, const size_t buckets) {
+  HistoryReader::SummariesVector summaries;
+  reader.Summarize(from, to, buckets, &summaries);
+
+  for (auto &summary : summaries) {
+    cout << FormatTime(summary.start) << "\t" << summary.records << "\t" <<
+        summary.locations;
+    if (summary.locations > 0) {
+      for (const Location &location : {summary.mean, summary.min, summary.max}) {
+        cout << "\t" << location.x << " " << location.y << " " << location.z;
+      }
+    }
+    cout << endl;
+  }
+}
+
+void PrintUsage(const string &name) {
+  cout << "Usage: " << name << " [-f from] [-t to] [-b buckets] [-n max] file" <<
+      endl;
+  cout << "  time is Unix time or [YYYY-MM-DD ]HH:MM:SS" << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  HistoryReader reader;
+  if (!reader.Open(options.filename)) {
+    ERROR("Cannot open history %s", options.filename.c_str());
+    return 1;
+  }
+  if (reader.Empty()) {
+    return 0;
+  }
+
+  double from = reader.start_time();
+  double to = reader.end_time();
+  if ((!options.from.empty() &&
+       !ParseTime(options.from, reader.start_time(), &from)) ||
+      (!options.to.empty() &&
+       !ParseTime(options.to, reader.start_time(), &to))) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  if (options.buckets > 0) {
+    /* Summaries are half-open, include the last record */
+    const double end = options.to.empty() ?
+        std::nextafter(to, std::numeric_limits<double>::infinity()) : to;
+    PrintSummaries(reader, from, end, options.buckets);
+  } else {
+    PrintRecords(reader, from, to, options.max_records);
+  }
+
+  return 0;
+}
@@ -0,0 +1,161 @@
+#!/bin/bash
+#
+# Runs a distributed rig on localhost: the hub and one node per camera, each
+# node in a separate process. Cameras are video files replayed in real time,
+# in media time or, with -l, live with every node's clock shifted by a
+# different skew, so that the hub has to align clocks.
+#
+# Locations of the hub are checked against a single-process run (the batch
+# tool with one segment). Hub's times are paired with the reference after
+# removing their offset (median time difference of spatially nearest
+# locations), the check fails when RMS distance of pairs exceeds tolerance.
+#
+
+usage() {
+	echo "Usage: $0 [-b build-dir] [-p port] [-l skew] [-t seconds]" \
+		"[-e tolerance] calibration-file video[@x,y,radius] ..." >&2
+	exit 1
+}
+
+build=build
+port=5151
+skew=
+timeout=60
+tolerance=0.05
+
+while getopts "b:p:l:t:e:" opt ; do
+	case $opt in
+		b) build="$OPTARG" ;;
+		p) port="$OPTARG" ;;
+		l) skew="$OPTARG" ;;
+		t) timeout="$OPTARG" ;;
+		e) tolerance="$OPTARG" ;;
+		*) usage ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+[ $# -ge 3 ] || usage
+
+calibration="$1"
+shift
+arity=$#
+
+hub="$build/tools/hub/dove-eye-hub"
+node="$build/tools/node/dove-eye-node"
+batch="$build/tools/batch/dove-eye-batch"
+for bin in "$hub" "$node" "$batch" ; do
+	if [ ! -x "$bin" ] ; then
+		echo "$bin not found (build with CONFIG_NODES)" >&2
+		exit 1
+	fi
+done
+
+tmp=$(mktemp -d)
+pids=()
+cleanup() {
+	kill "${pids[@]}" 2>/dev/null
+	wait 2>/dev/null
+	rm -rf "$tmp"
+}
+trap cleanup EXIT
+
+# Single-process reference
+videos=()
+marks=()
+cam=0
+for source in "$@" ; do
+	video="${source%@*}"
+	videos+=("$video")
+	if [ "$video" != "$source" ] ; then
+		marks+=(-m "$cam,${source#*@}")
+	fi
+	cam=$((cam + 1))
+done
+
+if ! "$batch" -j 1 -s 1e9 "${marks[@]}" "$calibration" "${videos[@]}" \
+		>"$tmp/reference" ; then
+	echo "Reference run failed" >&2
+	exit 1
+fi
+
+# Distributed run
+"$hub" -p "$port" "$arity" "$calibration" >"$tmp/hub" &
+pids+=($!)
+sleep 1
+
+node_pids=()
+for ((cam = 0; cam < arity; ++cam)) ; do
+	args=(-n "$cam")
+	source="${@:$((cam + 1)):1}"
+	if [ "${videos[$cam]}" != "$source" ] ; then
+		args+=(-m "0,${source#*@}")
+	fi
+	if [ -n "$skew" ] ; then
+		args+=(-L "$(awk -v c="$cam" -v s="$skew" 'BEGIN { print c * s }')")
+	fi
+
+	"$node" "${args[@]}" "127.0.0.1:$port" "$cam" "${videos[$cam]}" &
+	node_pids+=($!)
+	pids+=($!)
+done
+
+# Nodes finish at the end of their videos
+for ((i = 0; i < timeout; ++i)) ; do
+	running=0
+	for pid in "${node_pids[@]}" ; do
+		kill -0 "$pid" 2>/dev/null && running=1
+	done
+	[ $running -eq 0 ] && break
+	sleep 1
+done
+
+kill "${pids[@]}" 2>/dev/null
+wait 2>/dev/null
+
+if [ ! -s "$tmp/hub" ] || [ ! -s "$tmp/reference" ] ; then
+	echo "No locations (hub $(wc -l <"$tmp/hub")," \
+		"reference $(wc -l <"$tmp/reference"))" >&2
+	exit 1
+fi
+
+# Time offset of hub's locations: median over spatially nearest references
+offset=$(awk '
+	NR == FNR { t[n] = $1; x[n] = $2; y[n] = $3; z[n] = $4; ++n; next }
+	{
+		best = -1
+		for (i = 0; i < n; ++i) {
+			d = ($3 - x[i])^2 + ($4 - y[i])^2 + ($5 - z[i])^2
+			if (best < 0 || d < best) { best = d; bt = t[i] }
+		}
+		print $2 - bt
+	}' "$tmp/reference" "$tmp/hub" | sort -g | awk '
+	{ v[NR] = $1 }
+	END { print v[int((NR + 1) / 2)] }')
+
+# Pair by time and compare
+awk -v offset="$offset" -v tolerance="$tolerance" '
+	NR == FNR { t[n] = $1; x[n] = $2; y[n] = $3; z[n] = $4; ++n; next }
+	{
+		time = $2 - offset
+		best = -1
+		for (i = 0; i < n; ++i) {
+			dt = time - t[i]
+			if (dt < 0) dt = -dt
+			if (best < 0 || dt < best) { best = dt; b = i }
+		}
+		# Farther than a typical frame interval, no counterpart
+		if (best > 0.1) { ++unpaired; next }
+		sum += ($3 - x[b])^2 + ($4 - y[b])^2 + ($5 - z[b])^2
+		++paired
+	}
+	END {
+		if (!paired) {
+			print "No hub location paired with reference"
+			exit 1
+		}
+		rms = sqrt(sum / paired)
+		printf "%d location(s) paired (%d unpaired), offset %g s, RMS %g\n",
+			paired, unpaired, offset, rms
+		exit !(rms <= tolerance)
+	}' "$tmp/reference" "$tmp/hub"
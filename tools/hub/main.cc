@@ -0,0 +1,326 @@
+/** Central localizer of distributed rig
+ *
+ * Receives posits from capture nodes, aligns their clocks, aggregates them
+ * into positsets and localizes the object.
+ */
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <poll.h>
+
+#include "config.h"
+#include "dove_eye/calibration_data.h"
+#include "dove_eye/calibration_storage.h"
+#include "dove_eye/clock_offset.h"
+#include "dove_eye/frame_iterator/clock_policy.h"
+#include "dove_eye/localization.h"
+#include "dove_eye/location.h"
+#include "dove_eye/logging.h"
+#include "dove_eye/node_protocol.h"
+#include "dove_eye/parameters.h"
+#include "dove_eye/posit_aggregator.h"
+#ifdef CONFIG_SHM
+#include "dove_eye/shm_result_publisher.h"
+#endif
+#include "dove_eye/types.h"
+#include "tool_options.h"
+
+using dove_eye::CalibrationData;
+using dove_eye::CalibrationStorage;
+using dove_eye::CameraIndex;
+using dove_eye::ClockOffset;
+using dove_eye::Frame;
+using dove_eye::Localization;
+using dove_eye::Location;
+using dove_eye::Parameters;
+using dove_eye::Posit;
+using dove_eye::PositAggregator;
+using dove_eye::frame_iterator::ClockPolicy;
+using dove_eye::node::Connection;
+using dove_eye::node::Message;
+
+using tools::LoadParameters;
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace {
+
+/** Period of clock probes (in seconds) */
+const double kPingPeriod = 1;
+
+const int kPollTimeout = 100; /* ms */
+
+struct Node {
+  unique_ptr<Connection> connection;
+  bool has_hello = false;
+  Message hello;
+  ClockOffset clock_offset;
+};
+
+typedef vector<unique_ptr<Node>> NodeVector;
+
+class Hub {
+ public:
+  Hub(const CameraIndex arity, const Parameters &parameters,
+      const CalibrationData &calibration_data)
+      : arity_(arity),
+        calibration_data_(calibration_data),
+        aggregator_(arity, parameters),
+        localization_(arity, parameters),
+        last_ping_(0) {
+    localization_.calibration_data(&calibration_data_);
+  }
+
+#ifdef CONFIG_SHM
+  inline void result_publisher(dove_eye::shm::ResultPublisher *value) {
+    result_publisher_ = value;
+  }
+#endif
+
+  int Run(const int listen_fd);
+
+ private:
+  const CameraIndex arity_;
+  const CalibrationData calibration_data_;
+  PositAggregator aggregator_;
+  Localization localization_;
+
+  NodeVector nodes_;
+  Frame::Timestamp last_ping_;
+
+#ifdef CONFIG_SHM
+  dove_eye::shm::ResultPublisher *result_publisher_ = nullptr;
+#endif
+
+  void PingNodes();
+
+  void HandleMessage(Node *node, const Message &message);
+
+  void HandlePosit(Node *node, const Message &message);
+};
+
+int Hub::Run(const int listen_fd) {
+  while (true) {
+    vector<struct pollfd> fds(nodes_.size() + 1);
+    fds[0].fd = listen_fd;
+    fds[0].events = POLLIN;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      fds[i + 1].fd = nodes_[i]->connection->fd();
+      fds[i + 1].events = POLLIN;
+    }
+
+    if (poll(fds.data(), fds.size(), kPollTimeout) < 0) {
+      ERROR("poll failed");
+      return 1;
+    }
+
+    if (fds[0].revents & POLLIN) {
+      unique_ptr<Node> node(new Node());
+      node->connection.reset(dove_eye::node::Accept(listen_fd));
+      if (node->connection) {
+        nodes_.push_back(std::move(node));
+      }
+    }
+
+    for (size_t i = 0; i < fds.size() - 1; ++i) {
+      if (!fds[i + 1].revents) {
+        continue;
+      }
+
+      auto node = nodes_[i].get();
+      const bool open = node->connection->Receive();
+
+      /* Process what was received before peer hung up */
+      Message message;
+      while (node->connection->Pop(&message)) {
+        HandleMessage(node, message);
+      }
+
+      if (!open) {
+        node->connection->Close();
+      }
+    }
+
+    /* Forget disconnected nodes */
+    for (auto it = nodes_.begin(); it != nodes_.end();) {
+      if (!(*it)->connection->IsOpen()) {
+        DEBUG("Node %u disconnected", (*it)->hello.node_id);
+        it = nodes_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    PingNodes();
+  }
+
+  return 0;
+}
+
+void Hub::PingNodes() {
+  const auto now = ClockPolicy::Now();
+  if (now - last_ping_ < kPingPeriod) {
+    return;
+  }
+  last_ping_ = now;
+
+  for (auto &node : nodes_) {
+    Message ping(Message::kPing);
+    ping.t0 = ClockPolicy::Now();
+    if (!node->connection->Send(ping)) {
+      node->connection->Close();
+    }
+  }
+}
+
+void Hub::HandleMessage(Node *node, const Message &message) {
+  switch (message.type) {
+    case Message::kHello:
+      node->hello = message;
+      node->has_hello = true;
+      DEBUG("Node %u with cameras %u..%u", message.node_id, message.first_cam,
+            message.first_cam + message.camera_count - 1);
+      break;
+    case Message::kPong:
+      node->clock_offset.AddSample(message.t0, message.t1, message.t2,
+                                   ClockPolicy::Now());
+      break;
+    case Message::kPosit:
+      HandlePosit(node, message);
+      break;
+    default:
+      break;
+  }
+}
+
+void Hub::HandlePosit(Node *node, const Message &message) {
+  if (!node->has_hello || message.cam >= static_cast<uint32_t>(arity_)) {
+    return;
+  }
+
+  /* Node may report only its own cameras */
+  const auto &hello = node->hello;
+  if (message.cam < hello.first_cam ||
+      message.cam >= hello.first_cam + hello.camera_count) {
+    DEBUG("Node %u sent posit of foreign camera %u", hello.node_id,
+          message.cam);
+    return;
+  }
+
+  /* Cannot place posit in time until clocks are aligned */
+  Frame::Timestamp timestamp = message.timestamp;
+  if (!node->hello.media_time) {
+    if (!node->clock_offset.valid()) {
+      return;
+    }
+    timestamp = node->clock_offset.ToLocal(timestamp);
+  }
+
+  const Posit posit(message.x, message.y);
+  if (!aggregator_.Add(message.cam, posit, message.valid, timestamp,
+                       message.predicted)) {
+    return;
+  }
+
+  const auto &positset = aggregator_.positset();
+#ifdef CONFIG_SHM
+  if (result_publisher_) {
+    result_publisher_->Publish(positset, aggregator_.time());
+  }
+#endif
+
+  Location location;
+  if (!localization_.Locate(positset, &location)) {
+    return;
+  }
+
+  cout << positset.sequence_no << " " << aggregator_.time() << " " <<
+      location.x << " " << location.y << " " << location.z << endl;
+
+#ifdef CONFIG_SHM
+  if (result_publisher_) {
+    result_publisher_->Publish(location, positset.sequence_no,
+                               aggregator_.time());
+  }
+#endif
+}
+
+void PrintUsage(const string &name) {
+  cout << "Usage: " << name << " [-p port] [-s shm-name] "
+      "[-c parameters-file] arity calibration-file" << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  uint16_t port = dove_eye::node::kDefaultPort;
+  string shm_name;
+  string parameters_file;
+
+  int i = 1;
+  for (; i + 1 < argc && argv[i][0] == '-'; i += 2) {
+    const string option(argv[i]);
+    if (option == "-p") {
+      port = std::stoul(argv[i + 1]);
+    } else if (option == "-s") {
+      shm_name = argv[i + 1];
+    } else if (option == "-c") {
+      parameters_file = argv[i + 1];
+    } else {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (argc - i != 2) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  const CameraIndex arity = std::stoi(argv[i]);
+  if (arity < 2 || arity > CONFIG_MAX_ARITY) {
+    ERROR("Arity must be between 2 and %i (build option CONFIG_MAX_ARITY)",
+          CONFIG_MAX_ARITY);
+    return 1;
+  }
+
+  CalibrationData calibration_data;
+  if (!CalibrationStorage::LoadFromFile(argv[i + 1], &calibration_data)) {
+    return 1;
+  }
+  if (calibration_data.Arity() != arity) {
+    ERROR("Calibration is for %i camera(s)", calibration_data.Arity());
+    return 1;
+  }
+
+  Parameters parameters;
+  if (!parameters_file.empty() &&
+      !LoadParameters(parameters_file, &parameters)) {
+    return 1;
+  }
+  Hub hub(arity, parameters, calibration_data);
+
+#ifdef CONFIG_SHM
+  dove_eye::shm::ResultPublisher result_publisher;
+  if (!shm_name.empty()) {
+    if (!result_publisher.Create(shm_name)) {
+      return 1;
+    }
+    hub.result_publisher(&result_publisher);
+  }
+#endif
+
+  const int listen_fd = dove_eye::node::Listen(port);
+  if (listen_fd < 0) {
+    return 1;
+  }
+
+  return hub.Run(listen_fd);
+}
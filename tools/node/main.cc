@@ -0,0 +1,320 @@
+/** Capture node of distributed rig
+ *
+ * Tracks local cameras (or video files) and streams posits to the hub.
+ */
+
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+
+#include "dove_eye/async_policy.h"
+#include "dove_eye/blocking_policy.h"
+#include "dove_eye/camera_profile.h"
+#include "dove_eye/camera_video_provider.h"
+#include "dove_eye/file_video_provider.h"
+#include "dove_eye/frame_iterator/clock_policy.h"
+#include "dove_eye/frameset_aggregator.h"
+#include "dove_eye/logging.h"
+#include "dove_eye/mjpeg_decoder.h"
+#include "dove_eye/node_protocol.h"
+#include "dove_eye/parameters.h"
+#include "dove_eye/static_tracker.h"
+#include "dove_eye/types.h"
+#include "tool_options.h"
+
+using dove_eye::Aggregator;
+using dove_eye::AsyncPolicy;
+using dove_eye::BlockingPolicy;
+using dove_eye::CameraIndex;
+using dove_eye::CameraProfile;
+using dove_eye::CameraVideoProvider;
+using dove_eye::CreateStaticInnerTracker;
+using dove_eye::FileVideoProvider;
+using dove_eye::FramesetAggregator;
+using dove_eye::InnerTracker;
+using dove_eye::MjpegDecoder;
+using dove_eye::Parameters;
+using dove_eye::StaticInnerTracker;
+using dove_eye::StaticTracker;
+using dove_eye::frame_iterator::ClockPolicy;
+using dove_eye::node::Connection;
+using dove_eye::node::Message;
+
+using tools::IsDevice;
+using tools::LoadParameters;
+using tools::ParseMark;
+using tools::ParseMjpeg;
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace {
+
+typedef std::lock_guard<std::mutex> Lock;
+
+struct Options {
+  uint32_t node_id = 0;
+  string tracker = dove_eye::kDefaultStaticTracker;
+  string host;
+  uint16_t port = dove_eye::node::kDefaultPort;
+  CameraIndex first_cam = 0;
+  string camera_profile;
+  string parameters;
+  bool mjpeg = false;
+  MjpegDecoder::Options mjpeg_options;
+  vector<string> sources;
+  /* Marks to initialize tracking, indexed by local camera */
+  vector<InnerTracker::Mark> marks;
+  /* Replay video files in real time stamped by (shifted) node clock */
+  bool live_replay = false;
+  double clock_skew = 0;
+};
+
+bool ParseOptions(int argc, char *argv[], Options *options) {
+  int i = 1;
+  for (; i < argc && argv[i][0] == '-'; i += 2) {
+    if (i + 1 >= argc) {
+      return false;
+    }
+    const string option(argv[i]);
+    const string value(argv[i + 1]);
+
+    if (option == "-n") {
+      options->node_id = std::stoul(value);
+    } else if (option == "-t") {
+      options->tracker = value;
+    } else if (option == "-m") {
+      if (!ParseMark(value, &options->marks)) {
+        return false;
+      }
+    } else if (option == "-P") {
+      options->camera_profile = value;
+    } else if (option == "-c") {
+      options->parameters = value;
+    } else if (option == "-L") {
+      options->live_replay = true;
+      options->clock_skew = std::stod(value);
+    } else if (option == "-J") {
+      options->mjpeg = true;
+      if (!ParseMjpeg(value, &options->mjpeg_options)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+
+  if (argc - i < 3) {
+    return false;
+  }
+
+  string address(argv[i]);
+  auto colon = address.rfind(':');
+  if (colon != string::npos) {
+    options->port = std::stoul(address.substr(colon + 1));
+    address = address.substr(0, colon);
+  }
+  options->host = address;
+  options->first_cam = std::stoi(argv[i + 1]);
+  options->sources.assign(argv + i + 2, argv + argc);
+  options->marks.resize(options->sources.size());
+
+  return true;
+}
+
+/** Answer hub's clock probes as soon as they arrive
+ *
+ * @param[in]  skew  added to node clock readings
+ */
+void ServePings(Connection *connection, std::mutex *send_mtx,
+                const double skew) {
+  struct pollfd fds;
+  fds.fd = connection->fd();
+  fds.events = POLLIN;
+
+  while (poll(&fds, 1, -1) >= 0) {
+    const auto receive_time = ClockPolicy::Now() + skew;
+    if (!connection->Receive()) {
+      break;
+    }
+
+    Message message;
+    while (connection->Pop(&message)) {
+      if (message.type != Message::kPing) {
+        continue;
+      }
+
+      Message pong(Message::kPong);
+      pong.t0 = message.t0;
+      pong.t1 = receive_time;
+      pong.t2 = ClockPolicy::Now() + skew;
+
+      Lock lock(*send_mtx);
+      connection->Send(pong);
+    }
+  }
+}
+
+void PrintUsage(const string &name) {
+  cout << "Usage: " << name << " [-n node-id] [-t tracker] "
+      "[-m cam,x,y,radius]... [-P camera-profile] [-c parameters-file] "
+      "[-J color|gray[:scale]] [-L clock-skew] "
+      "host[:port] first-cam video-file|device ..." << endl;
+  cout << "  -L  replay video files in real time as if they were live "
+      "cameras," << endl <<
+      "      node clock shifted by clock-skew seconds (tests clock alignment)"
+      << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  Parameters parameters;
+  if (!options.parameters.empty() &&
+      !LoadParameters(options.parameters, &parameters)) {
+    return 1;
+  }
+  const CameraIndex arity = options.sources.size();
+
+  /*
+   * Video files are replayed in real time (unless the speed is given), nodes
+   * share the hub's window and unpaced replay would let the fastest node
+   * drive it. Live replay maps media time onto node clock one to one.
+   */
+  if (options.live_replay || !parameters.Get(Parameters::PLAYBACK_SPEED)) {
+    parameters.Set(Parameters::PLAYBACK_SPEED, 1);
+  }
+
+  CameraProfile camera_profile;
+  if (!options.camera_profile.empty() &&
+      !CameraProfile::LoadFromFile(options.camera_profile, &camera_profile)) {
+    return 1;
+  }
+
+  /* Live cameras are in node's clock, video files in media time (unless
+   * replayed live) */
+  bool media_time = !options.live_replay;
+  Aggregator::ProvidersContainer providers;
+  for (auto source : options.sources) {
+    if (IsDevice(source)) {
+      if (options.live_replay) {
+        ERROR("Live replay is for video files only");
+        return 1;
+      }
+      auto provider = new CameraVideoProvider(std::stoi(source));
+      if (!options.camera_profile.empty()) {
+        provider->profile(&camera_profile);
+      }
+      provider->mjpeg(options.mjpeg, options.mjpeg_options);
+      providers.push_back(provider);
+      media_time = false;
+    } else {
+      providers.push_back(new FileVideoProvider(source));
+    }
+  }
+
+  unique_ptr<Aggregator> aggregator;
+  if (media_time || options.live_replay) {
+    aggregator.reset(
+        new FramesetAggregator<BlockingPolicy>(providers, parameters));
+  } else {
+    aggregator.reset(
+        new FramesetAggregator<AsyncPolicy<true>>(providers, parameters));
+  }
+
+  unique_ptr<StaticInnerTracker> inner_tracker(
+      CreateStaticInnerTracker(options.tracker, parameters));
+  if (!inner_tracker) {
+    ERROR("Unknown tracker %s (or not in this build)", options.tracker.c_str());
+    return 1;
+  }
+  StaticTracker tracker(arity, *inner_tracker, parameters);
+
+  unique_ptr<Connection> connection(
+      Connection::Connect(options.host, options.port));
+  if (!connection) {
+    return 1;
+  }
+
+  std::mutex send_mtx;
+  Message hello(Message::kHello);
+  hello.node_id = options.node_id;
+  hello.first_cam = options.first_cam;
+  hello.camera_count = arity;
+  hello.media_time = media_time;
+  if (!connection->Send(hello)) {
+    return 1;
+  }
+
+  std::thread ping_thread(ServePings, connection.get(), &send_mtx,
+                          options.clock_skew);
+
+  /* Paced playback starts with the first frame, map media time onto node
+   * clock from there */
+  const double replay_origin = ClockPolicy::Now() + options.clock_skew;
+
+  int rc = 0;
+  vector<bool> marked(arity, false);
+  for (auto frameset : *aggregator) {
+    for (CameraIndex cam = 0; cam < arity; ++cam) {
+      const auto &mark = options.marks[cam];
+      if (!marked[cam] && frameset.IsValid(cam) &&
+          mark.type != InnerTracker::Mark::kInvalid) {
+        tracker.SetMark(frameset, cam, mark);
+        marked[cam] = true;
+      }
+    }
+
+    const auto positset = tracker.Track(frameset);
+
+    Lock lock(send_mtx);
+    for (CameraIndex cam = 0; cam < arity; ++cam) {
+      if (!frameset.IsValid(cam)) {
+        continue;
+      }
+
+      Message posit(Message::kPosit);
+      posit.cam = options.first_cam + cam;
+      posit.valid = positset.IsValid(cam);
+      posit.predicted = positset.IsPredicted(cam);
+      posit.sequence_no = frameset.sequence_no;
+      posit.timestamp = frameset[cam].timestamp;
+      if (options.live_replay) {
+        posit.timestamp += replay_origin;
+      }
+      posit.x = positset[cam].x;
+      posit.y = positset[cam].y;
+
+      if (!connection->Send(posit)) {
+        rc = 1;
+        break;
+      }
+    }
+
+    if (rc) {
+      ERROR("Hub disconnected");
+      break;
+    }
+  }
+
+  /* Wake up the ping thread */
+  shutdown(connection->fd(), SHUT_RDWR);
+  ping_thread.join();
+
+  return rc;
+}
@@ -0,0 +1,106 @@
+/** Reference producer of shared memory frame ring
+ *
+ * Reads a video file or camera and publishes frames for ShmVideoProvider.
+ * Serves for testing and as an example for vendor capture processes.
+ */
+
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <opencv2/opencv.hpp>
+
+#include "dove_eye/logging.h"
+#include "dove_eye/shm_frame_ring.h"
+#include "dove_eye/shm_segment.h"
+#include "tool_options.h"
+
+using dove_eye::MonotonicNanoseconds;
+using dove_eye::shm::FrameRingWriter;
+
+using tools::IsDevice;
+
+using std::cout;
+using std::endl;
+using std::string;
+
+namespace {
+
+const uint32_t kDefaultSlots = 8;
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void HandleSignal(int) {
+  stop_requested = 1;
+}
+
+void PrintUsage(const string &name) {
+  cout << "Usage: " << name << " shm-name video-file|device [slots]" << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  const string name(argv[1]);
+  const string source(argv[2]);
+  const uint32_t slots = (argc > 3) ? std::stoul(argv[3]) : kDefaultSlots;
+
+  const bool live = IsDevice(source);
+  cv::VideoCapture capture;
+  if (live) {
+    capture.open(std::stoi(source));
+  } else {
+    capture.open(source);
+  }
+
+  if (!capture.isOpened()) {
+    ERROR("Cannot open %s", source.c_str());
+    return 1;
+  }
+
+  const double fps = capture.get(CV_CAP_PROP_FPS);
+  /* Files are replayed in real-time */
+  const auto period = std::chrono::duration<double>(
+      (!live && fps > 0) ? 1 / fps : 0);
+
+  std::signal(SIGINT, HandleSignal);
+  std::signal(SIGTERM, HandleSignal);
+
+  FrameRingWriter writer;
+  cv::Mat frame;
+  uint64_t published = 0;
+  auto next_frame = std::chrono::steady_clock::now();
+
+  while (!stop_requested && capture.grab()) {
+    /* Timestamp of capture, not of the (possibly slow) decoding */
+    const uint64_t timestamp = MonotonicNanoseconds();
+    if (!capture.retrieve(frame)) {
+      break;
+    }
+
+    if (published == 0 &&
+        !writer.Create(name, frame.size(), frame.type(), slots, fps)) {
+      return 1;
+    }
+
+    writer.Publish(frame, timestamp);
+    ++published;
+
+    next_frame += std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(period);
+    std::this_thread::sleep_until(next_frame);
+  }
+
+  cout << published << " frame(s) published, " << writer.dropped() <<
+      " dropped" << endl;
+  writer.Close();
+
+  return 0;
+}
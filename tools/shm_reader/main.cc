@@ -0,0 +1,81 @@
+/** Example consumer of results published by dove-eye
+ *
+ * Depends on dove_eye/shm_result_reader.h only, no linking with dove-eye or
+ * OpenCV is needed.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "dove_eye/shm_result_reader.h"
+
+using dove_eye::shm::ResultReader;
+using dove_eye::shm::ResultRecord;
+
+using std::cout;
+using std::endl;
+using std::string;
+
+namespace {
+
+const char kDefaultName[] = "/dove-eye-results";
+
+/** Polling period, publisher doesn't notify readers */
+const std::chrono::milliseconds kPollPeriod(1);
+
+void PrintRecord(const ResultRecord &record) {
+  cout << record.sequence_no << " " << record.timestamp << " ";
+
+  switch (record.kind) {
+    case ResultRecord::kPositset:
+      cout << "posits";
+      for (uint32_t cam = 0; cam < record.arity; ++cam) {
+        if (record.valid_mask & (1u << cam)) {
+          cout << " [" << record.posits[cam][0] << ", " <<
+              record.posits[cam][1] << "]";
+        } else {
+          cout << " -";
+        }
+      }
+      break;
+    case ResultRecord::kLocation:
+      cout << "location [" << record.location[0] << ", " <<
+          record.location[1] << ", " << record.location[2] << "]";
+      break;
+    default:
+      cout << "unknown";
+      break;
+  }
+
+  cout << " (source " << record.source << ")" << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  const string name = (argc > 1) ? argv[1] : kDefaultName;
+
+  ResultReader reader;
+  if (!reader.Open(name.c_str())) {
+    std::cerr << "Cannot open result ring " << name << endl;
+    return 1;
+  }
+
+  ResultRecord record;
+  uint64_t lost;
+  while (true) {
+    if (!reader.Next(&record, &lost)) {
+      std::this_thread::sleep_for(kPollPeriod);
+      continue;
+    }
+
+    if (lost) {
+      std::cerr << lost << " record(s) lost" << endl;
+    }
+    PrintRecord(record);
+  }
+
+  return 0;
+}
@@ -0,0 +1,488 @@
+/** Offline parameter sweep
+ *
+ * Decodes a recording once and then tracks and localizes it with every
+ * combination of given parameter values in parallel. Combinations are
+ * scored against ground truth locations or, without it, by smoothness of
+ * the trajectory. Framesets that should have been scored but have no location
+ * are charged with the worst term of the combination, so that losing the
+ * object never improves the score.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "dove_eye/blocking_policy.h"
+#include "dove_eye/calibration_data.h"
+#include "dove_eye/calibration_storage.h"
+#include "dove_eye/file_video_provider.h"
+#include "dove_eye/frame_store.h"
+#include "dove_eye/frameset_aggregator.h"
+#include "dove_eye/localization.h"
+#include "dove_eye/location.h"
+#include "dove_eye/logging.h"
+#include "dove_eye/parameters.h"
+#include "dove_eye/static_tracker.h"
+#include "dove_eye/types.h"
+#include "tool_options.h"
+
+using dove_eye::Aggregator;
+using dove_eye::BlockingPolicy;
+using dove_eye::CalibrationData;
+using dove_eye::CalibrationStorage;
+using dove_eye::CameraIndex;
+using dove_eye::CreateStaticInnerTracker;
+using dove_eye::FileVideoProvider;
+using dove_eye::Frame;
+using dove_eye::FrameStore;
+using dove_eye::Frameset;
+using dove_eye::FramesetAggregator;
+using dove_eye::InnerTracker;
+using dove_eye::Localization;
+using dove_eye::Location;
+using dove_eye::Parameters;
+using dove_eye::StaticInnerTracker;
+using dove_eye::StaticTracker;
+
+using tools::FindKey;
+using tools::ParseMark;
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace {
+
+/** Ground truth locations by time */
+typedef std::map<Frame::Timestamp, Location> GroundTruth;
+
+/** Ground truth times are compared with this tolerance */
+const double kTimeTolerance = 1e-4;
+
+struct Axis {
+  Parameters::Key key;
+  string name;
+  vector<double> values;
+};
+
+struct Options {
+  string tracker = dove_eye::kDefaultStaticTracker;
+  size_t jobs = 0;
+  size_t max_framesets = 0;
+  string ground_truth;
+  string calibration;
+  vector<Axis> axes;
+  vector<string> files;
+  /* Marks to initialize tracking, indexed by camera */
+  vector<InnerTracker::Mark> marks;
+};
+
+struct Job {
+  vector<double> values;
+
+  bool valid = false;
+  size_t locations = 0;
+  /* RMS error against ground truth or mean acceleration (lower is better) */
+  double score = 0;
+};
+
+/** Accumulates per frameset terms of the score */
+struct Score {
+  double sum = 0;
+  double worst = 0;
+  size_t count = 0;
+  size_t missing = 0;
+
+  inline void Add(const double term) {
+    sum += term;
+    worst = std::max(worst, term);
+    ++count;
+  }
+
+  /** Mean term, missing ones are worst */
+  inline double Mean() const {
+    return (sum + missing * worst) / (count + missing);
+  }
+};
+
+/** Parse "name=v1,v2,..." */
+bool ParseAxis(const string &value, Options *options) {
+  auto eq = value.find('=');
+  if (eq == string::npos) {
+    return false;
+  }
+
+  Axis axis;
+  axis.name = value.substr(0, eq);
+  if (!FindKey(axis.name, &axis.key)) {
+    ERROR("Unknown parameter %s", axis.name.c_str());
+    return false;
+  }
+
+  std::istringstream ss(value.substr(eq + 1));
+  string item;
+  while (std::getline(ss, item, ',')) {
+    axis.values.push_back(std::stod(item));
+  }
+  if (axis.values.empty()) {
+    return false;
+  }
+
+  options->axes.push_back(axis);
+  return true;
+}
+
+bool ParseOptions(int argc, char *argv[], Options *options) {
+  int i = 1;
+  for (; i < argc && argv[i][0] == '-'; i += 2) {
+    if (i + 1 >= argc) {
+      return false;
+    }
+    const string option(argv[i]);
+    const string value(argv[i + 1]);
+
+    if (option == "-t") {
+      options->tracker = value;
+    } else if (option == "-j") {
+      options->jobs = std::stoul(value);
+    } else if (option == "-n") {
+      options->max_framesets = std::stoul(value);
+    } else if (option == "-g") {
+      options->ground_truth = value;
+    } else if (option == "-p") {
+      if (!ParseAxis(value, options)) {
+        return false;
+      }
+    } else if (option == "-m") {
+      if (!ParseMark(value, &options->marks)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+
+  if (argc - i < 3) {
+    return false;
+  }
+
+  options->calibration = argv[i];
+  options->files.assign(argv + i + 1, argv + argc);
+  options->marks.resize(
+      std::max(options->marks.size(), options->files.size()));
+  return true;
+}
+
+/** Ground truth has lines "sequence_no time x y z" (output of the hub)
+ *
+ * Sequence numbers are the hub's own, only time is used.
+ */
+bool LoadGroundTruth(const string &filename, GroundTruth *ground_truth) {
+  std::ifstream input(filename);
+  if (!input) {
+    ERROR("Cannot open %s", filename.c_str());
+    return false;
+  }
+
+  size_t sequence_no;
+  Frame::Timestamp time;
+  Location location;
+  while (input >> sequence_no >> time >>
+         location.x >> location.y >> location.z) {
+    (*ground_truth)[time] = location;
+  }
+  return true;
+}
+
+/** Time of the frameset (its latest frame) */
+Frame::Timestamp FramesetTime(const Frameset &frameset) {
+  Frame::Timestamp time = 0;
+  for (CameraIndex cam = 0; cam < frameset.Arity(); ++cam) {
+    if (frameset.IsValid(cam)) {
+      time = std::max(time, frameset[cam].timestamp);
+    }
+  }
+  return time;
+}
+
+/** Cartesian product of axes values */
+vector<Job> CreateJobs(const vector<Axis> &axes) {
+  vector<Job> jobs(1);
+  for (auto &axis : axes) {
+    vector<Job> expanded;
+    for (auto &job : jobs) {
+      for (auto value : axis.values) {
+        Job new_job(job);
+        new_job.values.push_back(value);
+        expanded.push_back(new_job);
+      }
+    }
+    jobs.swap(expanded);
+  }
+  return jobs;
+}
+
+class Sweep {
+ public:
+  Sweep(const Options &options, const FrameStore &store,
+        const CalibrationData &calibration_data,
+        const GroundTruth &ground_truth)
+      : options_(options),
+        store_(store),
+        calibration_data_(calibration_data),
+        ground_truth_(ground_truth) {
+  }
+
+  void Run(vector<Job> *jobs, const size_t threads);
+
+ private:
+  const Options &options_;
+  const FrameStore &store_;
+  const CalibrationData &calibration_data_;
+  const GroundTruth &ground_truth_;
+
+  std::atomic<size_t> next_job_;
+
+  void Worker(vector<Job> *jobs);
+
+  void Evaluate(Job *job) const;
+
+  /** Ground truth of the stored frameset
+   *
+   * Hub emits a location once frames of the next frameset arrive, hence it's
+   * the first one between times of the frameset and the next one.
+   *
+   * @return  false when there's none (or it's the last frameset)
+   */
+  bool FindGroundTruth(const size_t index, Location *location) const;
+};
+
+void Sweep::Run(vector<Job> *jobs, const size_t threads) {
+  next_job_ = 0;
+
+  vector<std::thread> workers;
+  for (size_t i = 0; i < threads; ++i) {
+    workers.push_back(std::thread(&Sweep::Worker, this, jobs));
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void Sweep::Worker(vector<Job> *jobs) {
+  size_t index;
+  while ((index = next_job_++) < jobs->size()) {
+    Evaluate(&(*jobs)[index]);
+  }
+}
+
+bool Sweep::FindGroundTruth(const size_t index, Location *location) const {
+  if (index + 1 >= store_.size()) {
+    return false;
+  }
+
+  const auto from = FramesetTime(store_[index]) - kTimeTolerance;
+  const auto to = FramesetTime(store_[index + 1]) - kTimeTolerance;
+  auto it = ground_truth_.lower_bound(from);
+  if (it == ground_truth_.end() || it->first >= to) {
+    return false;
+  }
+
+  *location = it->second;
+  return true;
+}
+
+void Sweep::Evaluate(Job *job) const {
+  const CameraIndex arity = store_.Arity();
+
+  Parameters parameters;
+  for (size_t i = 0; i < options_.axes.size(); ++i) {
+    if (!parameters.Set(options_.axes[i].key, job->values[i])) {
+      return;
+    }
+  }
+
+  unique_ptr<StaticInnerTracker> inner_tracker(
+      CreateStaticInnerTracker(options_.tracker, parameters));
+  StaticTracker tracker(arity, *inner_tracker, parameters);
+  tracker.calibration_data(&calibration_data_);
+
+  Localization localization(arity, parameters);
+  localization.calibration_data(&calibration_data_);
+
+  vector<bool> marked(arity, false);
+  Score score;
+  Location previous[2];
+  size_t history = 0;
+
+  for (size_t i = 0; i < store_.size(); ++i) {
+    const auto &frameset = store_[i];
+    for (CameraIndex cam = 0; cam < arity; ++cam) {
+      const auto &mark = options_.marks[cam];
+      if (!marked[cam] && frameset.IsValid(cam) &&
+          mark.type != InnerTracker::Mark::kInvalid) {
+        tracker.SetMark(frameset, cam, mark);
+        marked[cam] = true;
+      }
+    }
+
+    const auto positset = tracker.Track(frameset);
+
+    Location location;
+    const bool located = localization.Locate(positset, &location);
+    if (located) {
+      tracker.SetLocation(location);
+      ++job->locations;
+
+      for (CameraIndex cam = 0; cam < arity; ++cam) {
+        if (localization.IsOutlier(cam)) {
+          tracker.Reacquire(cam);
+        }
+      }
+    }
+
+    if (!ground_truth_.empty()) {
+      Location truth;
+      if (!FindGroundTruth(i, &truth)) {
+        continue;
+      }
+
+      if (located) {
+        const auto diff = location - truth;
+        score.Add(diff.dot(diff));
+      } else {
+        ++score.missing;
+      }
+    } else {
+      history = located ? std::min(history + 1, static_cast<size_t>(3)) : 0;
+
+      /* Second difference of consecutive locations, every frameset that has
+       * two predecessors should have one */
+      if (history == 3) {
+        score.Add(cv::norm(location - 2 * previous[1] + previous[0]));
+      } else if (i >= 2) {
+        ++score.missing;
+      }
+      previous[0] = previous[1];
+      previous[1] = location;
+    }
+  }
+
+  if (!score.count) {
+    return;
+  }
+
+  job->valid = true;
+  job->score = ground_truth_.empty() ? score.Mean() : std::sqrt(score.Mean());
+}
+
+void PrintUsage(const string &name) {
+  cout << "Usage: " << name << " [-t tracker] [-j jobs] [-n max-framesets] "
+      "[-g ground-truth] [-p name=value,...]... [-m cam,x,y,radius]... "
+      "calibration-file video-file ..." << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  const CameraIndex arity = options.files.size();
+  if (arity > CONFIG_MAX_ARITY) {
+    ERROR("At most %i cameras supported", CONFIG_MAX_ARITY);
+    return 1;
+  }
+
+  CalibrationData calibration_data;
+  if (!CalibrationStorage::LoadFromFile(options.calibration,
+                                        &calibration_data)) {
+    return 1;
+  }
+  if (calibration_data.Arity() != arity) {
+    ERROR("Calibration is for %i camera(s)", calibration_data.Arity());
+    return 1;
+  }
+
+  GroundTruth ground_truth;
+  if (!options.ground_truth.empty() &&
+      !LoadGroundTruth(options.ground_truth, &ground_truth)) {
+    return 1;
+  }
+
+  const Parameters default_parameters;
+  unique_ptr<StaticInnerTracker> probe(
+      CreateStaticInnerTracker(options.tracker, default_parameters));
+  if (!probe) {
+    ERROR("Unknown tracker %s (or not in this build)", options.tracker.c_str());
+    return 1;
+  }
+
+  /* Decode once */
+  FrameStore store(arity);
+  {
+    Aggregator::ProvidersContainer providers;
+    for (auto &file : options.files) {
+      providers.push_back(new FileVideoProvider(file));
+    }
+    FramesetAggregator<BlockingPolicy> aggregator(providers,
+                                                  default_parameters);
+    store.Load(&aggregator, options.max_framesets);
+  }
+  DEBUG("Stored %zu framesets (%zu MiB)", store.size(),
+        store.bytes() >> 20);
+
+  /* Parallelism is across jobs, not inside OpenCV */
+  cv::setNumThreads(1);
+  size_t threads = options.jobs;
+  if (!threads) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  auto jobs = CreateJobs(options.axes);
+  Sweep sweep(options, store, calibration_data, ground_truth);
+  sweep.Run(&jobs, std::min(threads, jobs.size()));
+
+  std::stable_sort(jobs.begin(), jobs.end(), [](const Job &a, const Job &b) {
+    if (a.valid != b.valid) {
+      return a.valid;
+    }
+    return a.score < b.score;
+  });
+
+  for (auto &axis : options.axes) {
+    cout << axis.name << "\t";
+  }
+  cout << "locations\tscore" << endl;
+
+  for (auto &job : jobs) {
+    for (auto value : job.values) {
+      cout << value << "\t";
+    }
+    cout << job.locations << "\t";
+    if (job.valid) {
+      cout << job.score;
+    } else {
+      cout << "-";
+    }
+    cout << endl;
+  }
+
+  return 0;
+}